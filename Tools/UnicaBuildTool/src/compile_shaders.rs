@@ -1,64 +1,372 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved
+
+// Compiles every GLSL shader to SPIR-V once per permutation of the features it declares, with lines like
+//     // @feature USE_FOG
+// Each permutation #defines the features it enables to 1 and is written next to the shader as
+// '<shader>.<mask>.spv', the mask having one bit per feature in declaration order. The permutation with
+// no feature enabled keeps the plain '<shader>.spv' name.
+// Every directory with shaders gets a Permutations.manifest listing their features and the content hash
+// each permutation was compiled from, which is how the engine finds a permutation by its defines and how
+// the next run skips the ones that are up to date.
+
 use crate::{utils, GlobalValues};
+use regex::Regex;
 use shaderc;
-use std::{io::Write, path::PathBuf};
-use tracing::{error, info, trace, debug};
+use std::collections::{HashMap, HashSet};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use tracing::{debug, error, info, trace, warn};
+
+const MANIFEST_FILE_NAME: &str = "Permutations.manifest";
+const MANIFEST_HEADER: &str = "unica-shader-permutations 1";
+// Bump whenever compile options change, every permutation is then compiled again
+const COMPILE_OPTIONS_VERSION: u64 = 1;
+// Permutations double with every feature, past this a shader should be split instead
+const MAX_FEATURES_PER_SHADER: usize = 8;
+const HASH_OFFSET_BASIS: u64 = 14695981039346656037;
+
+struct ShaderFile {
+    path: PathBuf,
+    file_name: String,
+    kind: shaderc::ShaderKind,
+    source: String,
+    features: Vec<String>,
+    // Covers the source and everything it includes, the same for each of its permutations
+    dependency_hash: u64,
+}
+
+struct Permutation {
+    shader_index: usize,
+    mask: u32,
+    content_hash: u64,
+}
+
+// FNV-1a, the same hash the engine keys its shader cache with
+fn hash_bytes(bytes: &[u8], mut hash: u64) -> u64 {
+    for byte in bytes {
+        hash = (hash ^ *byte as u64).wrapping_mul(1099511628211);
+    }
+    hash
+}
+
+fn hash_string(string: &str, hash: u64) -> u64 {
+    hash_bytes(string.as_bytes(), hash_bytes(&(string.len() as u64).to_le_bytes(), hash))
+}
+
+fn get_shader_kind(shader_path: &Path) -> Option<shaderc::ShaderKind> {
+    match shader_path.extension().and_then(|extension| extension.to_str()) {
+        Some("vert") => Some(shaderc::ShaderKind::Vertex),
+        Some("frag") => Some(shaderc::ShaderKind::Fragment),
+        _ => None,
+    }
+}
+
+fn get_permutation_path(shader_path: &Path, mask: u32) -> PathBuf {
+    if mask == 0 {
+        return PathBuf::from(format!("{}.spv", shader_path.to_str().unwrap()));
+    }
+    PathBuf::from(format!("{}.{:x}.spv", shader_path.to_str().unwrap(), mask))
+}
+
+// Matches the engine's includer, "File" is next to the including file and <File> is in Unica/Shaders
+fn resolve_include(requested_source: &str, is_relative: bool, requesting_path: &Path, shaders_directory: &Path) -> PathBuf {
+    if is_relative {
+        return requesting_path.parent().unwrap_or(Path::new("")).join(requested_source);
+    }
+    shaders_directory.join(requested_source)
+}
+
+fn hash_dependencies(
+    shader_path: &Path,
+    source: &str,
+    shaders_directory: &Path,
+    include_regex: &Regex,
+    visited_paths: &mut HashSet<PathBuf>,
+    hash: u64,
+) -> u64 {
+    let mut hash = hash_string(source, hash);
+    for include in include_regex.captures_iter(source) {
+        let is_relative = &include[1] == "\"";
+        let include_path = resolve_include(&include[2], is_relative, shader_path, shaders_directory);
+        if !visited_paths.insert(include_path.clone()) {
+            continue;
+        }
+
+        // A missing include fails the compile, which reports it better than this could
+        hash = hash_string(include_path.to_str().unwrap(), hash);
+        if let Ok(include_source) = std::fs::read_to_string(&include_path) {
+            hash = hash_dependencies(&include_path, &include_source, shaders_directory, include_regex, visited_paths, hash);
+        }
+    }
+    hash
+}
+
+fn get_permutation_hash(shader: &ShaderFile, mask: u32) -> u64 {
+    let mut hash = hash_bytes(&COMPILE_OPTIONS_VERSION.to_le_bytes(), shader.dependency_hash);
+    for (feature_index, feature) in shader.features.iter().enumerate() {
+        if mask & (1 << feature_index) != 0 {
+            hash = hash_string(feature, hash);
+        }
+    }
+    hash
+}
+
+fn load_shader(shader_path: PathBuf, shaders_directory: &Path, feature_regex: &Regex, include_regex: &Regex) -> Option<ShaderFile> {
+    let kind = get_shader_kind(&shader_path)?;
+    let source = match std::fs::read_to_string(&shader_path) {
+        Ok(source) => source,
+        Err(_) => {
+            error!("Can't load shader file {}", shader_path.to_str().unwrap());
+            return None;
+        }
+    };
+
+    let mut features: Vec<String> = vec![];
+    for feature in feature_regex.captures_iter(&source) {
+        if !features.iter().any(|declared_feature| declared_feature == &feature[1]) {
+            features.push(feature[1].to_string());
+        }
+    }
+    if features.len() > MAX_FEATURES_PER_SHADER {
+        error!(
+            "Shader '{}' declares {} features, more than the {} allowed",
+            shader_path.to_str().unwrap(),
+            features.len(),
+            MAX_FEATURES_PER_SHADER
+        );
+        return None;
+    }
+
+    let mut visited_paths = HashSet::new();
+    let dependency_hash = hash_dependencies(&shader_path, &source, shaders_directory, include_regex, &mut visited_paths, HASH_OFFSET_BASIS);
+    Some(ShaderFile {
+        file_name: shader_path.file_name().unwrap().to_str().unwrap().to_string(),
+        path: shader_path,
+        kind,
+        source,
+        features,
+        dependency_hash,
+    })
+}
+
+// Content hash of each compiled permutation, keyed by shader file name and mask
+fn read_manifest(manifest_path: &Path) -> HashMap<(String, u32), u64> {
+    let mut compiled_permutations = HashMap::new();
+    let manifest = match std::fs::read_to_string(manifest_path) {
+        Ok(manifest) => manifest,
+        Err(_) => return compiled_permutations,
+    };
+
+    let mut lines = manifest.lines();
+    if lines.next() != Some(MANIFEST_HEADER) {
+        return compiled_permutations;
+    }
+
+    let mut current_shader = String::new();
+    for line in lines {
+        let mut fields = line.split_whitespace();
+        if !line.starts_with(' ') {
+            current_shader = fields.next().unwrap_or_default().to_string();
+            continue;
+        }
+
+        let mask = fields.next().and_then(|mask| u32::from_str_radix(mask, 16).ok());
+        let content_hash = fields.next().and_then(|content_hash| u64::from_str_radix(content_hash, 16).ok());
+        if let (Some(mask), Some(content_hash)) = (mask, content_hash) {
+            compiled_permutations.insert((current_shader.clone(), mask), content_hash);
+        }
+    }
+    compiled_permutations
+}
+
+// One line per shader with its features, followed by an indented line per compiled permutation
+fn write_manifest(manifest_path: &Path, shaders: &[&ShaderFile], compiled_permutations: &HashMap<(String, u32), u64>) {
+    let mut manifest = format!("{}\n", MANIFEST_HEADER);
+    for shader in shaders {
+        manifest.push_str(&shader.file_name);
+        for feature in &shader.features {
+            manifest.push(' ');
+            manifest.push_str(feature);
+        }
+        manifest.push('\n');
+
+        for mask in 0..(1u32 << shader.features.len()) {
+            if let Some(content_hash) = compiled_permutations.get(&(shader.file_name.clone(), mask)) {
+                manifest.push_str(&format!(" {:x} {:016x}\n", mask, content_hash));
+            }
+        }
+    }
+
+    // Replaced in one go, the engine may be reading it
+    let temporary_path = manifest_path.with_extension("manifest.tmp");
+    if std::fs::write(&temporary_path, manifest).is_err() || std::fs::rename(&temporary_path, manifest_path).is_err() {
+        error!("Can't write to file {}", manifest_path.to_str().unwrap());
+    }
+}
+
+fn compile_permutation(compiler: &shaderc::Compiler, shader: &ShaderFile, mask: u32, shaders_directory: &Path) -> bool {
+    let start_compilation_time = std::time::Instant::now();
+    let output_path = get_permutation_path(&shader.path, mask);
+
+    // Same options the engine compiles with at runtime, so both produce the same permutation
+    let mut compiler_options = shaderc::CompileOptions::new().unwrap();
+    compiler_options.set_target_env(shaderc::TargetEnv::Vulkan, shaderc::EnvVersion::Vulkan1_3 as u32);
+    compiler_options.set_optimization_level(shaderc::OptimizationLevel::Performance);
+    for (feature_index, feature) in shader.features.iter().enumerate() {
+        if mask & (1 << feature_index) != 0 {
+            compiler_options.add_macro_definition(feature, Some("1"));
+        }
+    }
+    compiler_options.set_include_callback(|requested_source, include_type, requesting_source, _include_depth| {
+        let include_path = resolve_include(
+            requested_source,
+            matches!(include_type, shaderc::IncludeType::Relative),
+            Path::new(requesting_source),
+            shaders_directory,
+        );
+        match std::fs::read_to_string(&include_path) {
+            Ok(content) => Ok(shaderc::ResolvedInclude {
+                resolved_name: include_path.to_str().unwrap().to_string(),
+                content,
+            }),
+            Err(_) => Err(format!("Can't find '{}'", include_path.to_str().unwrap())),
+        }
+    });
+
+    trace!("Compiling shader file '{}' with mask {:x}", shader.path.to_str().unwrap(), mask);
+    let compiled_shader_binary = match compiler.compile_into_spirv(
+        &shader.source,
+        shader.kind,
+        shader.path.to_str().unwrap(),
+        "main",
+        Some(&compiler_options),
+    ) {
+        Ok(compiled_shader_binary) => compiled_shader_binary,
+        Err(compile_error) => {
+            error!("Failed to compile shader '{}' with mask {:x}:\n{}", shader.path.to_str().unwrap(), mask, compile_error);
+            return false;
+        }
+    };
+    if compiled_shader_binary.get_num_warnings() > 0 {
+        warn!(
+            "Compiled shader '{}' with warnings:\n{}",
+            shader.path.to_str().unwrap(),
+            compiled_shader_binary.get_warning_messages()
+        );
+    }
+
+    if std::fs::write(&output_path, compiled_shader_binary.as_binary_u8()).is_err() {
+        error!("Can't write to file {}", output_path.to_str().unwrap());
+        return false;
+    }
+    debug!("Compiled shader in {:.0?}: {}", start_compilation_time.elapsed(), output_path.to_str().unwrap());
+    true
+}
 
 pub fn compile_shaders(global_values: &GlobalValues) {
     info!("Starting shader compilation to SPIRV");
     let directories_to_find_files_list = [global_values.unica_root_path.to_str().unwrap()];
+    let shaders_directory = global_values.unica_root_path.join("Unica").join("Shaders");
+    let feature_regex = Regex::new(r"(?m)^\s*//\s*@feature\s+([A-Za-z_][A-Za-z0-9_]*)\s*$").unwrap();
+    let include_regex = Regex::new(r#"(?m)^\s*#\s*include\s*([<"])([^>"]+)[>"]"#).unwrap();
 
-    let mut shader_files: Vec<PathBuf> = vec![];
+    let mut shaders: Vec<ShaderFile> = vec![];
     let found_files = utils::get_files_in_dir(&directories_to_find_files_list);
     for file in found_files {
         if file.to_str().unwrap().ends_with(".frag") || file.to_str().unwrap().ends_with(".vert") {
             trace!("Found shader file '{}'", file.to_str().unwrap());
-            shader_files.push(file);
+            if let Some(shader) = load_shader(file, &shaders_directory, &feature_regex, &include_regex) {
+                shaders.push(shader);
+            }
         }
     }
 
-    let compiler = shaderc::Compiler::new().unwrap();
-    let compiler_options = shaderc::CompileOptions::new().unwrap();
-    for shader_file in shader_files {
-        let start_compilation_time = std::time::Instant::now();
+    // Shaders are grouped by the directory whose manifest lists them
+    let mut shaders_by_directory: HashMap<PathBuf, Vec<usize>> = HashMap::new();
+    for (shader_index, shader) in shaders.iter().enumerate() {
+        let directory = shader.path.parent().unwrap().to_path_buf();
+        shaders_by_directory.entry(directory).or_default().push(shader_index);
+    }
 
-        let loaded_uncompiled_shader =
-            std::fs::read_to_string(shader_file.as_os_str().to_str().unwrap());
-        if loaded_uncompiled_shader.is_err() {
-            error!("Can't load shader file {}", shader_file.to_str().unwrap());
-            continue;
+    let mut compiled_permutations: HashMap<PathBuf, HashMap<(String, u32), u64>> = HashMap::new();
+    let mut outdated_permutations: Vec<Permutation> = vec![];
+    let mut permutation_count = 0;
+    for (directory, shader_indices) in &shaders_by_directory {
+        let previous_permutations = read_manifest(&directory.join(MANIFEST_FILE_NAME));
+        let mut up_to_date_permutations = HashMap::new();
+        for shader_index in shader_indices {
+            let shader = &shaders[*shader_index];
+            for mask in 0..(1u32 << shader.features.len()) {
+                permutation_count += 1;
+                let content_hash = get_permutation_hash(shader, mask);
+                let permutation_key = (shader.file_name.clone(), mask);
+                if previous_permutations.get(&permutation_key) == Some(&content_hash) && get_permutation_path(&shader.path, mask).is_file() {
+                    up_to_date_permutations.insert(permutation_key, content_hash);
+                    continue;
+                }
+                outdated_permutations.push(Permutation {
+                    shader_index: *shader_index,
+                    mask,
+                    content_hash,
+                });
+            }
         }
+        compiled_permutations.insert(directory.clone(), up_to_date_permutations);
+    }
+    info!(
+        "{} of {} shader permutations are up to date",
+        permutation_count - outdated_permutations.len(),
+        permutation_count
+    );
 
-        let mut shader_kind = shaderc::ShaderKind::InferFromSource;
-        if shader_file.to_str().unwrap().ends_with(".frag") {
-            shader_kind = shaderc::ShaderKind::Fragment;
-        } else if shader_file.to_str().unwrap().ends_with(".vert") {
-            shader_kind = shaderc::ShaderKind::Vertex;
-        }
+    // Workers pull permutations off a shared index, each with its own compiler
+    let next_permutation = AtomicUsize::new(0);
+    let thread_count = std::thread::available_parallelism()
+        .map(|count| count.get())
+        .unwrap_or(1)
+        .min(outdated_permutations.len().max(1));
+    let compile_results: Vec<(usize, bool)> = std::thread::scope(|scope| {
+        let workers: Vec<_> = (0..thread_count)
+            .map(|_| {
+                scope.spawn(|| {
+                    let compiler = shaderc::Compiler::new().unwrap();
+                    let mut results = vec![];
+                    loop {
+                        let permutation_index = next_permutation.fetch_add(1, Ordering::Relaxed);
+                        if permutation_index >= outdated_permutations.len() {
+                            return results;
+                        }
+                        let permutation = &outdated_permutations[permutation_index];
+                        let shader = &shaders[permutation.shader_index];
+                        results.push((permutation_index, compile_permutation(&compiler, shader, permutation.mask, &shaders_directory)));
+                    }
+                })
+            })
+            .collect();
+        workers.into_iter().flat_map(|worker| worker.join().unwrap()).collect()
+    });
 
-        trace!("Compiling shader file '{}'", shader_file.to_str().unwrap());
-        let compiled_shader_binary = compiler
-            .compile_into_spirv(
-                loaded_uncompiled_shader.ok().unwrap().as_str(),
-                shader_kind,
-                shader_file.file_name().unwrap().to_str().unwrap(),
-                "main",
-                Some(&compiler_options),
-            )
-            .unwrap();
-
-        let output_file_name = format!("{}{}", shader_file.to_str().unwrap(), ".spv");
-        let file = std::fs::File::create(output_file_name.clone());
-        if file.is_err() {
-            error!("Can't write to file {}", output_file_name);
+    // Failed permutations are left out of the manifest, the next run tries them again
+    let mut failed_permutation_count = 0;
+    for (permutation_index, was_compiled) in compile_results {
+        let permutation = &outdated_permutations[permutation_index];
+        let shader = &shaders[permutation.shader_index];
+        if !was_compiled {
+            failed_permutation_count += 1;
             continue;
         }
-        let written_file = file
+        compiled_permutations
+            .get_mut(shader.path.parent().unwrap())
             .unwrap()
-            .write_all(compiled_shader_binary.as_binary_u8());
-        if written_file.is_err() {
-            error!("Can't write to file {}", output_file_name);
-            continue;
-        }
-        debug!("Compiled shader in {:.0?}: {}", start_compilation_time.elapsed(), output_file_name);
+            .insert((shader.file_name.clone(), permutation.mask), permutation.content_hash);
+    }
+
+    for (directory, shader_indices) in &shaders_by_directory {
+        let directory_shaders: Vec<&ShaderFile> = shader_indices.iter().map(|shader_index| &shaders[*shader_index]).collect();
+        write_manifest(&directory.join(MANIFEST_FILE_NAME), &directory_shaders, &compiled_permutations[directory]);
+    }
+
+    if failed_permutation_count > 0 {
+        error!("{} shader permutations failed to compile", failed_permutation_count);
     }
 }
@@ -31,7 +31,9 @@ fn update_base_engine(project_name: &str, overwrite_existing_project: bool, unic
     for line in engine_base_config_lines.clone() {
         if line.contains("ProjectName=") {
             found_project_name_line = true;
-            if !overwrite_existing_project {
+            // The engine ships with an empty ProjectName, which means no project is configured yet
+            let has_project = !line.replace("ProjectName=", "").replace("#gitignore", "").trim().is_empty();
+            if has_project && !overwrite_existing_project {
                 error!("There's an existing Unica project configured. Aborting creation");
                 return false;
             }
@@ -0,0 +1,266 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+// Turns binary log files written by the engine's BinaryLogSink back into text or JSON lines.
+// Usage: UnicaLogDecoder [--json] <file or directory>...
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/chrono.h>
+
+#include "Logging/BinaryLogFormat.h"
+#include "Logging/LogRecord.h"
+
+struct FormatDefinition
+{
+    std::string Format;
+    std::string SourceFile;
+    std::string SourceFunction;
+    int32_t SourceLine = 0;
+    spdlog::level::level_enum Level = spdlog::level::off;
+};
+
+struct LogFile
+{
+    std::filesystem::path Path;
+    BinaryLogFormat::FileHeader Header;
+    std::vector<char> Entries;
+};
+
+namespace
+{
+    template <typename T>
+    bool ReadValue(const std::vector<char>& Data, size_t& Offset, T& OutValue)
+    {
+        if (Offset + sizeof(T) > Data.size())
+        {
+            return false;
+        }
+        std::memcpy(&OutValue, Data.data() + Offset, sizeof(T));
+        Offset += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(const std::vector<char>& Data, size_t& Offset, const size_t Size, std::string& OutString)
+    {
+        if (Offset + Size > Data.size())
+        {
+            return false;
+        }
+        OutString.assign(Data.data() + Offset, Size);
+        Offset += Size;
+        return true;
+    }
+
+    bool LoadLogFile(const std::filesystem::path& Path, LogFile& OutFile)
+    {
+        std::ifstream File(Path, std::ios::binary);
+        if (!File.read(reinterpret_cast<char*>(&OutFile.Header), sizeof(OutFile.Header)))
+        {
+            fmt::print(stderr, "'{}' is too small to be a log file\n", Path.string());
+            return false;
+        }
+        if (OutFile.Header.Magic != BinaryLogFormat::Magic || OutFile.Header.Version != BinaryLogFormat::Version)
+        {
+            fmt::print(stderr, "'{}' isn't a version {} binary log file\n", Path.string(), BinaryLogFormat::Version);
+            return false;
+        }
+
+        // A crashed engine may leave the header claiming more than the file holds, keep whatever made it to disk
+        OutFile.Path = Path;
+        OutFile.Entries.resize(OutFile.Header.EntriesSize);
+        File.read(OutFile.Entries.data(), static_cast<std::streamsize>(OutFile.Entries.size()));
+        OutFile.Entries.resize(static_cast<size_t>(File.gcount()));
+        return true;
+    }
+
+    std::string EscapeJson(const std::string_view Text)
+    {
+        std::string Escaped;
+        Escaped.reserve(Text.size());
+        for (const char Character : Text)
+        {
+            switch (Character)
+            {
+            case '"': Escaped += "\\\""; break;
+            case '\\': Escaped += "\\\\"; break;
+            case '\n': Escaped += "\\n"; break;
+            case '\r': Escaped += "\\r"; break;
+            case '\t': Escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(Character) < 0x20)
+                {
+                    Escaped += fmt::format("\\u{:04x}", static_cast<int>(Character));
+                }
+                else
+                {
+                    Escaped += Character;
+                }
+            }
+        }
+        return Escaped;
+    }
+
+    void PrintRecord(const FormatDefinition& Definition, const BinaryLogFormat::Record& RecordEntry, const std::vector<char>& Payload, const bool bJson)
+    {
+        LogRecord Record;
+        Record.Format = Definition.Format.data();
+        Record.FormatSize = static_cast<uint32_t>(Definition.Format.size());
+        Record.ArgumentCount = RecordEntry.ArgumentCount;
+        Record.EncodedArgumentCount = RecordEntry.EncodedArgumentCount;
+        Record.PayloadSize = RecordEntry.PayloadSize;
+        std::memcpy(Record.Payload.data(), Payload.data(), Payload.size());
+
+        fmt::dynamic_format_arg_store<fmt::format_context> Arguments;
+        Record.DecodeArguments(Arguments);
+        std::string Message;
+        try
+        {
+            Message = fmt::vformat(Record.GetFormat(), Arguments);
+        }
+        catch (const fmt::format_error&)
+        {
+            Message = Definition.Format;
+        }
+
+        const std::chrono::sys_time<std::chrono::nanoseconds> Time { std::chrono::nanoseconds(RecordEntry.TimestampNanos) };
+        const std::chrono::sys_seconds TimeSeconds = std::chrono::floor<std::chrono::seconds>(Time);
+        const int64_t Milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(Time - TimeSeconds).count();
+        const spdlog::string_view_t LevelName = spdlog::level::to_string_view(Definition.Level);
+        if (bJson)
+        {
+            fmt::print("{{\"Time\": \"{:%FT%T}.{:03}Z\", \"TimestampNanos\": {}, \"Thread\": {}, \"Level\": \"{}\", \"File\": \"{}\", \"Line\": {}, \"Function\": \"{}\", \"Message\": \"{}\"}}\n",
+                TimeSeconds, Milliseconds, RecordEntry.TimestampNanos, RecordEntry.ThreadId, fmt::string_view(LevelName.data(), LevelName.size()),
+                EscapeJson(Definition.SourceFile), Definition.SourceLine, EscapeJson(Definition.SourceFunction), EscapeJson(Message));
+        }
+        else
+        {
+            // Matches the engine's console pattern, with the date and thread the console leaves out
+            fmt::print("[{:%F %T}.{:03}] [{}] {:<37} {:>5}: {}\n", TimeSeconds, Milliseconds, RecordEntry.ThreadId, Definition.SourceFunction,
+                fmt::string_view(LevelName.data(), std::min<size_t>(LevelName.size(), 5)), Message);
+        }
+    }
+
+    bool DecodeLogFile(const LogFile& File, const bool bJson)
+    {
+        std::vector<FormatDefinition> Definitions;
+        std::vector<char> Payload;
+        size_t Offset = 0;
+        while (Offset < File.Entries.size())
+        {
+            BinaryLogFormat::EntryType EntryType { };
+            ReadValue(File.Entries, Offset, EntryType);
+
+            if (EntryType == BinaryLogFormat::EntryType::FormatDefinition)
+            {
+                BinaryLogFormat::FormatDefinition DefinitionEntry;
+                FormatDefinition Definition;
+                if (!ReadValue(File.Entries, Offset, DefinitionEntry)
+                    || !ReadString(File.Entries, Offset, DefinitionEntry.FormatSize, Definition.Format)
+                    || !ReadString(File.Entries, Offset, DefinitionEntry.SourceFileSize, Definition.SourceFile)
+                    || !ReadString(File.Entries, Offset, DefinitionEntry.SourceFunctionSize, Definition.SourceFunction))
+                {
+                    fmt::print(stderr, "'{}' ends in a truncated format definition\n", File.Path.string());
+                    return false;
+                }
+                Definition.SourceLine = DefinitionEntry.SourceLine;
+                Definition.Level = static_cast<spdlog::level::level_enum>(DefinitionEntry.Level);
+
+                if (DefinitionEntry.FormatId >= Definitions.size())
+                {
+                    Definitions.resize(DefinitionEntry.FormatId + 1);
+                }
+                Definitions[DefinitionEntry.FormatId] = std::move(Definition);
+            }
+            else if (EntryType == BinaryLogFormat::EntryType::Record)
+            {
+                BinaryLogFormat::Record RecordEntry;
+                if (!ReadValue(File.Entries, Offset, RecordEntry) || RecordEntry.PayloadSize > LogRecord::PayloadCapacity
+                    || Offset + RecordEntry.PayloadSize > File.Entries.size())
+                {
+                    fmt::print(stderr, "'{}' ends in a truncated record\n", File.Path.string());
+                    return false;
+                }
+                if (RecordEntry.FormatId >= Definitions.size())
+                {
+                    fmt::print(stderr, "'{}' has a record with the undefined format {}\n", File.Path.string(), RecordEntry.FormatId);
+                    return false;
+                }
+
+                Payload.assign(File.Entries.begin() + static_cast<std::ptrdiff_t>(Offset), File.Entries.begin() + static_cast<std::ptrdiff_t>(Offset + RecordEntry.PayloadSize));
+                Offset += RecordEntry.PayloadSize;
+                PrintRecord(Definitions[RecordEntry.FormatId], RecordEntry, Payload, bJson);
+            }
+            else
+            {
+                fmt::print(stderr, "'{}' has an unknown entry type {} at offset {}\n", File.Path.string(), static_cast<int>(EntryType), Offset);
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool bJson = false;
+    std::vector<std::filesystem::path> Paths;
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const std::string_view Argument = argv[ArgumentIndex];
+        if (Argument == "--json")
+        {
+            bJson = true;
+        }
+        else if (std::filesystem::is_directory(Argument))
+        {
+            for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Argument))
+            {
+                if (Entry.path().extension() == BinaryLogFormat::FileExtension)
+                {
+                    Paths.push_back(Entry.path());
+                }
+            }
+        }
+        else
+        {
+            Paths.emplace_back(Argument);
+        }
+    }
+
+    if (Paths.empty())
+    {
+        fmt::print(stderr, "Usage: UnicaLogDecoder [--json] <file or directory>...\n");
+        return 1;
+    }
+
+    std::vector<LogFile> Files;
+    for (const std::filesystem::path& Path : Paths)
+    {
+        LogFile File;
+        if (LoadLogFile(Path, File))
+        {
+            Files.push_back(std::move(File));
+        }
+    }
+
+    // Rotation reuses file names, the sequence number is what orders them
+    std::sort(Files.begin(), Files.end(), [](const LogFile& Left, const LogFile& Right)
+    {
+        return Left.Header.Sequence < Right.Header.Sequence;
+    });
+
+    bool bDecodedEverything = Files.size() == Paths.size();
+    for (const LogFile& File : Files)
+    {
+        bDecodedEverything &= DecodeLogFile(File, bJson);
+    }
+    return bDecodedEverything ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+// Packs a directory into an archive the engine's VirtualFileSystem can mount.
+// Usage: UnicaPacker [--compress] [--block-size <bytes>] [--extension <.ext>]... <source directory> <archive>
+// e.g. UnicaPacker --compress --extension .spv Unica Unica/Paks/Engine.upak
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "IO/BlockCompression.h"
+#include "IO/PackedArchiveFormat.h"
+
+struct PackerOptions
+{
+    bool bCompress = false;
+    uint32_t BlockSize = PackedArchiveFormat::DefaultBlockSize;
+    std::vector<std::string> Extensions;
+    std::filesystem::path SourceDirectory;
+    std::filesystem::path ArchivePath;
+};
+
+struct PackedFile
+{
+    std::filesystem::path Path;
+    std::string RelativePath;
+};
+
+namespace
+{
+    void PrintUsage()
+    {
+        fmt::print(stderr, "Usage: UnicaPacker [--compress] [--block-size <bytes>] [--extension <.ext>]... <source directory> <archive>\n");
+    }
+
+    bool ParseOptions(const int argc, char* argv[], PackerOptions& OutOptions)
+    {
+        std::vector<std::string_view> Positional;
+        for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+        {
+            const std::string_view Argument = argv[ArgumentIndex];
+            const bool bHasValue = ArgumentIndex + 1 < argc;
+            if (Argument == "--compress")
+            {
+                OutOptions.bCompress = true;
+            }
+            else if (Argument == "--block-size" && bHasValue)
+            {
+                const std::string_view Value = argv[++ArgumentIndex];
+                const std::from_chars_result Result = std::from_chars(Value.data(), Value.data() + Value.size(), OutOptions.BlockSize);
+                if (Result.ec != std::errc() || OutOptions.BlockSize == 0)
+                {
+                    fmt::print(stderr, "Invalid block size '{}'\n", Value);
+                    return false;
+                }
+            }
+            else if (Argument == "--extension" && bHasValue)
+            {
+                OutOptions.Extensions.emplace_back(argv[++ArgumentIndex]);
+            }
+            else if (Argument.starts_with("--"))
+            {
+                fmt::print(stderr, "Unknown option '{}'\n", Argument);
+                return false;
+            }
+            else
+            {
+                Positional.push_back(Argument);
+            }
+        }
+
+        if (Positional.size() != 2)
+        {
+            return false;
+        }
+        OutOptions.SourceDirectory = Positional[0];
+        OutOptions.ArchivePath = Positional[1];
+        return true;
+    }
+
+    std::vector<PackedFile> FindFilesToPack(const PackerOptions& Options)
+    {
+        std::vector<PackedFile> Files;
+        for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(Options.SourceDirectory))
+        {
+            const std::filesystem::path& FilePath = Entry.path();
+            if (!Entry.is_regular_file() || FilePath.extension() == PackedArchiveFormat::FileExtension)
+            {
+                continue;
+            }
+            if (!Options.Extensions.empty()
+                && std::find(Options.Extensions.begin(), Options.Extensions.end(), FilePath.extension().string()) == Options.Extensions.end())
+            {
+                continue;
+            }
+
+            // Archives store paths the way the engine looks them up, relative to the mount point with forward slashes
+            Files.push_back({ FilePath, FilePath.lexically_relative(Options.SourceDirectory).generic_string() });
+        }
+
+        std::sort(Files.begin(), Files.end(), [](const PackedFile& Left, const PackedFile& Right)
+        {
+            return Left.RelativePath < Right.RelativePath;
+        });
+        return Files;
+    }
+
+    bool ReadWholeFile(const std::filesystem::path& FilePath, std::vector<char>& OutData)
+    {
+        std::ifstream File(FilePath, std::ios::binary);
+        if (!File)
+        {
+            return false;
+        }
+        OutData.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+        return !File.bad();
+    }
+
+    void PadTo(std::ofstream& Archive, const uint64_t Alignment)
+    {
+        const uint64_t Offset = static_cast<uint64_t>(Archive.tellp());
+        const uint64_t PaddingSize = (Alignment - Offset % Alignment) % Alignment;
+        for (uint64_t PaddingIndex = 0; PaddingIndex < PaddingSize; PaddingIndex++)
+        {
+            Archive.put('\0');
+        }
+    }
+
+    /** Compresses Data block by block, returns false when the whole file wouldn't shrink and should be stored raw */
+    bool CompressFile(const std::vector<char>& Data, const uint32_t BlockSize, std::vector<char>& OutStoredData, std::vector<uint32_t>& OutBlockSizes)
+    {
+        std::vector<char> CompressedBlock(BlockCompression::GetMaxCompressedSize(BlockSize));
+        for (size_t BlockOffset = 0; BlockOffset < Data.size(); BlockOffset += BlockSize)
+        {
+            const size_t UncompressedSize = std::min<size_t>(BlockSize, Data.size() - BlockOffset);
+            const size_t CompressedSize = BlockCompression::Compress(Data.data() + BlockOffset, UncompressedSize, CompressedBlock.data(), CompressedBlock.size());
+
+            // The engine tells raw blocks apart by their stored size matching the uncompressed one
+            if (CompressedSize == 0 || CompressedSize >= UncompressedSize)
+            {
+                OutStoredData.insert(OutStoredData.end(), Data.begin() + static_cast<std::ptrdiff_t>(BlockOffset),
+                    Data.begin() + static_cast<std::ptrdiff_t>(BlockOffset + UncompressedSize));
+                OutBlockSizes.push_back(static_cast<uint32_t>(UncompressedSize));
+            }
+            else
+            {
+                OutStoredData.insert(OutStoredData.end(), CompressedBlock.begin(), CompressedBlock.begin() + static_cast<std::ptrdiff_t>(CompressedSize));
+                OutBlockSizes.push_back(static_cast<uint32_t>(CompressedSize));
+            }
+        }
+        return OutStoredData.size() < Data.size();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    PackerOptions Options;
+    if (!ParseOptions(argc, argv, Options))
+    {
+        PrintUsage();
+        return 1;
+    }
+    if (!std::filesystem::is_directory(Options.SourceDirectory))
+    {
+        fmt::print(stderr, "'{}' isn't a directory\n", Options.SourceDirectory.string());
+        return 1;
+    }
+
+    const std::vector<PackedFile> Files = FindFilesToPack(Options);
+    if (Options.ArchivePath.has_parent_path())
+    {
+        std::filesystem::create_directories(Options.ArchivePath.parent_path());
+    }
+    std::ofstream Archive(Options.ArchivePath, std::ios::binary | std::ios::trunc);
+    if (!Archive)
+    {
+        fmt::print(stderr, "Can't write to '{}'\n", Options.ArchivePath.string());
+        return 1;
+    }
+
+    // Written again once every offset is known
+    PackedArchiveFormat::FileHeader Header;
+    Header.BlockSize = Options.BlockSize;
+    Archive.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+    std::vector<PackedArchiveFormat::Entry> Entries;
+    std::vector<uint32_t> BlockSizes;
+    std::string Paths;
+    std::vector<char> Data;
+    std::vector<char> StoredData;
+    uint64_t TotalSize = 0;
+    for (const PackedFile& File : Files)
+    {
+        if (!ReadWholeFile(File.Path, Data))
+        {
+            fmt::print(stderr, "Can't read '{}'\n", File.Path.string());
+            return 1;
+        }
+
+        PackedArchiveFormat::Entry Entry;
+        Entry.PathHash = PackedArchiveFormat::HashPath(File.RelativePath);
+        Entry.PathOffset = static_cast<uint32_t>(Paths.size());
+        Entry.PathSize = static_cast<uint32_t>(File.RelativePath.size());
+        Entry.Size = Data.size();
+        Paths += File.RelativePath;
+
+        StoredData.clear();
+        std::vector<uint32_t> FileBlockSizes;
+        const bool bCompressed = Options.bCompress && CompressFile(Data, Options.BlockSize, StoredData, FileBlockSizes);
+        if (bCompressed)
+        {
+            Entry.Flags |= PackedArchiveFormat::EntryFlagCompressed;
+            Entry.FirstBlock = static_cast<uint32_t>(BlockSizes.size());
+            BlockSizes.insert(BlockSizes.end(), FileBlockSizes.begin(), FileBlockSizes.end());
+        }
+        const std::vector<char>& DataToStore = bCompressed ? StoredData : Data;
+
+        PadTo(Archive, PackedArchiveFormat::DataAlignment);
+        Entry.DataOffset = static_cast<uint64_t>(Archive.tellp());
+        Entry.StoredSize = DataToStore.size();
+        Archive.write(DataToStore.data(), static_cast<std::streamsize>(DataToStore.size()));
+        Entries.push_back(Entry);
+        TotalSize += Entry.Size;
+    }
+
+    // Sorted by hash for the engine's binary search, colliding hashes by path so the archive is reproducible
+    std::sort(Entries.begin(), Entries.end(), [&Paths](const PackedArchiveFormat::Entry& Left, const PackedArchiveFormat::Entry& Right)
+    {
+        if (Left.PathHash != Right.PathHash)
+        {
+            return Left.PathHash < Right.PathHash;
+        }
+        return std::string_view(Paths).substr(Left.PathOffset, Left.PathSize) < std::string_view(Paths).substr(Right.PathOffset, Right.PathSize);
+    });
+
+    PadTo(Archive, alignof(PackedArchiveFormat::Entry));
+    Header.BlockTableOffset = static_cast<uint64_t>(Archive.tellp());
+    Header.BlockCount = static_cast<uint32_t>(BlockSizes.size());
+    Archive.write(reinterpret_cast<const char*>(BlockSizes.data()), static_cast<std::streamsize>(BlockSizes.size() * sizeof(uint32_t)));
+
+    PadTo(Archive, alignof(PackedArchiveFormat::Entry));
+    Header.IndexOffset = static_cast<uint64_t>(Archive.tellp());
+    Header.EntryCount = static_cast<uint32_t>(Entries.size());
+    Archive.write(reinterpret_cast<const char*>(Entries.data()), static_cast<std::streamsize>(Entries.size() * sizeof(PackedArchiveFormat::Entry)));
+
+    Header.PathsOffset = static_cast<uint64_t>(Archive.tellp());
+    Header.PathsSize = Paths.size();
+    Archive.write(Paths.data(), static_cast<std::streamsize>(Paths.size()));
+
+    const uint64_t ArchiveSize = static_cast<uint64_t>(Archive.tellp());
+    Archive.seekp(0);
+    Archive.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+    if (!Archive.flush())
+    {
+        fmt::print(stderr, "Failed writing '{}'\n", Options.ArchivePath.string());
+        return 1;
+    }
+
+    fmt::print("Packed {} files, {} bytes into {} bytes in '{}'\n", Entries.size(), TotalSize, ArchiveSize, Options.ArchivePath.string());
+    return 0;
+}
@@ -0,0 +1,162 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "UnicaConfig.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#include "UnicaFileUtilities.h"
+#include "UnicaInstance.h"
+
+namespace
+{
+    std::string_view Trim(std::string_view Text)
+    {
+        const size_t First = Text.find_first_not_of(" \t\r");
+        if (First == std::string_view::npos)
+        {
+            return { };
+        }
+        return Text.substr(First, Text.find_last_not_of(" \t\r") - First + 1);
+    }
+
+    bool EqualsIgnoringCase(const std::string_view First, const std::string_view Second)
+    {
+        return First.size() == Second.size() && std::equal(First.begin(), First.end(), Second.begin(), [](const char FirstCharacter, const char SecondCharacter)
+        {
+            return std::tolower(static_cast<uint8>(FirstCharacter)) == std::tolower(static_cast<uint8>(SecondCharacter));
+        });
+    }
+}
+
+std::unordered_map<uint64, UnicaConfig::ConfigValue> UnicaConfig::m_Values;
+
+void UnicaConfig::Init(const int ArgumentCount, char* Arguments[])
+{
+    UNICA_PROFILE_FUNCTION
+    LoadIniFile(UnicaFileUtilities::ResolveDirectory("Engine:Config/BaseEngine.ini"));
+
+    const std::string ProjectName = Get<std::string>("ProjectName", "");
+    if (!ProjectName.empty())
+    {
+        LoadIniFile(UnicaInstance::GetProjectRootDirectory() / ProjectName / "Config" / "DefaultGame.ini");
+    }
+
+    for (int32 ArgumentIndex = 1; ArgumentIndex < ArgumentCount; ArgumentIndex++)
+    {
+        std::string_view Argument = Arguments[ArgumentIndex];
+        const size_t EqualsIndex = Argument.find('=');
+        if (!Argument.starts_with('-') || EqualsIndex == std::string_view::npos)
+        {
+            continue;
+        }
+
+        const std::string_view Key = Argument.substr(Argument.find_first_not_of('-'), EqualsIndex - Argument.find_first_not_of('-'));
+        Set(Key, Argument.substr(EqualsIndex + 1), "command line");
+    }
+}
+
+void UnicaConfig::LoadIniFile(const std::filesystem::path& IniPath)
+{
+    if (!std::filesystem::exists(IniPath))
+    {
+        UNICA_LOG_DEBUG("No config file at '{}'", IniPath.string());
+        return;
+    }
+
+    const UnicaMappedFile IniFile = UnicaFileUtilities::MapFile(IniPath.string());
+    ParseIni(IniFile.GetStringView(), IniPath.filename().string());
+}
+
+void UnicaConfig::ParseIni(const std::string_view IniText, const std::string_view Source)
+{
+    std::string_view Section;
+    std::string SectionKey;
+
+    size_t LineStart = 0;
+    while (LineStart < IniText.size())
+    {
+        size_t LineEnd = IniText.find('\n', LineStart);
+        if (LineEnd == std::string_view::npos)
+        {
+            LineEnd = IniText.size();
+        }
+
+        const std::string_view Line = Trim(IniText.substr(LineStart, LineEnd - LineStart));
+        LineStart = LineEnd + 1;
+
+        if (Line.empty() || Line.front() == ';' || Line.front() == '#')
+        {
+            continue;
+        }
+
+        if (Line.front() == '[' && Line.back() == ']')
+        {
+            Section = Trim(Line.substr(1, Line.size() - 2));
+            continue;
+        }
+
+        const size_t EqualsIndex = Line.find('=');
+        if (EqualsIndex == std::string_view::npos)
+        {
+            UNICA_LOG_WARN("Ignoring malformed line '{}' in {}", Line, Source);
+            continue;
+        }
+
+        // Keys outside of any section, like ProjectName, are global
+        const std::string_view Key = Trim(Line.substr(0, EqualsIndex));
+        SectionKey.clear();
+        if (!Section.empty())
+        {
+            SectionKey.append(Section).append(".");
+        }
+        SectionKey.append(Key);
+
+        Set(SectionKey, Line.substr(EqualsIndex + 1), Source);
+    }
+}
+
+void UnicaConfig::Set(const std::string_view Key, std::string_view Value, const std::string_view Source)
+{
+    Value = Trim(Value);
+    if (Value.size() >= 2 && Value.front() == '"' && Value.back() == '"')
+    {
+        Value = Value.substr(1, Value.size() - 2);
+    }
+
+    ConfigValue& StoredValue = m_Values[ConfigKey::Hash(Key)];
+    if (!StoredValue.Key.empty() && !EqualsIgnoringCase(StoredValue.Key, Key))
+    {
+        UNICA_LOG_ERROR("Config keys '{}' and '{}' have the same hash, '{}' is overriding the other", StoredValue.Key, Key, Key);
+    }
+
+    StoredValue = ConfigValue();
+    StoredValue.Key = Key;
+    StoredValue.Text = Value;
+
+    if (EqualsIgnoringCase(Value, "true") || EqualsIgnoringCase(Value, "false"))
+    {
+        StoredValue.Boolean = EqualsIgnoringCase(Value, "true");
+    }
+
+    int64 Integer;
+    const std::from_chars_result IntegerResult = std::from_chars(Value.data(), Value.data() + Value.size(), Integer);
+    if (IntegerResult.ec == std::errc() && IntegerResult.ptr == Value.data() + Value.size())
+    {
+        StoredValue.Integer = Integer;
+        StoredValue.Number = static_cast<double>(Integer);
+        StoredValue.Boolean = Integer != 0;
+    }
+    else
+    {
+        double Number;
+        const std::from_chars_result NumberResult = std::from_chars(Value.data(), Value.data() + Value.size(), Number);
+        if (NumberResult.ec == std::errc() && NumberResult.ptr == Value.data() + Value.size())
+        {
+            StoredValue.Number = Number;
+        }
+    }
+
+    UNICA_LOG_TRACE("Config {}={} from {}", Key, Value, Source);
+}
@@ -0,0 +1,110 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include "UnicaMinimal.h"
+
+/** Case insensitive FNV-1a hash of a "Section.Key" config key, computed at compile time for string literals */
+class ConfigKey
+{
+public:
+    consteval ConfigKey(const char* Key) : m_Hash(Hash(Key)) { }
+
+    static constexpr ConfigKey FromString(const std::string_view Key) { return ConfigKey(Hash(Key)); }
+
+    static constexpr uint64 Hash(const std::string_view Key)
+    {
+        uint64 KeyHash = 14695981039346656037ull;
+        for (const char Character : Key)
+        {
+            KeyHash ^= static_cast<uint8>(Character >= 'A' && Character <= 'Z' ? Character - 'A' + 'a' : Character);
+            KeyHash *= 1099511628211ull;
+        }
+        return KeyHash;
+    }
+
+    uint64 GetHash() const { return m_Hash; }
+
+private:
+    constexpr explicit ConfigKey(const uint64 Hash) : m_Hash(Hash) { }
+
+    uint64 m_Hash;
+};
+
+/**
+ * Engine configuration, loaded once at startup from Unica/Config/BaseEngine.ini, then the game's
+ * Config/DefaultGame.ini and finally "-Section.Key=Value" command line arguments, each overriding the previous.
+ * Values are parsed into every type they can represent when loaded, so reading them is a hash lookup
+ */
+class UnicaConfig
+{
+public:
+    static void Init(int ArgumentCount, char* Arguments[]);
+
+    /** Parse INI formatted text into the store, overriding existing keys. Source only shows up in logs */
+    static void ParseIni(std::string_view IniText, std::string_view Source);
+
+    static void Set(std::string_view Key, std::string_view Value, std::string_view Source);
+
+    static bool Contains(const ConfigKey Key) { return m_Values.contains(Key.GetHash()); }
+
+    /** Value of Key as T, or DefaultValue when the key is missing or can't be represented as T */
+    template <typename T>
+    static T Get(const ConfigKey Key, const T& DefaultValue)
+    {
+        const std::unordered_map<uint64, ConfigValue>::const_iterator Value = m_Values.find(Key.GetHash());
+        if (Value == m_Values.end())
+        {
+            return DefaultValue;
+        }
+
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            return GetOrWarn(Value->second, Value->second.Boolean, DefaultValue);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            return static_cast<T>(GetOrWarn(Value->second, Value->second.Integer, static_cast<int64>(DefaultValue)));
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            return static_cast<T>(GetOrWarn(Value->second, Value->second.Number, static_cast<double>(DefaultValue)));
+        }
+        else
+        {
+            return T(Value->second.Text);
+        }
+    }
+
+private:
+    struct ConfigValue
+    {
+        std::string Key;
+        std::string Text;
+        std::optional<bool> Boolean;
+        std::optional<int64> Integer;
+        std::optional<double> Number;
+    };
+
+    template <typename T>
+    static T GetOrWarn(const ConfigValue& Value, const std::optional<T>& TypedValue, const T& DefaultValue)
+    {
+        if (!TypedValue.has_value())
+        {
+            UNICA_LOG_WARN("Config value '{}={}' has the wrong type, using the default instead", Value.Key, Value.Text);
+            return DefaultValue;
+        }
+        return TypedValue.value();
+    }
+
+    static void LoadIniFile(const std::filesystem::path& IniPath);
+
+    static std::unordered_map<uint64, ConfigValue> m_Values;
+};
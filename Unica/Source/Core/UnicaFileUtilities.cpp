@@ -2,17 +2,46 @@
 
 #include "UnicaFileUtilities.h"
 
-#ifdef __APPLE__
-#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
 #endif
-#include <fstream>
 
 #include "UnicaMinimal.h"
 #include "UnicaInstance.h"
+#include "IO/VirtualFileSystem.h"
+
+std::shared_mutex UnicaFileUtilities::m_ResolvedPathsMutex;
+UnicaFileUtilities::ResolvedPathMap UnicaFileUtilities::m_ResolvedPaths;
 
-std::filesystem::path UnicaFileUtilities::ResolveDirectory(std::string FileLocation)
+const std::filesystem::path& UnicaFileUtilities::ResolveDirectory(const std::string_view FileLocation)
 {
     UNICA_PROFILE_FUNCTION
+    {
+        const std::shared_lock ResolvedPathsLock(m_ResolvedPathsMutex);
+        const ResolvedPathMap::const_iterator ResolvedPath = m_ResolvedPaths.find(FileLocation);
+        if (ResolvedPath != m_ResolvedPaths.end())
+        {
+            return ResolvedPath->second;
+        }
+    }
+
+    // Resolved outside the lock, if another thread gets there first its identical result is kept
+    std::filesystem::path ResolvedPath = ResolveUninternedDirectory(FileLocation);
+    const std::unique_lock ResolvedPathsLock(m_ResolvedPathsMutex);
+    return m_ResolvedPaths.try_emplace(std::string(FileLocation), std::move(ResolvedPath)).first->second;
+}
+
+std::filesystem::path UnicaFileUtilities::ResolveUninternedDirectory(std::string_view FileLocation)
+{
     std::filesystem::path UnicaFilePath(FileLocation);
     if (UnicaFilePath.is_absolute())
     {
@@ -20,26 +49,24 @@ std::filesystem::path UnicaFileUtilities::ResolveDirectory(std::string FileLocat
     }
     
     std::filesystem::path BaseDirectory = UnicaInstance::GetProjectRootDirectory();
-    const std::string EnginePrefix = "Engine:";
-    const std::string GamePrefix = "Game:";
+    constexpr std::string_view EnginePrefix = "Engine:";
+    constexpr std::string_view GamePrefix = "Game:";
     
-    if (!FileLocation.rfind(EnginePrefix, 0))
+    if (FileLocation.starts_with(EnginePrefix))
     {
         BaseDirectory.append("Unica");
-        FileLocation.erase(0, EnginePrefix.length());
+        FileLocation.remove_prefix(EnginePrefix.length());
     }
-    else if (!FileLocation.rfind(GamePrefix, 0))
+    else if (FileLocation.starts_with(GamePrefix))
     {
         BaseDirectory.append("Game");
-        FileLocation.erase(0, GamePrefix.length());
+        FileLocation.remove_prefix(GamePrefix.length());
     }
     else
     {
-        const std::string ErrorMessage = fmt::format(
+        UNICA_LOG(spdlog::level::err,
             "Provided file location '{}' lacks a prefix '{}' or '{}', according to its location",
             FileLocation, EnginePrefix, GamePrefix);
-        
-        UNICA_LOG(spdlog::level::err, ErrorMessage);
     }
     
     UnicaFilePath = std::filesystem::path(FileLocation);
@@ -58,104 +85,110 @@ std::vector<std::filesystem::path> UnicaFileUtilities::GetFilesInPathWithExtensi
 std::vector<std::filesystem::path> UnicaFileUtilities::GetFilesInPathWithExtension(const std::string& PathToSearchString, const std::vector<std::string>& FileExtensions)
 {
     UNICA_PROFILE_FUNCTION
-    std::vector<std::filesystem::path> FinalFilesVector;
-    const std::filesystem::path PathToSearch = ResolveDirectory(PathToSearchString);
+    const std::filesystem::path& PathToSearch = ResolveDirectory(PathToSearchString);
+    std::vector<std::filesystem::path> FinalFilesVector = VirtualFileSystem::FindFiles(PathToSearch, FileExtensions);
 
-    if (!std::filesystem::is_directory(PathToSearch))
+    // The directory may only exist inside a packed archive
+    if (FinalFilesVector.empty() && !std::filesystem::is_directory(PathToSearch))
     {
         UNICA_LOG(spdlog::level::err, "Path '{}' is not valid", PathToSearch.string());
-        return FinalFilesVector;
-    }
-    
-    for (const std::filesystem::directory_entry& PathEntry : std::filesystem::recursive_directory_iterator(PathToSearch))
-    {
-        if (PathEntry.is_directory())
-        {
-            continue;
-        }
-
-        std::filesystem::path PathEntryExtension = PathEntry.path().extension();
-        for (const std::string& FileExtension : FileExtensions)
-        {
-            if (PathEntryExtension == FileExtension)
-            {
-                FinalFilesVector.push_back(PathEntry);
-                break;
-            }
-        }
     }
     
     return FinalFilesVector;
 }
 
-std::vector<char> UnicaFileUtilities::ReadFileAsBinary(const std::string& FileLocation)
+UnicaMappedFile UnicaFileUtilities::MapFile(const std::string& FileLocation, const FileAccessPattern AccessPattern)
 {
     UNICA_PROFILE_FUNCTION
-    const std::filesystem::path FileDirectory = ResolveDirectory(FileLocation);
-
-#ifdef __APPLE__
-    std::ifstream FileAsBinary(FileDirectory.c_str(), std::ios::ate);
-#else
-    std::ifstream FileAsBinary(FileDirectory.c_str(), std::ios::ate | std::ios::binary);
-#endif
-
-    if (!FileAsBinary.is_open())
-    {
-        UNICA_LOG(spdlog::level::err, "Can't open file '{}'", FileDirectory.string());
-        return { };
-    }
-
-    const std::streamsize FileSize = FileAsBinary.tellg();
-    std::vector<char> Buffer(FileSize);
+    return VirtualFileSystem::OpenFile(ResolveDirectory(FileLocation), AccessPattern);
+}
 
-    FileAsBinary.seekg(0);
-    FileAsBinary.read(Buffer.data(), FileSize);
-    
-    return Buffer;
+std::vector<char> UnicaFileUtilities::ReadFileAsBinary(const std::string& FileLocation)
+{
+    UNICA_PROFILE_FUNCTION
+    const UnicaMappedFile MappedFile = MapFile(FileLocation);
+    return { MappedFile.begin(), MappedFile.end() };
 }
 
 std::string UnicaFileUtilities::ReadFileAsString(const std::string& FileLocation)
 {
     UNICA_PROFILE_FUNCTION
-    const std::filesystem::path FileDirectory = ResolveDirectory(FileLocation);
-    
-    std::ifstream FileAsString(FileLocation);
-    if (!FileAsString.is_open())
-    {
-        UNICA_LOG(spdlog::level::err, "Can't open file '{}'", FileDirectory.string());
-        return "";
-    }
-
-#ifdef __APPLE__
-    std::basic_stringstream<char> StringBuffer;
-#else
-    std::stringstream StringBuffer;
-#endif
-
-    StringBuffer << FileAsString.rdbuf();
-    FileAsString.close();
-    return StringBuffer.str();
+    const UnicaMappedFile MappedFile = MapFile(FileLocation);
+    return std::string(MappedFile.GetStringView());
 }
 
-bool UnicaFileUtilities::WriteFile(const std::vector<char>& FileSource, const std::string& FileDestination)
+bool UnicaFileUtilities::WriteFile(const std::span<const char> FileContents, const std::string& FileDestination)
 {
     UNICA_PROFILE_FUNCTION
-    const std::filesystem::path FileDirectory = ResolveDirectory(FileDestination);
-    std::ofstream OutputFile(FileDirectory.string(), std::ios::trunc);
+    const std::filesystem::path& FilePath = ResolveDirectory(FileDestination);
+    std::error_code Error;
+    std::filesystem::create_directories(FilePath.parent_path(), Error);
 
-    if (!OutputFile)
+    // Unique per write, two threads replacing the same file mustn't write into each other's temporary file
+    static std::atomic<uint64> TemporaryFileCounter = 0;
+    std::filesystem::path TemporaryFilePath = FilePath;
+    TemporaryFilePath += "." + std::to_string(TemporaryFileCounter.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+    if (!WriteFileDurably(FileContents, TemporaryFilePath))
     {
-        UNICA_LOG(spdlog::level::err, "Can't open file '{}' for writting", FileDirectory.string());
+        UNICA_LOG(spdlog::level::err, "Can't write file '{}'", FilePath.string());
+        std::filesystem::remove(TemporaryFilePath, Error);
         return false;
     }
 
-    OutputFile.write(FileSource.data(), static_cast<std::streamsize>(FileSource.size()));
+    // Renaming within a directory is atomic, readers see the old contents or the new ones
+    std::filesystem::rename(TemporaryFilePath, FilePath, Error);
+    if (Error)
+    {
+        UNICA_LOG(spdlog::level::err, "Can't replace file '{}': {}", FilePath.string(), Error.message());
+        std::filesystem::remove(TemporaryFilePath, Error);
+        return false;
+    }
     return true;
 }
 
-bool UnicaFileUtilities::WriteFile(const std::string& FileSource, const std::string& FileDestination)
+bool UnicaFileUtilities::WriteFileDurably(const std::span<const char> FileContents, const std::filesystem::path& FilePath)
 {
-    UNICA_PROFILE_FUNCTION
-    const std::vector<char> StringToCharVector(FileSource.begin(), FileSource.end());
-    return WriteFile(StringToCharVector, FileDestination);
+#if defined(_WIN32)
+    const HANDLE File = CreateFileW(FilePath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    bool bWroteEverything = true;
+    for (size_t Offset = 0; Offset < FileContents.size() && bWroteEverything;)
+    {
+        const DWORD ChunkSize = static_cast<DWORD>(std::min<size_t>(FileContents.size() - Offset, 1u << 30));
+        DWORD WrittenSize = 0;
+        bWroteEverything = ::WriteFile(File, FileContents.data() + Offset, ChunkSize, &WrittenSize, nullptr) && WrittenSize > 0;
+        Offset += WrittenSize;
+    }
+    bWroteEverything = bWroteEverything && FlushFileBuffers(File);
+    CloseHandle(File);
+    return bWroteEverything;
+#else
+    const int File = open(FilePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (File < 0)
+    {
+        return false;
+    }
+
+    bool bWroteEverything = true;
+    for (size_t Offset = 0; Offset < FileContents.size() && bWroteEverything;)
+    {
+        const ssize_t WrittenSize = write(File, FileContents.data() + Offset, FileContents.size() - Offset);
+        if (WrittenSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        bWroteEverything = WrittenSize > 0;
+        Offset += WrittenSize > 0 ? static_cast<size_t>(WrittenSize) : 0;
+    }
+
+    // Without it the rename can reach the disk before the data does, and a power loss leaves an empty file
+    bWroteEverything = bWroteEverything && fsync(File) == 0;
+    close(File);
+    return bWroteEverything;
+#endif
 }
@@ -3,6 +3,14 @@
 #pragma once
 
 #include <filesystem>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "UnicaMappedFile.h"
 
 class UnicaFileUtilities
 {
@@ -15,10 +23,39 @@ public:
     static std::vector<std::filesystem::path> GetFilesInPathWithExtension(const std::string& PathToSearchString, const std::string& FileExtensionString);
     static std::vector<std::filesystem::path> GetFilesInPathWithExtension(const std::string& PathToSearchString, const std::vector<std::string>& FileExtensions);
     
+    /** Zero-copy read through the VirtualFileSystem, prefer it over ReadFileAsBinary and ReadFileAsString when the contents don't need to outlive the view */
+    static UnicaMappedFile MapFile(const std::string& FileLocation, FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
     static std::vector<char> ReadFileAsBinary(const std::string& FileLocation);
     static std::string ReadFileAsString(const std::string& FileLocation);
-    static bool WriteFile(const std::vector<char>& FileSource, const std::string& FileDestination);
-    static bool WriteFile(const std::string& FileSource, const std::string& FileDestination);
+    /**
+     * Replace the file at FileDestination, creating its directory if needed. The contents go to a temporary file next
+     * to it that is flushed to disk and renamed over it, so a crash leaves either the old file or the new one, never a
+     * truncated one. Blocks until the data is on disk, see AsyncFileWriter to keep that off the main thread
+     */
+    static bool WriteFile(std::span<const char> FileContents, const std::string& FileDestination);
     
-    static std::filesystem::path ResolveDirectory(std::string FileLocation);
+    /**
+     * Absolute path of a Unica path, e.g. "Engine:Shaders/shader.vert". Each path is resolved once and interned, later
+     * calls are a hash lookup returning the same reference, valid until the program exits. Safe to call from any thread,
+     * once the project root directory is set
+     */
+    static const std::filesystem::path& ResolveDirectory(std::string_view FileLocation);
+
+private:
+    /** Write FileContents to FilePath and wait until they're on disk */
+    static bool WriteFileDurably(std::span<const char> FileContents, const std::filesystem::path& FilePath);
+    static std::filesystem::path ResolveUninternedDirectory(std::string_view FileLocation);
+
+    /** Lets the table be probed with a string_view without building a std::string first */
+    struct ResolvedPathHash
+    {
+        using is_transparent = void;
+        size_t operator()(const std::string_view FileLocation) const { return std::hash<std::string_view>()(FileLocation); }
+    };
+
+    // Node based, so references to resolved paths survive rehashing
+    using ResolvedPathMap = std::unordered_map<std::string, std::filesystem::path, ResolvedPathHash, std::equal_to<>>;
+
+    static std::shared_mutex m_ResolvedPathsMutex;
+    static ResolvedPathMap m_ResolvedPaths;
 };
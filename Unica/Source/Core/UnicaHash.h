@@ -0,0 +1,42 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "UnicaMinimal.h"
+
+/**
+ * FNV-1a, for the keys of caches whose inputs are small next to the work they save, e.g. shader sources or pipeline
+ * descriptions. Stable across runs and platforms, so keys can be stored on disk. Not meant for large buffers
+ */
+namespace UnicaHash
+{
+    constexpr uint64 OffsetBasis = 14695981039346656037ull;
+    constexpr uint64 Prime = 1099511628211ull;
+
+    inline uint64 HashBytes(const std::span<const char> Bytes, uint64 Hash = OffsetBasis)
+    {
+        for (const char Byte : Bytes)
+        {
+            Hash = (Hash ^ static_cast<uint8>(Byte)) * Prime;
+        }
+        return Hash;
+    }
+
+    /** Hash each member of a struct instead of the struct itself, its padding bytes are undefined */
+    template <typename T>
+    uint64 HashValue(const T& Value, const uint64 Hash = OffsetBasis)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only hash values whose bytes are their contents");
+        return HashBytes(std::span<const char>(reinterpret_cast<const char*>(&Value), sizeof(T)), Hash);
+    }
+
+    /** Strings are hashed with their size, so adjacent ones can't run into each other */
+    inline uint64 HashString(const std::string_view String, const uint64 Hash = OffsetBasis)
+    {
+        return HashBytes(String, HashValue(String.size(), Hash));
+    }
+}
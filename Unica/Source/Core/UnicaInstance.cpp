@@ -2,8 +2,16 @@
 
 #include "UnicaInstance.h"
 
+#include "UnicaFileUtilities.h"
 #include "UnicaMinimal.h"
 #include "UnicaSettings.h"
+#include "IO/AsyncFileWriter.h"
+#include "IO/VirtualFileSystem.h"
+#include "Logging/BinaryLogSink.h"
+#include "Memory/FrameArena.h"
+#include "Memory/HeapAllocationTracker.h"
+#include "Timer/FramePacer.h"
+#include "Timer/FrameStatistics.h"
 #include "Timer/TimeManager.h"
 
 bool UnicaInstance::m_bHasRequestedExit = false;
@@ -11,6 +19,24 @@ std::filesystem::path UnicaInstance::m_ProjectRootDirectory;
 
 void UnicaInstance::Init()
 {
+    UnicaSettings::Load();
+    Logger::SetLevel(UnicaSettings::LogLevel);
+    if (UnicaSettings::bBinaryLogging)
+    {
+        Logger::AddRecordSink(std::make_unique<BinaryLogSink>(UnicaSettings::BinaryLogLevel,
+            UnicaFileUtilities::ResolveDirectory("Engine:Saved/Logs"), UnicaSettings::BinaryLogFileSize, UnicaSettings::BinaryLogFileCount));
+    }
+    if (UnicaSettings::bAsyncLogging)
+    {
+        Logger::StartAsync();
+    }
+    AsyncFileWriter::Start();
+    if (UnicaSettings::bMountPackedArchives)
+    {
+        VirtualFileSystem::MountArchives("Engine:Paks", "Engine:");
+        VirtualFileSystem::MountArchives("Game:Paks", "Game:");
+    }
+
     m_SubsystemManager = std::make_unique<SubsystemManager>();
     m_SubsystemManager->Init();
 }
@@ -18,42 +44,51 @@ void UnicaInstance::Init()
 void UnicaInstance::TickLogic()
 {
     UNICA_PROFILE_FUNCTION
+    const uint32 FixedTickCount = TimeManager::AdvanceFrame();
+    for (uint32 FixedTickIndex = 0; FixedTickIndex < FixedTickCount; FixedTickIndex++)
+    {
+        m_SubsystemManager->FixedTickSubsystems();
+    }
+
 	m_SubsystemManager->TickSubsystems();
 }
 
 void UnicaInstance::Tick()
 {
     UNICA_PROFILE_FUNCTION
-    
-    if (UnicaSettings::FrameTimeLimit <= 0)
-    {
-        TickLogic();
-        return;
-    }
+    FrameArena::BeginFrame();
 
     const std::chrono::time_point StartWorkTime = std::chrono::steady_clock::now();
-    const std::chrono::time_point NextFrameTimeTarget = StartWorkTime + std::chrono::nanoseconds(static_cast<uint64>(UnicaSettings::FrameTimeLimit * 1'000'000));
 
     TickLogic();
 
+    // Read after ticking, so a frame that enters or leaves idle mode is already paced accordingly
+    const float FrameTimeLimit = FramePacer::GetFrameTimeLimitMillis();
+    const std::chrono::time_point NextFrameTimeTarget = StartWorkTime + std::chrono::nanoseconds(static_cast<uint64>(FrameTimeLimit * 1'000'000));
     const std::chrono::time_point FinishWorkTime = std::chrono::steady_clock::now();
     const std::chrono::nanoseconds SleepDuration = NextFrameTimeTarget - FinishWorkTime;
-    TimeManager::SetFrameWorkDuration(static_cast<float>((FinishWorkTime - StartWorkTime).count()) / 1'000'000);
 
-    if (SleepDuration <= std::chrono::nanoseconds())
+    // Nothing presents while idle, so not even VSync pacing can be left to the swap chain
+    if (FrameTimeLimit > 0 && (FramePacer::IsPacingOnCpu() || FramePacer::IsIdle()))
     {
-		TimeManager::SetFrameSleepDuration(0);
-        return;
+        if (SleepDuration <= std::chrono::nanoseconds())
+        {
+            TimeManager::SetFramePacingError(static_cast<float>(-SleepDuration.count()) / 1'000'000);
+        }
+        else
+        {
+            const std::chrono::nanoseconds PacingError = FramePacer::WaitUntil(NextFrameTimeTarget);
+            TimeManager::SetFramePacingError(static_cast<float>(PacingError.count()) / 1'000'000);
+        }
     }
-    
-	TimeManager::SetFrameSleepDuration(static_cast<float>(SleepDuration.count()) / 1'000'000);
-    Sleep(NextFrameTimeTarget.time_since_epoch().count());
-}
 
-void UnicaInstance::Sleep(const uint64 NextFrameTimeTargetCount)
-{
-    UNICA_PROFILE_FUNCTION
-    while (std::chrono::steady_clock::now().time_since_epoch().count() < NextFrameTimeTargetCount);
+    // Idle frames are slow by design and would read as hitches
+    const std::chrono::time_point FinishFrameTime = std::chrono::steady_clock::now();
+    if (!FramePacer::IsIdle())
+    {
+        FrameStatistics::RecordFrame(FinishFrameTime - StartWorkTime, FinishWorkTime - StartWorkTime, FinishFrameTime - FinishWorkTime);
+    }
+    HeapAllocationTracker::ReportFrameAllocations();
 }
 
 void UnicaInstance::SetProjectRootDirectory(char* SystemStyledExecutableDirectory)
@@ -88,4 +123,7 @@ void UnicaInstance::SetProjectRootDirectory(char* SystemStyledExecutableDirector
 void UnicaInstance::Shutdown()
 {
     m_SubsystemManager->Shutdown();
+    // Subsystems queue their final dumps while shutting down
+    AsyncFileWriter::Shutdown();
+    VirtualFileSystem::UnmountAll();
 }
@@ -17,13 +17,11 @@ public:
     static bool HasRequestedExit() { return m_bHasRequestedExit; }
     static void RequestExit() { m_bHasRequestedExit = true; }
     
-    static std::filesystem::path GetProjectRootDirectory() { return m_ProjectRootDirectory; }
+    static const std::filesystem::path& GetProjectRootDirectory() { return m_ProjectRootDirectory; }
     static void SetProjectRootDirectory(char* SystemStyledExecutableDirectory);
 
 private:
     void TickLogic();
-
-    void Sleep(const uint64 NextFrameTimeTargetCount);
     
     std::unique_ptr<SubsystemManager> m_SubsystemManager;
     
@@ -0,0 +1,193 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "UnicaMappedFile.h"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct UnicaMappedFile::MappedRegion
+{
+    MappedRegion() = default;
+    MappedRegion(const MappedRegion&) = delete;
+    MappedRegion& operator=(const MappedRegion&) = delete;
+
+    ~MappedRegion()
+    {
+        if (!MappedData)
+        {
+            return;
+        }
+
+#if defined(_WIN32)
+        UnmapViewOfFile(MappedData);
+#else
+        munmap(MappedData, MappedSize);
+#endif
+    }
+
+    const char* GetData() const { return MappedData ? static_cast<const char*>(MappedData) : BufferedData.data(); }
+    size_t GetSize() const { return MappedData ? MappedSize : BufferedData.size(); }
+
+    void* MappedData = nullptr;
+    size_t MappedSize = 0;
+
+    // Only used when mapping failed or the data never came from a file
+    std::vector<char> BufferedData;
+};
+
+UnicaMappedFile::UnicaMappedFile(std::shared_ptr<const MappedRegion> Region, const char* Data, const size_t Size)
+    : m_Region(std::move(Region)), m_Data(Data), m_Size(Size)
+{
+}
+
+UnicaMappedFile UnicaMappedFile::Open(const std::filesystem::path& FilePath, const FileAccessPattern AccessPattern)
+{
+    UNICA_PROFILE_FUNCTION
+    std::shared_ptr<MappedRegion> Region = MapRegion(FilePath, AccessPattern);
+    if (!Region)
+    {
+        Region = ReadRegion(FilePath);
+    }
+
+    if (!Region)
+    {
+        UNICA_LOG(spdlog::level::err, "Can't open file '{}'", FilePath.string());
+        return { };
+    }
+
+    const char* Data = Region->GetData();
+    const size_t Size = Region->GetSize();
+    return { std::move(Region), Data, Size };
+}
+
+UnicaMappedFile UnicaMappedFile::FromBuffer(std::vector<char> Buffer)
+{
+    std::shared_ptr<MappedRegion> Region = std::make_shared<MappedRegion>();
+    Region->BufferedData = std::move(Buffer);
+
+    const char* Data = Region->GetData();
+    const size_t Size = Region->GetSize();
+    return { std::move(Region), Data, Size };
+}
+
+UnicaMappedFile UnicaMappedFile::Slice(const size_t Offset, const size_t Size) const
+{
+    const size_t SliceOffset = std::min(Offset, m_Size);
+    return { m_Region, m_Data + SliceOffset, std::min(Size, m_Size - SliceOffset) };
+}
+
+bool UnicaMappedFile::IsMapped() const
+{
+    return m_Region && m_Region->MappedData;
+}
+
+void UnicaMappedFile::Prefault() const
+{
+    UNICA_PROFILE_FUNCTION
+    if (!IsMapped())
+    {
+        return;
+    }
+
+    // A single read is enough to fault in its whole page
+    constexpr size_t PageSize = 4096;
+    char Checksum = 0;
+    for (size_t Offset = 0; Offset < m_Size; Offset += PageSize)
+    {
+        Checksum ^= m_Data[Offset];
+    }
+
+    volatile char PrefaultSink = Checksum;
+    static_cast<void>(PrefaultSink);
+}
+
+std::shared_ptr<UnicaMappedFile::MappedRegion> UnicaMappedFile::MapRegion(const std::filesystem::path& FilePath, const FileAccessPattern AccessPattern)
+{
+    std::shared_ptr<MappedRegion> Region = std::make_shared<MappedRegion>();
+
+#if defined(_WIN32)
+    const DWORD AccessHint = AccessPattern == FileAccessPattern::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+    const HANDLE File = CreateFileW(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | AccessHint, nullptr);
+    if (File == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    LARGE_INTEGER FileSize;
+    if (!GetFileSizeEx(File, &FileSize) || FileSize.QuadPart == 0)
+    {
+        // Empty files can't be mapped, the buffered fallback handles them just as well
+        CloseHandle(File);
+        return nullptr;
+    }
+
+    const HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (Mapping)
+    {
+        Region->MappedData = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+        Region->MappedSize = static_cast<size_t>(FileSize.QuadPart);
+        CloseHandle(Mapping);
+    }
+    CloseHandle(File);
+#else
+    const int File = open(FilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (File < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat FileStatus;
+    if (fstat(File, &FileStatus) != 0 || !S_ISREG(FileStatus.st_mode) || FileStatus.st_size == 0)
+    {
+        // Empty files can't be mapped, the buffered fallback handles them just as well
+        close(File);
+        return nullptr;
+    }
+
+    Region->MappedSize = static_cast<size_t>(FileStatus.st_size);
+    void* Mapping = mmap(nullptr, Region->MappedSize, PROT_READ, MAP_PRIVATE, File, 0);
+    close(File);
+    if (Mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    Region->MappedData = Mapping;
+    if (AccessPattern == FileAccessPattern::Sequential)
+    {
+        // Start paging in right away, the whole file is about to be read front to back
+        madvise(Mapping, Region->MappedSize, MADV_SEQUENTIAL);
+        madvise(Mapping, Region->MappedSize, MADV_WILLNEED);
+    }
+    else
+    {
+        madvise(Mapping, Region->MappedSize, MADV_RANDOM);
+    }
+#endif
+
+    return Region->MappedData ? Region : nullptr;
+}
+
+std::shared_ptr<UnicaMappedFile::MappedRegion> UnicaMappedFile::ReadRegion(const std::filesystem::path& FilePath)
+{
+    std::ifstream File(FilePath, std::ios::binary);
+    if (!File.is_open())
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedRegion> Region = std::make_shared<MappedRegion>();
+    Region->BufferedData.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+    return Region;
+}
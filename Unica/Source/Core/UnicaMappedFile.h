@@ -0,0 +1,66 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+/** How a mapped file is going to be read, so the OS knows whether reading ahead is worth it */
+enum class FileAccessPattern : uint8
+{
+    Sequential,
+    Random
+};
+
+/**
+ * Read-only view of a whole file, or a slice of one, memory mapped so its contents never get copied into the
+ * process. Copies share the mapping, which is released when the last of them goes away, so slices can be handed
+ * around freely. Files that can't be mapped are read into memory instead, behind the same interface
+ */
+class UnicaMappedFile
+{
+public:
+    UnicaMappedFile() = default;
+
+    /** Returns an invalid view when the file can't be opened */
+    static UnicaMappedFile Open(const std::filesystem::path& FilePath, FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+
+    /** Wraps data that was produced in memory, e.g. decompressed, so it can be handed out like any other file */
+    static UnicaMappedFile FromBuffer(std::vector<char> Buffer);
+
+    /** Shares this view's mapping, clamped to its bounds */
+    UnicaMappedFile Slice(size_t Offset, size_t Size = SIZE_MAX) const;
+
+    bool IsValid() const { return m_Region != nullptr; }
+    /** Whether the data comes straight from the OS page cache, as opposed to the buffered read fallback */
+    bool IsMapped() const;
+
+    /** Bring every page in now, so the thread that reads the data later doesn't wait on the disk */
+    void Prefault() const;
+
+    const char* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+    bool IsEmpty() const { return m_Size == 0; }
+
+    std::span<const char> GetView() const { return { m_Data, m_Size }; }
+    std::string_view GetStringView() const { return { m_Data, m_Size }; }
+    const char* begin() const { return m_Data; }
+    const char* end() const { return m_Data + m_Size; }
+
+private:
+    struct MappedRegion;
+
+    UnicaMappedFile(std::shared_ptr<const MappedRegion> Region, const char* Data, size_t Size);
+
+    static std::shared_ptr<MappedRegion> MapRegion(const std::filesystem::path& FilePath, FileAccessPattern AccessPattern);
+    static std::shared_ptr<MappedRegion> ReadRegion(const std::filesystem::path& FilePath);
+
+    std::shared_ptr<const MappedRegion> m_Region;
+    const char* m_Data = nullptr;
+    size_t m_Size = 0;
+};
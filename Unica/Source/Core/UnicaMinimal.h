@@ -24,14 +24,24 @@ typedef uint64_t uint64;
 
 #define UNICA_PROFILE_FUNCTION ZoneScoped;
 #define UNICA_PROFILE_FUNCTION_NAMED(x) ZoneScopedN(x)
+#define UNICA_PROFILE_FUNCTION_DYNAMIC(x) ZoneTransientN(UnicaDynamicZone, x, true)
+#define UNICA_PROFILE_THREAD(x) tracy::SetThreadName(x)
 #define UNICA_PROFILE_FRAME_START(x) FrameMarkStart(x)
 #define UNICA_PROFILE_FRAME_END(x) FrameMarkEnd(x)
 #define UNICA_PROFILE_FRAME(x) FrameMarkNamed(x)
-
-#define UNICA_LOG(LogLevel, ...) SPDLOG_LOGGER_CALL(Logger::GetCoreLogger(), LogLevel, __VA_ARGS__);if(LogLevel==spdlog::level::critical)throw
-#define UNICA_LOG_TRACE(...) SPDLOG_LOGGER_TRACE(Logger::GetCoreLogger(), __VA_ARGS__)
-#define UNICA_LOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(Logger::GetCoreLogger(), __VA_ARGS__)
-#define UNICA_LOG_INFO(...) SPDLOG_LOGGER_INFO(Logger::GetCoreLogger(), __VA_ARGS__)
-#define UNICA_LOG_WARN(...) SPDLOG_LOGGER_WARN(Logger::GetCoreLogger(), __VA_ARGS__)
-#define UNICA_LOG_ERROR(...) SPDLOG_LOGGER_ERROR(Logger::GetCoreLogger(), __VA_ARGS__)
-#define UNICA_LOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(Logger::GetCoreLogger(), __VA_ARGS__);throw
+#define UNICA_PROFILE_PLOT(Name, Value) TracyPlot(Name, Value)
+
+// Trace and debug logs compile out of shipping builds, format strings must be literals so they're checked at compile time
+#define UNICA_LOG_SOURCE spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}
+#define UNICA_LOG(LogLevel, ...) if(!((!UNICA_SHIPPING||LogLevel>=spdlog::level::info)&&Logger::ShouldLog(LogLevel))){}else Logger::Log(UNICA_LOG_SOURCE, LogLevel, __VA_ARGS__);if(LogLevel==spdlog::level::critical)Logger::Flush(),throw
+#if UNICA_SHIPPING
+#define UNICA_LOG_TRACE(...) (void)0
+#define UNICA_LOG_DEBUG(...) (void)0
+#else
+#define UNICA_LOG_TRACE(...) if(!Logger::ShouldLog(spdlog::level::trace)){}else Logger::Log(UNICA_LOG_SOURCE, spdlog::level::trace, __VA_ARGS__)
+#define UNICA_LOG_DEBUG(...) if(!Logger::ShouldLog(spdlog::level::debug)){}else Logger::Log(UNICA_LOG_SOURCE, spdlog::level::debug, __VA_ARGS__)
+#endif
+#define UNICA_LOG_INFO(...) if(!Logger::ShouldLog(spdlog::level::info)){}else Logger::Log(UNICA_LOG_SOURCE, spdlog::level::info, __VA_ARGS__)
+#define UNICA_LOG_WARN(...) if(!Logger::ShouldLog(spdlog::level::warn)){}else Logger::Log(UNICA_LOG_SOURCE, spdlog::level::warn, __VA_ARGS__)
+#define UNICA_LOG_ERROR(...) if(!Logger::ShouldLog(spdlog::level::err)){}else Logger::Log(UNICA_LOG_SOURCE, spdlog::level::err, __VA_ARGS__)
+#define UNICA_LOG_CRITICAL(...) Logger::Log(UNICA_LOG_SOURCE, spdlog::level::critical, __VA_ARGS__);Logger::Flush();throw
@@ -0,0 +1,74 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Fixed size lock-free queue for exactly one producer thread and one consumer thread.
+ * Push never blocks and fails when the consumer fell behind by Capacity items
+ */
+template <typename T, uint32 Capacity>
+class UnicaRingBuffer
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "UnicaRingBuffer capacity must be a power of two");
+
+public:
+    /** Producer thread only */
+    bool Push(const T& Item)
+    {
+        const uint64 Head = m_Head.load(std::memory_order_relaxed);
+        if (Head - m_CachedTail >= Capacity)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (Head - m_CachedTail >= Capacity)
+            {
+                return false;
+            }
+        }
+
+        m_Items[Head & CapacityMask] = Item;
+        m_Head.store(Head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer thread only */
+    bool Pop(T& OutItem)
+    {
+        const uint64 Tail = m_Tail.load(std::memory_order_relaxed);
+        if (Tail == m_CachedHead)
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (Tail == m_CachedHead)
+            {
+                return false;
+            }
+        }
+
+        OutItem = std::move(m_Items[Tail & CapacityMask]);
+        m_Tail.store(Tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Approximate when called from neither the producer nor the consumer */
+    uint32 GetSize() const
+    {
+        return static_cast<uint32>(m_Head.load(std::memory_order_acquire) - m_Tail.load(std::memory_order_acquire));
+    }
+
+private:
+    static constexpr uint64 CapacityMask = Capacity - 1;
+
+    // Producer and consumer indices live on separate cache lines so each side only invalidates its own.
+    // Each side also caches the other's index and only reloads it when the queue looks full or empty
+    alignas(64) std::atomic<uint64> m_Head = 0;
+    uint64 m_CachedTail = 0;
+
+    alignas(64) std::atomic<uint64> m_Tail = 0;
+    uint64 m_CachedHead = 0;
+
+    alignas(64) std::array<T, Capacity> m_Items { };
+};
@@ -0,0 +1,122 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "UnicaSettings.h"
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
+
+#include "UnicaConfig.h"
+
+namespace
+{
+    constexpr std::array<std::pair<std::string_view, FramePacingMode>, 4> FramePacingModeNames = {{
+        { "Spin", FramePacingMode::Spin },
+        { "Hybrid", FramePacingMode::Hybrid },
+        { "Sleep", FramePacingMode::Sleep },
+        { "VSync", FramePacingMode::VSync }
+    }};
+
+    constexpr std::array<std::pair<std::string_view, PresentModePreference>, 3> PresentModeNames = {{
+        { "Mailbox", PresentModePreference::Mailbox },
+        { "Immediate", PresentModePreference::Immediate },
+        { "Fifo", PresentModePreference::Fifo }
+    }};
+
+    template <typename T, size_t NameCount>
+    T GetEnum(const ConfigKey Key, const std::array<std::pair<std::string_view, T>, NameCount>& Names, const T DefaultValue)
+    {
+        if (!UnicaConfig::Contains(Key))
+        {
+            return DefaultValue;
+        }
+
+        const std::string Name = UnicaConfig::Get<std::string>(Key, "");
+        for (const std::pair<std::string_view, T>& NamedValue : Names)
+        {
+            if (NamedValue.first == Name)
+            {
+                return NamedValue.second;
+            }
+        }
+
+        UNICA_LOG_WARN("Unknown config value '{}', using the default instead", Name);
+        return DefaultValue;
+    }
+
+    spdlog::level::level_enum GetLogLevel(const ConfigKey Key, const spdlog::level::level_enum DefaultValue)
+    {
+        if (!UnicaConfig::Contains(Key))
+        {
+            return DefaultValue;
+        }
+
+        // spdlog maps unknown names to off, which would silently mute the engine
+        const std::string LogLevelName = UnicaConfig::Get<std::string>(Key, "");
+        const spdlog::level::level_enum ParsedLogLevel = spdlog::level::from_str(LogLevelName);
+        if (ParsedLogLevel == spdlog::level::off && LogLevelName != "off")
+        {
+            UNICA_LOG_WARN("Unknown log level '{}'", LogLevelName);
+            return DefaultValue;
+        }
+        return ParsedLogLevel;
+    }
+}
+
+void UnicaSettings::Load()
+{
+    UNICA_PROFILE_FUNCTION
+    WindowWidth = UnicaConfig::Get("Engine.WindowWidth", WindowWidth);
+    WindowHeight = UnicaConfig::Get("Engine.WindowHeight", WindowHeight);
+    ApplicationName = UnicaConfig::Get("Engine.ApplicationName", ApplicationName);
+
+    if (UnicaConfig::Contains("Engine.FrameRateLimit"))
+    {
+        const float FrameRateLimit = UnicaConfig::Get("Engine.FrameRateLimit", 0.f);
+        FrameTimeLimit = FrameRateLimit > 0 ? 1000.f / FrameRateLimit : 0;
+    }
+    if (UnicaConfig::Contains("Engine.IdleFrameRate"))
+    {
+        // A minimized window has nothing to show for running uncapped, keep the default rate instead of spinning
+        const float IdleFrameRate = UnicaConfig::Get("Engine.IdleFrameRate", 0.f);
+        if (IdleFrameRate > 0)
+        {
+            IdleFrameTimeLimit = 1000.f / IdleFrameRate;
+        }
+        else
+        {
+            UNICA_LOG_WARN("Engine.IdleFrameRate must be positive, using the default instead");
+        }
+    }
+    FramePacing = GetEnum("Engine.FramePacing", FramePacingModeNames, FramePacing);
+    FixedTickRate = UnicaConfig::Get("Engine.FixedTickRate", FixedTickRate);
+    MaxFixedTicksPerFrame = UnicaConfig::Get("Engine.MaxFixedTicksPerFrame", MaxFixedTicksPerFrame);
+
+    MaxFramesInFlight = static_cast<uint8>(std::clamp(UnicaConfig::Get("Renderer.MaxFramesInFlight", static_cast<uint32>(MaxFramesInFlight)), 1u, 4u));
+    PresentMode = GetEnum("Renderer.PresentMode", PresentModeNames, PresentMode);
+    bCompileShaders = UnicaConfig::Get("Renderer.CompileShaders", bCompileShaders);
+    bHotReloadShaders = UnicaConfig::Get("Renderer.HotReloadShaders", bHotReloadShaders);
+    GpuMemoryBlockSize = UnicaConfig::Get("Renderer.GpuMemoryBlockSize", GpuMemoryBlockSize);
+
+    JobWorkerThreadCount = UnicaConfig::Get("Jobs.WorkerThreadCount", JobWorkerThreadCount);
+    IoThreadCount = UnicaConfig::Get("IO.ThreadCount", IoThreadCount);
+    bMountPackedArchives = UnicaConfig::Get("IO.MountPackedArchives", bMountPackedArchives);
+    bLooseFileOverlay = UnicaConfig::Get("IO.LooseFileOverlay", bLooseFileOverlay);
+    bWatchFiles = UnicaConfig::Get("IO.WatchFiles", bWatchFiles);
+
+    HitchFrameTimeMultiplier = UnicaConfig::Get("Profiling.HitchFrameTimeMultiplier", HitchFrameTimeMultiplier);
+    bDumpFrameStatistics = UnicaConfig::Get("Profiling.DumpFrameStatistics", bDumpFrameStatistics);
+    bReportFrameHeapAllocations = UnicaConfig::Get("Profiling.ReportFrameHeapAllocations", bReportFrameHeapAllocations);
+    bFatalFrameHeapAllocations = UnicaConfig::Get("Profiling.FatalFrameHeapAllocations", bFatalFrameHeapAllocations);
+    FrameHeapAllocationWarmupFrames = UnicaConfig::Get("Profiling.FrameHeapAllocationWarmupFrames", FrameHeapAllocationWarmupFrames);
+
+    FrameArenaBlockSize = UnicaConfig::Get("Memory.FrameArenaBlockSize", FrameArenaBlockSize);
+
+    LogLevel = GetLogLevel("Log.Level", LogLevel);
+    bAsyncLogging = UnicaConfig::Get("Log.Async", bAsyncLogging);
+    bBinaryLogging = UnicaConfig::Get("Log.Binary", bBinaryLogging);
+    BinaryLogLevel = GetLogLevel("Log.BinaryLevel", BinaryLogLevel);
+    BinaryLogFileSize = UnicaConfig::Get("Log.BinaryFileSize", BinaryLogFileSize);
+    BinaryLogFileCount = UnicaConfig::Get("Log.BinaryFileCount", BinaryLogFileCount);
+}
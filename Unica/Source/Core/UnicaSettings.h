@@ -2,12 +2,87 @@
 
 #pragma once
 
+#include <string>
+
+#include "UnicaMinimal.h"
+#include "Timer/FramePacer.h"
+
+enum class PresentModePreference : uint8
+{
+    // Never tears and always presents the newest frame, falls back to Fifo when unsupported
+    Mailbox,
+    // Presents right away and may tear, falls back to Fifo when unsupported
+    Immediate,
+    // Waits for the display refresh
+    Fifo
+};
+
+/**
+ * Engine settings, defaulting to the values below and loaded from UnicaConfig on startup.
+ * See Unica/Config/BaseEngine.ini for the keys each of them is read from
+ */
 namespace UnicaSettings
 {
-	static const uint32 WindowWidth = 1270;
-	static const uint32 WindowHeight = 900;
-	static const float FrameTimeLimit = /* 1 second */ 1000.f / /* FPS */ 30;
+	/** Read every setting from UnicaConfig. Must run before any subsystem initializes */
+	void Load();
+
+	inline uint32 WindowWidth = 1270;
+	inline uint32 WindowHeight = 900;
+	// Milliseconds, zero leaves the frame rate uncapped
+	inline float FrameTimeLimit = /* 1 second */ 1000.f / /* FPS */ 30;
+	inline FramePacingMode FramePacing = FramePacingMode::Hybrid;
+	// Milliseconds per frame while the window is minimized and nothing renders, see FramePacer::IsIdle. Never zero
+	inline float IdleFrameTimeLimit = /* 1 second */ 1000.f / /* FPS */ 10;
+
+	// Rate, in Hz, subsystems FixedTick at regardless of the frame rate. Zero disables fixed ticking
+	inline float FixedTickRate = 60.f;
+	// Upper bound of fixed ticks a single slow frame can run to catch up with real time
+	inline uint32 MaxFixedTicksPerFrame = 5;
+
+	inline uint8 MaxFramesInFlight = 2;
+	// Only used when the CPU paces frames, VSync pacing always presents in Fifo mode
+	inline PresentModePreference PresentMode = PresentModePreference::Mailbox;
+	// Compile GLSL at runtime, cached in Unica/Saved/ShaderCache. Off only loads the .spv files next to the sources
+	inline bool bCompileShaders = true;
+	// Rebuild the pipeline when a shader source changes. Needs bCompileShaders and bWatchFiles
+	inline bool bHotReloadShaders = true;
+	// Device memory blocks buffers and images are sub-allocated from, see VulkanMemoryAllocator. Resources past half of it get their own
+	inline uint64 GpuMemoryBlockSize = 256 * 1024 * 1024;
+
+	// A frame slower than the rolling median by this factor counts as a hitch
+	inline float HitchFrameTimeMultiplier = 2.f;
+	// Write the frame timings to Unica/Saved as CSV and JSON on shutdown
+	inline bool bDumpFrameStatistics = true;
+
+	// Size of each of the two FrameArena buffers every thread allocates from, grown automatically when a frame overflows it
+	inline size_t FrameArenaBlockSize = 1024 * 1024;
+	// Warn about every frame that still allocates from the general heap. Non-shipping builds only
+	inline bool bReportFrameHeapAllocations = false;
+	// Stop the engine on the first frame reported instead, to catch the allocation in a debugger or a test run
+	inline bool bFatalFrameHeapAllocations = false;
+	// Frames to skip before reporting, while caches and pools are still filling up
+	inline uint64 FrameHeapAllocationWarmupFrames = 120;
+
+	// Zero spawns one worker per available core, minus the main thread
+	inline uint32 JobWorkerThreadCount = 0;
+	// Threads AsyncIoManager reads files on
+	inline uint32 IoThreadCount = 2;
+	// Mount the packed archives in Unica/Paks and Game/Paks, see VirtualFileSystem
+	inline bool bMountPackedArchives = true;
+	// Loose files on disk take priority over archived ones. Meant for development, it costs a file system query per open
+	inline bool bLooseFileOverlay = true;
+	// Index the loose files under Engine: and Game: and publish their changes, see FileWatcher. Linux only for now
+	inline bool bWatchFiles = true;
+
+	inline spdlog::level::level_enum LogLevel = spdlog::level::trace;
+	// Format and write logs on a background thread instead of the thread logging them
+	inline bool bAsyncLogging = true;
+	// Also write logs unformatted to rotating files in Unica/Saved/Logs, see Tools/UnicaLogDecoder
+	inline bool bBinaryLogging = false;
+	inline spdlog::level::level_enum BinaryLogLevel = spdlog::level::trace;
+	inline size_t BinaryLogFileSize = 64 * 1024 * 1024;
+	inline uint32 BinaryLogFileCount = 4;
 
-	static const std::string EngineName = "Unica Engine";
-	static const std::string ApplicationName = "Unica Sandbox";
+	inline std::string EngineName = "Unica Engine";
+	inline std::string ApplicationName = "Unica Sandbox";
 }
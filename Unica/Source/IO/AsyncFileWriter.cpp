@@ -0,0 +1,146 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "AsyncFileWriter.h"
+
+#include <span>
+#include <unordered_set>
+
+#include "UnicaFileUtilities.h"
+
+std::thread AsyncFileWriter::m_WriterThread;
+std::mutex AsyncFileWriter::m_QueueMutex;
+std::condition_variable AsyncFileWriter::m_QueueWakeup;
+std::condition_variable AsyncFileWriter::m_WritesCompleted;
+std::vector<AsyncFileWriter::QueuedWrite> AsyncFileWriter::m_QueuedWrites;
+bool AsyncFileWriter::m_bWriterRunning = false;
+uint64 AsyncFileWriter::m_SubmittedWriteCount = 0;
+uint64 AsyncFileWriter::m_CompletedWriteCount = 0;
+
+void AsyncFileWriter::Start()
+{
+    const std::lock_guard QueueLock(m_QueueMutex);
+    if (m_bWriterRunning)
+    {
+        return;
+    }
+
+    m_bWriterRunning = true;
+    m_WriterThread = std::thread(&AsyncFileWriter::WriterLoop);
+}
+
+void AsyncFileWriter::Shutdown()
+{
+    {
+        const std::lock_guard QueueLock(m_QueueMutex);
+        if (!m_bWriterRunning)
+        {
+            return;
+        }
+        m_bWriterRunning = false;
+    }
+    m_QueueWakeup.notify_one();
+
+    // The writer drains the queue before it exits
+    m_WriterThread.join();
+}
+
+void AsyncFileWriter::WriteFile(std::vector<char> FileContents, std::string FileDestination)
+{
+    Enqueue({ std::move(FileDestination), std::move(FileContents) });
+}
+
+void AsyncFileWriter::WriteFile(std::string FileContents, std::string FileDestination)
+{
+    Enqueue({ std::move(FileDestination), std::move(FileContents) });
+}
+
+void AsyncFileWriter::Flush()
+{
+    UNICA_PROFILE_FUNCTION
+    std::unique_lock QueueLock(m_QueueMutex);
+    const uint64 FlushTarget = m_SubmittedWriteCount;
+    m_WritesCompleted.wait(QueueLock, [FlushTarget] { return m_CompletedWriteCount >= FlushTarget; });
+}
+
+uint64 AsyncFileWriter::GetQueuedWriteCount()
+{
+    const std::lock_guard QueueLock(m_QueueMutex);
+    return m_SubmittedWriteCount - m_CompletedWriteCount;
+}
+
+void AsyncFileWriter::Enqueue(QueuedWrite&& Write)
+{
+    {
+        std::unique_lock QueueLock(m_QueueMutex);
+        if (m_bWriterRunning)
+        {
+            m_QueuedWrites.push_back(std::move(Write));
+            m_SubmittedWriteCount++;
+            QueueLock.unlock();
+            m_QueueWakeup.notify_one();
+            return;
+        }
+    }
+
+    WriteNow(Write);
+}
+
+void AsyncFileWriter::WriterLoop()
+{
+    UNICA_PROFILE_THREAD("AsyncFileWriter");
+
+    std::vector<QueuedWrite> Writes;
+    while (true)
+    {
+        {
+            std::unique_lock QueueLock(m_QueueMutex);
+            m_QueueWakeup.wait(QueueLock, [] { return !m_QueuedWrites.empty() || !m_bWriterRunning; });
+            if (m_QueuedWrites.empty())
+            {
+                return;
+            }
+            Writes.swap(m_QueuedWrites);
+        }
+
+        WriteBatch(Writes);
+
+        {
+            const std::lock_guard QueueLock(m_QueueMutex);
+            m_CompletedWriteCount += Writes.size();
+        }
+        m_WritesCompleted.notify_all();
+        Writes.clear();
+    }
+}
+
+void AsyncFileWriter::WriteBatch(std::vector<QueuedWrite>& Writes)
+{
+    UNICA_PROFILE_FUNCTION
+
+    // Newest first, every file is replaced as a whole so only its last write in the batch matters
+    std::unordered_set<std::string> WrittenDestinations;
+    uint32 SupersededWriteCount = 0;
+    for (std::vector<QueuedWrite>::reverse_iterator Write = Writes.rbegin(); Write != Writes.rend(); ++Write)
+    {
+        if (!WrittenDestinations.insert(Write->FileDestination).second)
+        {
+            SupersededWriteCount++;
+            continue;
+        }
+        WriteNow(*Write);
+
+        // Release the contents as soon as they're on disk, large captures shouldn't wait for the whole batch
+        Write->FileContents = std::vector<char>();
+    }
+
+    if (SupersededWriteCount > 0)
+    {
+        UNICA_LOG_TRACE("Skipped {} superseded writes out of {}", SupersededWriteCount, Writes.size());
+    }
+}
+
+void AsyncFileWriter::WriteNow(const QueuedWrite& Write)
+{
+    const std::span<const char> FileContents = std::visit([](const auto& Contents) { return std::span<const char>(Contents); }, Write.FileContents);
+    UnicaFileUtilities::WriteFile(FileContents, Write.FileDestination);
+}
@@ -0,0 +1,55 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Writes files on a background thread, so dumping statistics, caches or captures never stalls a frame. Contents are
+ * moved in rather than copied, and every write goes through UnicaFileUtilities::WriteFile, replacing the file
+ * atomically. The writer takes all queued writes at once and skips the ones a later write to the same file supersedes
+ */
+class AsyncFileWriter
+{
+public:
+    static void Start();
+    /** Writes out everything still queued and returns to writing synchronously */
+    static void Shutdown();
+
+    /** Queue replacing the file at FileDestination with FileContents. Safe from any thread, writes synchronously while the writer isn't running */
+    static void WriteFile(std::vector<char> FileContents, std::string FileDestination);
+    static void WriteFile(std::string FileContents, std::string FileDestination);
+
+    /** Blocks until every write queued so far is on disk */
+    static void Flush();
+
+    static uint64 GetQueuedWriteCount();
+
+private:
+    struct QueuedWrite
+    {
+        std::string FileDestination;
+        std::variant<std::vector<char>, std::string> FileContents;
+    };
+
+    static void Enqueue(QueuedWrite&& Write);
+    static void WriterLoop();
+    static void WriteBatch(std::vector<QueuedWrite>& Writes);
+    static void WriteNow(const QueuedWrite& Write);
+
+    static std::thread m_WriterThread;
+    static std::mutex m_QueueMutex;
+    static std::condition_variable m_QueueWakeup;
+    static std::condition_variable m_WritesCompleted;
+    static std::vector<QueuedWrite> m_QueuedWrites;
+    static bool m_bWriterRunning;
+    static uint64 m_SubmittedWriteCount;
+    static uint64 m_CompletedWriteCount;
+};
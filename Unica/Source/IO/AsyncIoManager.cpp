@@ -0,0 +1,278 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "AsyncIoManager.h"
+
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include "UnicaFileUtilities.h"
+#include "UnicaSettings.h"
+#include "VirtualFileSystem.h"
+
+std::vector<std::thread> AsyncIoManager::m_IoThreads;
+std::mutex AsyncIoManager::m_QueueMutex;
+std::condition_variable AsyncIoManager::m_QueueWakeup;
+std::array<std::deque<std::unique_ptr<AsyncIoManager::ReadRequest>>, AsyncIoManager::PriorityCount> AsyncIoManager::m_QueuedRequests;
+std::unordered_map<std::string, AsyncIoManager::ReadRequest*> AsyncIoManager::m_QueuedRequestsByPath;
+std::unordered_map<AsyncIoRequestHandle, AsyncIoManager::ReadRequest*> AsyncIoManager::m_QueuedRequestsByHandle;
+bool AsyncIoManager::m_bShuttingDown = false;
+std::mutex AsyncIoManager::m_CompletionsMutex;
+std::vector<AsyncIoManager::ReadCompletion> AsyncIoManager::m_Completions;
+std::vector<AsyncIoManager::ReadCompletion> AsyncIoManager::m_DeliveringCompletions;
+std::unordered_map<AsyncIoRequestHandle, AsyncIoCallback> AsyncIoManager::m_Callbacks;
+std::unordered_set<AsyncIoRequestHandle> AsyncIoManager::m_CancelledHandles;
+AsyncIoRequestHandle AsyncIoManager::m_LastRequestHandle = 0;
+
+void AsyncIoManager::Init()
+{
+    m_bShuttingDown = false;
+
+    // Reads mostly wait on the disk, a couple of threads keep it busy without competing with the job workers
+    const uint32 IoThreadCount = std::max(UnicaSettings::IoThreadCount, 1u);
+    for (uint32 ThreadIndex = 0; ThreadIndex < IoThreadCount; ThreadIndex++)
+    {
+        m_IoThreads.emplace_back(&AsyncIoManager::IoThreadMain, ThreadIndex);
+    }
+
+    UNICA_LOG_DEBUG("AsyncIoManager started {} I/O threads", IoThreadCount);
+}
+
+void AsyncIoManager::Tick()
+{
+    UNICA_PROFILE_FUNCTION
+    DeliverCompletions();
+}
+
+void AsyncIoManager::Shutdown()
+{
+    {
+        const std::lock_guard QueueLock(m_QueueMutex);
+        m_bShuttingDown = true;
+    }
+    m_QueueWakeup.notify_all();
+
+    for (std::thread& IoThread : m_IoThreads)
+    {
+        IoThread.join();
+    }
+    m_IoThreads.clear();
+
+    // Whatever never completed is dropped along with its callback, futures waiting on it report a broken promise
+    if (!m_Callbacks.empty())
+    {
+        UNICA_LOG_DEBUG("Dropping {} unfinished I/O requests", m_Callbacks.size());
+    }
+    for (std::deque<std::unique_ptr<ReadRequest>>& Requests : m_QueuedRequests)
+    {
+        Requests.clear();
+    }
+    m_QueuedRequestsByPath.clear();
+    m_QueuedRequestsByHandle.clear();
+    m_Completions.clear();
+    m_Callbacks.clear();
+    m_CancelledHandles.clear();
+}
+
+AsyncIoRequestHandle AsyncIoManager::ReadFile(const std::string& FileLocation, AsyncIoCallback OnCompleted, const AsyncIoPriority Priority,
+    const FileAccessPattern AccessPattern)
+{
+    UNICA_PROFILE_FUNCTION
+    const AsyncIoRequestHandle Handle = ++m_LastRequestHandle;
+    m_Callbacks.emplace(Handle, std::move(OnCompleted));
+
+    std::filesystem::path FilePath = UnicaFileUtilities::ResolveDirectory(FileLocation);
+    std::string FilePathKey = FilePath.string();
+    {
+        const std::lock_guard QueueLock(m_QueueMutex);
+        const std::unordered_map<std::string, ReadRequest*>::iterator QueuedRequest = m_QueuedRequestsByPath.find(FilePathKey);
+        if (QueuedRequest != m_QueuedRequestsByPath.end())
+        {
+            ReadRequest* const Request = QueuedRequest->second;
+            Request->Handles.push_back(Handle);
+            m_QueuedRequestsByHandle.emplace(Handle, Request);
+
+            // The joined request is served as early as the most urgent of its readers needs it
+            if (Priority < Request->Priority)
+            {
+                std::unique_ptr<ReadRequest> PromotedRequest = RemoveQueuedRequest(Request);
+                PromotedRequest->Priority = Priority;
+                m_QueuedRequests[static_cast<uint32>(Priority)].push_back(std::move(PromotedRequest));
+            }
+            return Handle;
+        }
+
+        std::unique_ptr<ReadRequest> Request = std::make_unique<ReadRequest>();
+        Request->FileLocation = FileLocation;
+        Request->FilePath = std::move(FilePath);
+        Request->AccessPattern = AccessPattern;
+        Request->Priority = Priority;
+        Request->Handles.push_back(Handle);
+
+        m_QueuedRequestsByPath.emplace(std::move(FilePathKey), Request.get());
+        m_QueuedRequestsByHandle.emplace(Handle, Request.get());
+        m_QueuedRequests[static_cast<uint32>(Priority)].push_back(std::move(Request));
+    }
+    m_QueueWakeup.notify_one();
+
+    return Handle;
+}
+
+std::future<AsyncIoResult> AsyncIoManager::ReadFile(const std::string& FileLocation, const AsyncIoPriority Priority, const FileAccessPattern AccessPattern)
+{
+    // std::function needs a copyable callable, hence the shared promise
+    std::shared_ptr<std::promise<AsyncIoResult>> Promise = std::make_shared<std::promise<AsyncIoResult>>();
+    std::future<AsyncIoResult> Future = Promise->get_future();
+    ReadFile(FileLocation, [Promise](const AsyncIoResult& Result) { Promise->set_value(Result); }, Priority, AccessPattern);
+    return Future;
+}
+
+bool AsyncIoManager::Cancel(const AsyncIoRequestHandle Handle)
+{
+    UNICA_PROFILE_FUNCTION
+    if (!m_Callbacks.contains(Handle) || !m_CancelledHandles.insert(Handle).second)
+    {
+        return false;
+    }
+
+    bool bWasQueued = false;
+    std::string FileLocation;
+    {
+        const std::lock_guard QueueLock(m_QueueMutex);
+        const std::unordered_map<AsyncIoRequestHandle, ReadRequest*>::iterator QueuedRequest = m_QueuedRequestsByHandle.find(Handle);
+        if (QueuedRequest != m_QueuedRequestsByHandle.end())
+        {
+            ReadRequest* const Request = QueuedRequest->second;
+            m_QueuedRequestsByHandle.erase(QueuedRequest);
+            FileLocation = Request->FileLocation;
+            std::erase(Request->Handles, Handle);
+            if (Request->Handles.empty())
+            {
+                m_QueuedRequestsByPath.erase(Request->FilePath.string());
+                RemoveQueuedRequest(Request);
+            }
+            bWasQueued = true;
+        }
+    }
+
+    // Requests already being read report their cancellation once the read completes
+    if (bWasQueued)
+    {
+        ReadCompletion Completion;
+        Completion.Handles.push_back(Handle);
+        Completion.FileLocation = std::move(FileLocation);
+        Completion.Status = AsyncIoStatus::Cancelled;
+
+        const std::lock_guard CompletionsLock(m_CompletionsMutex);
+        m_Completions.push_back(std::move(Completion));
+    }
+    return true;
+}
+
+void AsyncIoManager::IoThreadMain(const uint32 ThreadIndex)
+{
+    const std::string ThreadName = fmt::format("IoWorker {}", ThreadIndex);
+    UNICA_PROFILE_THREAD(ThreadName.c_str());
+
+    while (true)
+    {
+        std::unique_ptr<ReadRequest> Request;
+        {
+            std::unique_lock QueueLock(m_QueueMutex);
+            m_QueueWakeup.wait(QueueLock, []
+            {
+                return m_bShuttingDown || std::any_of(m_QueuedRequests.begin(), m_QueuedRequests.end(),
+                    [](const std::deque<std::unique_ptr<ReadRequest>>& Requests) { return !Requests.empty(); });
+            });
+            if (m_bShuttingDown)
+            {
+                return;
+            }
+            Request = PopQueuedRequest();
+        }
+
+        UNICA_PROFILE_FUNCTION_NAMED("AsyncIoManager::Read");
+        ReadCompletion Completion;
+        Completion.Handles = std::move(Request->Handles);
+        Completion.FileLocation = std::move(Request->FileLocation);
+        Completion.Data = VirtualFileSystem::OpenFile(Request->FilePath, Request->AccessPattern);
+        Completion.Data.Prefault();
+        Completion.Status = Completion.Data.IsValid() ? AsyncIoStatus::Completed : AsyncIoStatus::Failed;
+
+        const std::lock_guard CompletionsLock(m_CompletionsMutex);
+        m_Completions.push_back(std::move(Completion));
+    }
+}
+
+std::unique_ptr<AsyncIoManager::ReadRequest> AsyncIoManager::PopQueuedRequest()
+{
+    for (std::deque<std::unique_ptr<ReadRequest>>& Requests : m_QueuedRequests)
+    {
+        if (Requests.empty())
+        {
+            continue;
+        }
+
+        std::unique_ptr<ReadRequest> Request = std::move(Requests.front());
+        Requests.pop_front();
+
+        // From here on the request is in flight, new reads of the same file queue a fresh request
+        m_QueuedRequestsByPath.erase(Request->FilePath.string());
+        for (const AsyncIoRequestHandle Handle : Request->Handles)
+        {
+            m_QueuedRequestsByHandle.erase(Handle);
+        }
+        return Request;
+    }
+    return nullptr;
+}
+
+std::unique_ptr<AsyncIoManager::ReadRequest> AsyncIoManager::RemoveQueuedRequest(const ReadRequest* Request)
+{
+    std::deque<std::unique_ptr<ReadRequest>>& Requests = m_QueuedRequests[static_cast<uint32>(Request->Priority)];
+    const std::deque<std::unique_ptr<ReadRequest>>::iterator QueuedRequest = std::find_if(Requests.begin(), Requests.end(),
+        [Request](const std::unique_ptr<ReadRequest>& Other) { return Other.get() == Request; });
+
+    std::unique_ptr<ReadRequest> RemovedRequest = std::move(*QueuedRequest);
+    Requests.erase(QueuedRequest);
+    return RemovedRequest;
+}
+
+void AsyncIoManager::DeliverCompletions()
+{
+    {
+        const std::lock_guard CompletionsLock(m_CompletionsMutex);
+        m_DeliveringCompletions.swap(m_Completions);
+    }
+
+    for (ReadCompletion& Completion : m_DeliveringCompletions)
+    {
+        for (const AsyncIoRequestHandle Handle : Completion.Handles)
+        {
+            const std::unordered_map<AsyncIoRequestHandle, AsyncIoCallback>::iterator Callback = m_Callbacks.find(Handle);
+            if (Callback == m_Callbacks.end())
+            {
+                continue;
+            }
+
+            AsyncIoResult Result;
+            Result.Handle = Handle;
+            Result.FileLocation = Completion.FileLocation;
+            if (m_CancelledHandles.erase(Handle) > 0)
+            {
+                Result.Status = AsyncIoStatus::Cancelled;
+            }
+            else
+            {
+                Result.Status = Completion.Status;
+                Result.Data = Completion.Data;
+            }
+
+            // Erased first, the callback is free to queue new requests
+            const AsyncIoCallback OnCompleted = std::move(Callback->second);
+            m_Callbacks.erase(Callback);
+            OnCompleted(Result);
+        }
+    }
+    m_DeliveringCompletions.clear();
+}
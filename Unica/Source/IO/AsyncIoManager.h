@@ -0,0 +1,135 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+#include "Subsystem/SubsystemBase.h"
+
+enum class AsyncIoPriority : uint8
+{
+    // Needed for the next frame, e.g. a streaming texture that's already visible
+    High,
+    Normal,
+    // Speculative or prefetch loads
+    Low
+};
+
+enum class AsyncIoStatus : uint8
+{
+    Completed,
+    Failed,
+    Cancelled
+};
+
+/** Identifies a request to pass to AsyncIoManager::Cancel. Zero is never a valid handle */
+using AsyncIoRequestHandle = uint64;
+
+struct AsyncIoResult
+{
+    AsyncIoRequestHandle Handle = 0;
+    AsyncIoStatus Status = AsyncIoStatus::Failed;
+    std::string FileLocation;
+    // Only valid when Status is Completed, already paged in so reading it won't block on the disk
+    UnicaMappedFile Data;
+};
+
+using AsyncIoCallback = std::function<void(const AsyncIoResult&)>;
+
+/**
+ * Reads files on a small pool of I/O threads so disk access never stalls a frame. Requests are served highest
+ * priority first, and reads of a file that's already queued join the queued request instead of reading it again.
+ * Completions are collected and delivered in one batch on the main thread when the manager ticks
+ */
+class AsyncIoManager final : public SubsystemBase
+{
+public:
+    /**
+     * Queue a read of the whole file. Main thread only
+     * @param FileLocation Unica path, resolved like UnicaFileUtilities does
+     * @param OnCompleted Called on the main thread exactly once, including when the request fails or is cancelled
+     */
+    static AsyncIoRequestHandle ReadFile(const std::string& FileLocation, AsyncIoCallback OnCompleted,
+        AsyncIoPriority Priority = AsyncIoPriority::Normal, FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+
+    /** Same as above, for callers that would rather poll. The future becomes ready on the main thread too */
+    static std::future<AsyncIoResult> ReadFile(const std::string& FileLocation, AsyncIoPriority Priority = AsyncIoPriority::Normal,
+        FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+
+    /**
+     * Requests still queued never touch the disk, the ones already being read have their data dropped.
+     * Their callback still runs, with a Cancelled status, on the next tick. Main thread only
+     * @return Whether the request was still pending
+     */
+    static bool Cancel(AsyncIoRequestHandle Handle);
+
+    static uint32 GetPendingRequestCount() { return static_cast<uint32>(m_Callbacks.size()); }
+
+private:
+    void Init() override;
+    void Tick() override;
+    void Shutdown() override;
+    bool ShouldTick() override { return true; }
+
+    // Completion callbacks run on the main thread, like the code that submitted them
+    bool RequiresMainThread() const override { return true; }
+
+    static constexpr uint32 PriorityCount = 3;
+
+    /** One read of a file on behalf of every request that asked for it while it was queued */
+    struct ReadRequest
+    {
+        std::string FileLocation;
+        std::filesystem::path FilePath;
+        FileAccessPattern AccessPattern = FileAccessPattern::Sequential;
+        AsyncIoPriority Priority = AsyncIoPriority::Normal;
+        std::vector<AsyncIoRequestHandle> Handles;
+    };
+
+    struct ReadCompletion
+    {
+        std::vector<AsyncIoRequestHandle> Handles;
+        std::string FileLocation;
+        AsyncIoStatus Status = AsyncIoStatus::Failed;
+        UnicaMappedFile Data;
+    };
+
+    static void IoThreadMain(uint32 ThreadIndex);
+    /** Callers hold m_QueueMutex */
+    static std::unique_ptr<ReadRequest> PopQueuedRequest();
+    /** Callers hold m_QueueMutex */
+    static std::unique_ptr<ReadRequest> RemoveQueuedRequest(const ReadRequest* Request);
+    static void DeliverCompletions();
+
+    static std::vector<std::thread> m_IoThreads;
+
+    static std::mutex m_QueueMutex;
+    static std::condition_variable m_QueueWakeup;
+    static std::array<std::deque<std::unique_ptr<ReadRequest>>, PriorityCount> m_QueuedRequests;
+    // Requests that haven't been picked up by an I/O thread yet, which new reads of the same file can still join
+    static std::unordered_map<std::string, ReadRequest*> m_QueuedRequestsByPath;
+    static std::unordered_map<AsyncIoRequestHandle, ReadRequest*> m_QueuedRequestsByHandle;
+    static bool m_bShuttingDown;
+
+    static std::mutex m_CompletionsMutex;
+    static std::vector<ReadCompletion> m_Completions;
+    static std::vector<ReadCompletion> m_DeliveringCompletions;
+
+    // Main thread only
+    static std::unordered_map<AsyncIoRequestHandle, AsyncIoCallback> m_Callbacks;
+    static std::unordered_set<AsyncIoRequestHandle> m_CancelledHandles;
+    static AsyncIoRequestHandle m_LastRequestHandle;
+};
@@ -0,0 +1,226 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr size_t MinMatchSize = 4;
+    // The format requires the last 5 bytes to be literals, and the last match to start at least 12 bytes from the end
+    constexpr size_t LastLiteralsSize = 5;
+    constexpr size_t MatchSearchMargin = 12;
+    constexpr size_t MaxMatchOffset = 65535;
+    constexpr uint32_t HashBits = 12;
+
+    uint32_t ReadUInt32(const char* Source)
+    {
+        uint32_t Value;
+        std::memcpy(&Value, Source, sizeof(Value));
+        return Value;
+    }
+
+    uint32_t HashSequence(const uint32_t Sequence)
+    {
+        return (Sequence * 2654435761u) >> (32 - HashBits);
+    }
+
+    /** Lengths of 15 and up spill into extra bytes of 255 each, ended by a byte below 255 */
+    bool WriteLengthExtension(size_t Length, char*& Output, const char* OutputEnd)
+    {
+        while (Length >= 255)
+        {
+            if (Output >= OutputEnd)
+            {
+                return false;
+            }
+            *Output++ = static_cast<char>(255);
+            Length -= 255;
+        }
+
+        if (Output >= OutputEnd)
+        {
+            return false;
+        }
+        *Output++ = static_cast<char>(Length);
+        return true;
+    }
+
+    bool ReadLengthExtension(size_t& Length, const char*& Input, const char* InputEnd)
+    {
+        uint8_t LengthByte;
+        do
+        {
+            if (Input >= InputEnd)
+            {
+                return false;
+            }
+            LengthByte = static_cast<uint8_t>(*Input++);
+            Length += LengthByte;
+        }
+        while (LengthByte == 255);
+        return true;
+    }
+
+    bool WriteSequence(const char* Literals, const size_t LiteralsSize, const size_t MatchOffset, const size_t MatchSize, char*& Output, const char* OutputEnd)
+    {
+        if (Output >= OutputEnd)
+        {
+            return false;
+        }
+
+        // A zero sized match marks the last sequence, which only carries literals
+        const size_t MatchSizeCode = MatchSize > 0 ? MatchSize - MinMatchSize : 0;
+        char* const Token = Output++;
+        *Token = static_cast<char>((std::min<size_t>(LiteralsSize, 15) << 4) | std::min<size_t>(MatchSizeCode, 15));
+        if (LiteralsSize >= 15 && !WriteLengthExtension(LiteralsSize - 15, Output, OutputEnd))
+        {
+            return false;
+        }
+
+        if (static_cast<size_t>(OutputEnd - Output) < LiteralsSize)
+        {
+            return false;
+        }
+        std::memcpy(Output, Literals, LiteralsSize);
+        Output += LiteralsSize;
+
+        if (MatchSize == 0)
+        {
+            return true;
+        }
+
+        if (OutputEnd - Output < 2)
+        {
+            return false;
+        }
+        *Output++ = static_cast<char>(MatchOffset & 0xFF);
+        *Output++ = static_cast<char>(MatchOffset >> 8);
+        return MatchSizeCode < 15 || WriteLengthExtension(MatchSizeCode - 15, Output, OutputEnd);
+    }
+}
+
+size_t BlockCompression::GetMaxCompressedSize(const size_t Size)
+{
+    return Size + Size / 255 + 16;
+}
+
+size_t BlockCompression::Compress(const char* Source, const size_t SourceSize, char* Destination, const size_t DestinationCapacity)
+{
+    if (SourceSize == 0)
+    {
+        return 0;
+    }
+
+    char* Output = Destination;
+    const char* const OutputEnd = Destination + DestinationCapacity;
+
+    // Positions are stored plus one so zero can mean empty
+    std::vector<uint32_t> HashTable(1u << HashBits, 0);
+    size_t LiteralsStart = 0;
+    size_t Position = 0;
+    const size_t MatchSearchEnd = SourceSize > MatchSearchMargin ? SourceSize - MatchSearchMargin : 0;
+    while (Position < MatchSearchEnd)
+    {
+        const uint32_t Sequence = ReadUInt32(Source + Position);
+        uint32_t& HashEntry = HashTable[HashSequence(Sequence)];
+        const size_t Candidate = HashEntry;
+        HashEntry = static_cast<uint32_t>(Position + 1);
+
+        if (Candidate == 0 || Position - (Candidate - 1) > MaxMatchOffset || ReadUInt32(Source + Candidate - 1) != Sequence)
+        {
+            Position++;
+            continue;
+        }
+
+        const size_t MatchStart = Candidate - 1;
+        size_t MatchSize = MinMatchSize;
+        while (Position + MatchSize < SourceSize - LastLiteralsSize && Source[MatchStart + MatchSize] == Source[Position + MatchSize])
+        {
+            MatchSize++;
+        }
+
+        if (!WriteSequence(Source + LiteralsStart, Position - LiteralsStart, Position - MatchStart, MatchSize, Output, OutputEnd))
+        {
+            return 0;
+        }
+        Position += MatchSize;
+        LiteralsStart = Position;
+    }
+
+    if (!WriteSequence(Source + LiteralsStart, SourceSize - LiteralsStart, 0, 0, Output, OutputEnd))
+    {
+        return 0;
+    }
+    return static_cast<size_t>(Output - Destination);
+}
+
+bool BlockCompression::Decompress(const char* Source, const size_t SourceSize, char* Destination, const size_t DestinationSize)
+{
+    if (SourceSize == 0)
+    {
+        return DestinationSize == 0;
+    }
+
+    const char* Input = Source;
+    const char* const InputEnd = Source + SourceSize;
+    char* Output = Destination;
+    char* const OutputEnd = Destination + DestinationSize;
+
+    while (Input < InputEnd)
+    {
+        const uint8_t Token = static_cast<uint8_t>(*Input++);
+
+        size_t LiteralsSize = Token >> 4;
+        if (LiteralsSize == 15 && !ReadLengthExtension(LiteralsSize, Input, InputEnd))
+        {
+            return false;
+        }
+        if (static_cast<size_t>(InputEnd - Input) < LiteralsSize || static_cast<size_t>(OutputEnd - Output) < LiteralsSize)
+        {
+            return false;
+        }
+        std::memcpy(Output, Input, LiteralsSize);
+        Input += LiteralsSize;
+        Output += LiteralsSize;
+
+        if (Input == InputEnd)
+        {
+            break;
+        }
+
+        if (InputEnd - Input < 2)
+        {
+            return false;
+        }
+        const size_t MatchOffset = static_cast<uint8_t>(Input[0]) | static_cast<size_t>(static_cast<uint8_t>(Input[1])) << 8;
+        Input += 2;
+        if (MatchOffset == 0 || MatchOffset > static_cast<size_t>(Output - Destination))
+        {
+            return false;
+        }
+
+        size_t MatchSize = Token & 15;
+        if (MatchSize == 15 && !ReadLengthExtension(MatchSize, Input, InputEnd))
+        {
+            return false;
+        }
+        MatchSize += MinMatchSize;
+        if (static_cast<size_t>(OutputEnd - Output) < MatchSize)
+        {
+            return false;
+        }
+
+        // Matches may overlap the bytes they produce, which is how runs are encoded, so copy one byte at a time
+        const char* Match = Output - MatchOffset;
+        for (size_t ByteIndex = 0; ByteIndex < MatchSize; ByteIndex++)
+        {
+            *Output++ = *Match++;
+        }
+    }
+
+    return Output == OutputEnd;
+}
@@ -0,0 +1,21 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Minimal codec for the LZ4 block format, used for the blocks of packed archives. Compression is a single greedy
+ * pass that favors speed over ratio, decompression is bounds checked so a corrupt archive fails instead of crashing
+ */
+namespace BlockCompression
+{
+    /** Worst case compressed size of Size bytes, for sizing the destination of Compress */
+    size_t GetMaxCompressedSize(size_t Size);
+
+    /** @return Compressed size, zero when it doesn't fit in DestinationCapacity or there's nothing to compress */
+    size_t Compress(const char* Source, size_t SourceSize, char* Destination, size_t DestinationCapacity);
+
+    /** @return Whether Source decompressed into exactly DestinationSize bytes */
+    bool Decompress(const char* Source, size_t SourceSize, char* Destination, size_t DestinationSize);
+}
@@ -0,0 +1,467 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "UnicaFileUtilities.h"
+#include "UnicaSettings.h"
+
+int32 FileWatcher::m_InotifyDescriptor = -1;
+std::vector<std::string> FileWatcher::m_RootDirectories;
+std::unordered_map<int32, std::string> FileWatcher::m_WatchedDirectories;
+std::unordered_map<std::string, int32> FileWatcher::m_WatchDescriptors;
+std::shared_mutex FileWatcher::m_IndexMutex;
+std::unordered_set<std::string> FileWatcher::m_IndexedRoots;
+std::map<std::string, FileWatcher::IndexedDirectory> FileWatcher::m_Index;
+std::vector<FileChangeEvent> FileWatcher::m_PendingChanges;
+std::unordered_map<std::string, size_t> FileWatcher::m_PendingChangeIndices;
+std::vector<FileWatcher::FileWatchSubscription> FileWatcher::m_Subscriptions;
+std::vector<FileWatcher::FileWatchSubscription> FileWatcher::m_PendingSubscriptions;
+FileWatchHandle FileWatcher::m_LastSubscriptionHandle = 0;
+bool FileWatcher::m_bIsDispatching = false;
+
+void FileWatcher::Init()
+{
+    UNICA_PROFILE_FUNCTION
+    if (!UnicaSettings::bWatchFiles)
+    {
+        return;
+    }
+
+#if defined(__linux__)
+    m_InotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_InotifyDescriptor < 0)
+    {
+        UNICA_LOG_WARN("Can't start watching files, inotify failed with error {}", errno);
+        return;
+    }
+
+    WatchRoot(UnicaFileUtilities::ResolveDirectory("Engine:"));
+    WatchRoot(UnicaFileUtilities::ResolveDirectory("Game:"));
+#else
+    UNICA_LOG_DEBUG("File watching is only implemented with inotify, files will be found by scanning instead");
+#endif
+}
+
+void FileWatcher::Tick()
+{
+    UNICA_PROFILE_FUNCTION
+    ReadEvents();
+    DispatchChanges();
+}
+
+void FileWatcher::Shutdown()
+{
+#if defined(__linux__)
+    if (m_InotifyDescriptor >= 0)
+    {
+        // Closing the descriptor drops every watch along with it
+        close(m_InotifyDescriptor);
+        m_InotifyDescriptor = -1;
+    }
+#endif
+
+    m_RootDirectories.clear();
+    m_WatchedDirectories.clear();
+    m_WatchDescriptors.clear();
+    m_PendingChanges.clear();
+    m_PendingChangeIndices.clear();
+    m_Subscriptions.clear();
+    m_PendingSubscriptions.clear();
+
+    const std::unique_lock IndexLock(m_IndexMutex);
+    m_IndexedRoots.clear();
+    m_Index.clear();
+}
+
+FileWatchHandle FileWatcher::Subscribe(const std::filesystem::path& Directory, FileChangeCallback Callback)
+{
+    FileWatchSubscription Subscription;
+    Subscription.Handle = ++m_LastSubscriptionHandle;
+    Subscription.Directory = GetDirectoryKey(Directory);
+    Subscription.Callback = std::move(Callback);
+    const FileWatchHandle Handle = Subscription.Handle;
+
+    // Adding to the list that's being iterated could move the callback that's running
+    if (m_bIsDispatching)
+    {
+        m_PendingSubscriptions.push_back(std::move(Subscription));
+    }
+    else
+    {
+        m_Subscriptions.push_back(std::move(Subscription));
+    }
+    return Handle;
+}
+
+void FileWatcher::Unsubscribe(const FileWatchHandle Handle)
+{
+    std::erase_if(m_PendingSubscriptions, [Handle](const FileWatchSubscription& Subscription) { return Subscription.Handle == Handle; });
+    for (FileWatchSubscription& Subscription : m_Subscriptions)
+    {
+        if (Subscription.Handle == Handle)
+        {
+            // Only cleared while dispatching, the callback might be the one unsubscribing itself
+            Subscription.Handle = 0;
+        }
+    }
+
+    if (!m_bIsDispatching)
+    {
+        std::erase_if(m_Subscriptions, [](const FileWatchSubscription& Subscription) { return Subscription.Handle == 0; });
+    }
+}
+
+bool FileWatcher::FindFiles(const std::filesystem::path& Directory, const std::vector<std::string>& FileExtensions, std::vector<std::filesystem::path>& OutFiles)
+{
+    UNICA_PROFILE_FUNCTION
+    const std::string DirectoryKey = GetDirectoryKey(Directory);
+    const std::shared_lock IndexLock(m_IndexMutex);
+    if (std::none_of(m_IndexedRoots.begin(), m_IndexedRoots.end(), [&DirectoryKey](const std::string& Root) { return IsInDirectory(DirectoryKey, Root); }))
+    {
+        return false;
+    }
+
+    for (std::map<std::string, IndexedDirectory>::const_iterator Entry = m_Index.lower_bound(DirectoryKey);
+        Entry != m_Index.end() && Entry->first.starts_with(DirectoryKey); ++Entry)
+    {
+        if (!IsInDirectory(Entry->first, DirectoryKey))
+        {
+            continue;
+        }
+
+        for (const std::string& FileExtension : FileExtensions)
+        {
+            const std::unordered_map<std::string, std::unordered_set<std::string>>::const_iterator FileNames = Entry->second.FileNamesByExtension.find(FileExtension);
+            if (FileNames == Entry->second.FileNamesByExtension.end())
+            {
+                continue;
+            }
+
+            for (const std::string& FileName : FileNames->second)
+            {
+                OutFiles.push_back(std::filesystem::path(Entry->first + '/' + FileName).make_preferred());
+            }
+        }
+    }
+    return true;
+}
+
+std::string FileWatcher::GetDirectoryKey(const std::filesystem::path& Directory)
+{
+    std::string DirectoryKey = Directory.lexically_normal().generic_string();
+    if (DirectoryKey.size() > 1 && DirectoryKey.back() == '/')
+    {
+        DirectoryKey.pop_back();
+    }
+    return DirectoryKey;
+}
+
+bool FileWatcher::IsInDirectory(const std::string& Path, const std::string& Directory)
+{
+    return Path.starts_with(Directory) && (Path.size() == Directory.size() || Path[Directory.size()] == '/');
+}
+
+void FileWatcher::WatchRoot(const std::filesystem::path& RootDirectory)
+{
+    const std::string RootKey = GetDirectoryKey(RootDirectory);
+    if (!std::filesystem::is_directory(RootDirectory))
+    {
+        return;
+    }
+
+    m_RootDirectories.push_back(RootKey);
+    if (!WatchDirectoryTree(RootKey, false))
+    {
+        // A partial index would hide files, scanning is slower but complete
+        UNICA_LOG_WARN("Ran out of inotify watches indexing '{}', its files will be found by scanning. Raise fs.inotify.max_user_watches to fix it", RootKey);
+        UnwatchDirectoryTree(RootKey, false);
+        return;
+    }
+
+    const std::unique_lock IndexLock(m_IndexMutex);
+    m_IndexedRoots.insert(RootKey);
+    UNICA_LOG_DEBUG("Watching '{}' and its {} directories", RootKey, m_Index.size());
+}
+
+bool FileWatcher::WatchDirectoryTree(const std::string& Directory, const bool bPublishAddedFiles)
+{
+#if defined(__linux__)
+    // The watch goes in before the directory is listed, so a file created in between shows up at least once
+    constexpr uint32 WatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR;
+    const int32 WatchDescriptor = inotify_add_watch(m_InotifyDescriptor, Directory.c_str(), WatchMask);
+    if (WatchDescriptor < 0)
+    {
+        // Directories removed before they could be watched are fine, running out of watches isn't
+        return errno != ENOSPC;
+    }
+    m_WatchedDirectories[WatchDescriptor] = Directory;
+    m_WatchDescriptors[Directory] = WatchDescriptor;
+
+    {
+        const std::unique_lock IndexLock(m_IndexMutex);
+        m_Index.try_emplace(Directory);
+    }
+
+    std::error_code Error;
+    for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(Directory, Error))
+    {
+        const std::string FileName = Entry.path().filename().string();
+        if (Entry.is_directory(Error) && !Entry.is_symlink(Error))
+        {
+            if (!WatchDirectoryTree(Directory + '/' + FileName, bPublishAddedFiles))
+            {
+                return false;
+            }
+        }
+        else if (Entry.is_regular_file(Error))
+        {
+            IndexFile(Directory, FileName);
+            if (bPublishAddedFiles)
+            {
+                QueueChange(FileChangeType::Added, Directory + '/' + FileName);
+            }
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void FileWatcher::UnwatchDirectoryTree(const std::string& Directory, const bool bPublishRemovedFiles)
+{
+    for (std::unordered_map<std::string, int32>::iterator Watch = m_WatchDescriptors.begin(); Watch != m_WatchDescriptors.end();)
+    {
+        if (!IsInDirectory(Watch->first, Directory))
+        {
+            ++Watch;
+            continue;
+        }
+
+#if defined(__linux__)
+        inotify_rm_watch(m_InotifyDescriptor, Watch->second);
+#endif
+        m_WatchedDirectories.erase(Watch->second);
+        Watch = m_WatchDescriptors.erase(Watch);
+    }
+
+    const std::unique_lock IndexLock(m_IndexMutex);
+    for (std::map<std::string, IndexedDirectory>::iterator Entry = m_Index.lower_bound(Directory); Entry != m_Index.end() && Entry->first.starts_with(Directory);)
+    {
+        if (!IsInDirectory(Entry->first, Directory))
+        {
+            ++Entry;
+            continue;
+        }
+
+        // Files of a directory that was moved away never get events of their own
+        if (bPublishRemovedFiles)
+        {
+            for (const std::pair<const std::string, std::unordered_set<std::string>>& FileNames : Entry->second.FileNamesByExtension)
+            {
+                for (const std::string& FileName : FileNames.second)
+                {
+                    QueueChange(FileChangeType::Removed, Entry->first + '/' + FileName);
+                }
+            }
+        }
+        Entry = m_Index.erase(Entry);
+    }
+}
+
+void FileWatcher::RebuildIndex()
+{
+    UNICA_PROFILE_FUNCTION
+    const std::vector<std::string> RootDirectories = std::move(m_RootDirectories);
+    m_RootDirectories.clear();
+    for (const std::string& RootDirectory : RootDirectories)
+    {
+        UnwatchDirectoryTree(RootDirectory, false);
+        {
+            const std::unique_lock IndexLock(m_IndexMutex);
+            m_IndexedRoots.erase(RootDirectory);
+        }
+        WatchRoot(RootDirectory);
+    }
+}
+
+void FileWatcher::ReadEvents()
+{
+#if defined(__linux__)
+    alignas(inotify_event) std::array<char, 16 * 1024> EventBuffer;
+    while (true)
+    {
+        const ssize_t ReadSize = read(m_InotifyDescriptor, EventBuffer.data(), EventBuffer.size());
+        if (ReadSize <= 0)
+        {
+            break;
+        }
+
+        for (ssize_t EventOffset = 0; EventOffset < ReadSize;)
+        {
+            const inotify_event* Event = reinterpret_cast<const inotify_event*>(EventBuffer.data() + EventOffset);
+            HandleEvent(Event->wd, Event->mask, Event->len > 0 ? std::string(Event->name) : std::string());
+            EventOffset += static_cast<ssize_t>(sizeof(inotify_event) + Event->len);
+        }
+    }
+#endif
+}
+
+void FileWatcher::HandleEvent(const int32 WatchDescriptor, const uint32 Mask, const std::string& Name)
+{
+#if defined(__linux__)
+    if (Mask & IN_Q_OVERFLOW)
+    {
+        UNICA_LOG_WARN("File watcher fell behind and lost changes, rebuilding its index");
+        RebuildIndex();
+        return;
+    }
+
+    const std::unordered_map<int32, std::string>::const_iterator WatchedDirectory = m_WatchedDirectories.find(WatchDescriptor);
+    if (WatchedDirectory == m_WatchedDirectories.end())
+    {
+        // Leftovers of a directory that has already been unwatched
+        return;
+    }
+
+    // The kernel dropped the watch because the directory itself is gone, its parent reports that
+    if (Mask & IN_IGNORED)
+    {
+        m_WatchDescriptors.erase(WatchedDirectory->second);
+        m_WatchedDirectories.erase(WatchedDirectory);
+        return;
+    }
+
+    const std::string Directory = WatchedDirectory->second;
+    const std::string FilePath = Directory + '/' + Name;
+    if (Mask & IN_ISDIR)
+    {
+        if (Mask & (IN_DELETE | IN_MOVED_FROM))
+        {
+            UnwatchDirectoryTree(FilePath, true);
+        }
+        else if ((Mask & (IN_CREATE | IN_MOVED_TO)) && !WatchDirectoryTree(FilePath, true))
+        {
+            UNICA_LOG_WARN("Ran out of inotify watches, files will be found by scanning from now on");
+            const std::unique_lock IndexLock(m_IndexMutex);
+            m_IndexedRoots.clear();
+        }
+        return;
+    }
+
+    if (Mask & (IN_CREATE | IN_MOVED_TO))
+    {
+        // A temporary renamed over a file that's already indexed replaces it, which only reports IN_MOVED_TO
+        const bool bWasIndexed = !IndexFile(Directory, Name);
+        QueueChange(bWasIndexed ? FileChangeType::Modified : FileChangeType::Added, FilePath);
+    }
+    else if (Mask & (IN_DELETE | IN_MOVED_FROM))
+    {
+        UnindexFile(Directory, Name);
+        QueueChange(FileChangeType::Removed, FilePath);
+    }
+    else if (Mask & IN_CLOSE_WRITE)
+    {
+        QueueChange(FileChangeType::Modified, FilePath);
+    }
+#endif
+}
+
+bool FileWatcher::IndexFile(const std::string& Directory, const std::string& FileName)
+{
+    const std::string FileExtension = std::filesystem::path(FileName).extension().string();
+    const std::unique_lock IndexLock(m_IndexMutex);
+    return m_Index[Directory].FileNamesByExtension[FileExtension].insert(FileName).second;
+}
+
+void FileWatcher::UnindexFile(const std::string& Directory, const std::string& FileName)
+{
+    const std::string FileExtension = std::filesystem::path(FileName).extension().string();
+    const std::unique_lock IndexLock(m_IndexMutex);
+    const std::map<std::string, IndexedDirectory>::iterator Entry = m_Index.find(Directory);
+    if (Entry == m_Index.end())
+    {
+        return;
+    }
+
+    const std::unordered_map<std::string, std::unordered_set<std::string>>::iterator FileNames = Entry->second.FileNamesByExtension.find(FileExtension);
+    if (FileNames != Entry->second.FileNamesByExtension.end())
+    {
+        FileNames->second.erase(FileName);
+    }
+}
+
+void FileWatcher::QueueChange(const FileChangeType Type, const std::string& FilePath)
+{
+    const std::unordered_map<std::string, size_t>::const_iterator PendingChangeIndex = m_PendingChangeIndices.find(FilePath);
+    if (PendingChangeIndex == m_PendingChangeIndices.end())
+    {
+        m_PendingChangeIndices.emplace(FilePath, m_PendingChanges.size());
+        m_PendingChanges.push_back({ Type, std::filesystem::path(FilePath).make_preferred() });
+        return;
+    }
+
+    // Editors tend to write a file several times, or delete and recreate it, subscribers only care about how the file
+    // ended the tick compared to how it started
+    const size_t PendingIndex = PendingChangeIndex->second;
+    FileChangeType& PendingType = m_PendingChanges[PendingIndex].Type;
+    if (PendingType == FileChangeType::Added && Type == FileChangeType::Modified)
+    {
+        return;
+    }
+
+    // A file created and gone within the same tick was never seen by any subscriber
+    if (PendingType == FileChangeType::Added && Type == FileChangeType::Removed)
+    {
+        m_PendingChanges.erase(m_PendingChanges.begin() + PendingIndex);
+        m_PendingChangeIndices.erase(PendingChangeIndex);
+        for (std::unordered_map<std::string, size_t>::iterator OtherChangeIndex = m_PendingChangeIndices.begin(); OtherChangeIndex != m_PendingChangeIndices.end(); ++OtherChangeIndex)
+        {
+            OtherChangeIndex->second -= OtherChangeIndex->second > PendingIndex ? 1 : 0;
+        }
+        return;
+    }
+    PendingType = PendingType == FileChangeType::Removed && Type == FileChangeType::Added ? FileChangeType::Modified : Type;
+}
+
+void FileWatcher::DispatchChanges()
+{
+    UNICA_PROFILE_FUNCTION
+    if (m_PendingChanges.empty())
+    {
+        return;
+    }
+
+    m_bIsDispatching = true;
+    for (const FileChangeEvent& Change : m_PendingChanges)
+    {
+        const std::string FilePath = Change.FilePath.generic_string();
+        for (const FileWatchSubscription& Subscription : m_Subscriptions)
+        {
+            if (Subscription.Handle != 0 && IsInDirectory(FilePath, Subscription.Directory))
+            {
+                Subscription.Callback(Change);
+            }
+        }
+    }
+    m_bIsDispatching = false;
+
+    m_PendingChanges.clear();
+    m_PendingChangeIndices.clear();
+    std::erase_if(m_Subscriptions, [](const FileWatchSubscription& Subscription) { return Subscription.Handle == 0; });
+    for (FileWatchSubscription& PendingSubscription : m_PendingSubscriptions)
+    {
+        m_Subscriptions.push_back(std::move(PendingSubscription));
+    }
+    m_PendingSubscriptions.clear();
+}
@@ -0,0 +1,111 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "UnicaMinimal.h"
+#include "Subsystem/SubsystemBase.h"
+
+enum class FileChangeType : uint8
+{
+    Added,
+    Modified,
+    Removed
+};
+
+struct FileChangeEvent
+{
+    FileChangeType Type = FileChangeType::Modified;
+    std::filesystem::path FilePath;
+};
+
+using FileChangeCallback = std::function<void(const FileChangeEvent&)>;
+
+/** Identifies a subscription to pass to FileWatcher::Unsubscribe. Zero is never a valid handle */
+using FileWatchHandle = uint64;
+
+/**
+ * Keeps an index of every file under the Engine: and Game: directories by directory and extension, built with a
+ * single scan on startup and kept up to date from inotify events, so finding files never walks the disk again.
+ * Changes are read when the watcher ticks, merged per file and published to the subscribers of their directory.
+ * Only implemented with inotify, elsewhere nothing is indexed and FindFiles always asks for a scan
+ */
+class FileWatcher final : public SubsystemBase
+{
+public:
+    /** Main thread only. Subscribing from within a callback takes effect from the next tick on */
+    static FileWatchHandle Subscribe(const std::filesystem::path& Directory, FileChangeCallback Callback);
+    static void Unsubscribe(FileWatchHandle Handle);
+
+    /**
+     * Append the indexed files anywhere under Directory with one of FileExtensions to OutFiles. Safe from any thread
+     * @return Whether Directory is indexed at all, when it isn't the caller has to scan it instead
+     */
+    static bool FindFiles(const std::filesystem::path& Directory, const std::vector<std::string>& FileExtensions, std::vector<std::filesystem::path>& OutFiles);
+
+private:
+    void Init() override;
+    void Tick() override;
+    void Shutdown() override;
+    bool ShouldTick() override { return m_InotifyDescriptor >= 0; }
+
+    // Callbacks run on the main thread, like the code that subscribed them
+    bool RequiresMainThread() const override { return true; }
+
+    struct IndexedDirectory
+    {
+        std::unordered_map<std::string, std::unordered_set<std::string>> FileNamesByExtension;
+    };
+
+    struct FileWatchSubscription
+    {
+        FileWatchHandle Handle = 0;
+        std::string Directory;
+        FileChangeCallback Callback;
+    };
+
+    /** Generic, normalized and without a trailing slash, the form every directory is keyed by */
+    static std::string GetDirectoryKey(const std::filesystem::path& Directory);
+    static bool IsInDirectory(const std::string& Path, const std::string& Directory);
+
+    static void WatchRoot(const std::filesystem::path& RootDirectory);
+    /** Watches and indexes Directory and everything under it. @return False when the watch limit was hit */
+    static bool WatchDirectoryTree(const std::string& Directory, bool bPublishAddedFiles);
+    static void UnwatchDirectoryTree(const std::string& Directory, bool bPublishRemovedFiles);
+    static void RebuildIndex();
+
+    static void ReadEvents();
+    static void HandleEvent(int32 WatchDescriptor, uint32 Mask, const std::string& Name);
+    /** @return False when the file was already indexed */
+    static bool IndexFile(const std::string& Directory, const std::string& FileName);
+    static void UnindexFile(const std::string& Directory, const std::string& FileName);
+    static void QueueChange(FileChangeType Type, const std::string& FilePath);
+    static void DispatchChanges();
+
+    static int32 m_InotifyDescriptor;
+    static std::vector<std::string> m_RootDirectories;
+    static std::unordered_map<int32, std::string> m_WatchedDirectories;
+    static std::unordered_map<std::string, int32> m_WatchDescriptors;
+
+    // Written on the main thread only, read from anywhere
+    static std::shared_mutex m_IndexMutex;
+    static std::unordered_set<std::string> m_IndexedRoots;
+    // Ordered, so every directory under another is in the range of keys starting with its path
+    static std::map<std::string, IndexedDirectory> m_Index;
+
+    static std::vector<FileChangeEvent> m_PendingChanges;
+    static std::unordered_map<std::string, size_t> m_PendingChangeIndices;
+
+    static std::vector<FileWatchSubscription> m_Subscriptions;
+    static std::vector<FileWatchSubscription> m_PendingSubscriptions;
+    static FileWatchHandle m_LastSubscriptionHandle;
+    static bool m_bIsDispatching;
+};
@@ -0,0 +1,157 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "PackedArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "BlockCompression.h"
+
+namespace
+{
+    bool IsRangeInFile(const uint64_t Offset, const uint64_t Size, const size_t FileSize)
+    {
+        return Offset <= FileSize && Size <= FileSize - Offset;
+    }
+}
+
+std::unique_ptr<PackedArchive> PackedArchive::Open(const std::filesystem::path& ArchivePath)
+{
+    UNICA_PROFILE_FUNCTION
+    // Lookups jump around the index and only touch the files that are read
+    UnicaMappedFile ArchiveFile = UnicaMappedFile::Open(ArchivePath, FileAccessPattern::Random);
+    if (!ArchiveFile.IsValid())
+    {
+        return nullptr;
+    }
+
+    PackedArchiveFormat::FileHeader Header;
+    if (ArchiveFile.GetSize() < sizeof(Header))
+    {
+        UNICA_LOG(spdlog::level::err, "'{}' is too small to be a packed archive", ArchivePath.string());
+        return nullptr;
+    }
+    std::memcpy(&Header, ArchiveFile.GetData(), sizeof(Header));
+
+    if (Header.Magic != PackedArchiveFormat::Magic || Header.Version != PackedArchiveFormat::Version)
+    {
+        UNICA_LOG(spdlog::level::err, "'{}' isn't a version {} packed archive", ArchivePath.string(), PackedArchiveFormat::Version);
+        return nullptr;
+    }
+
+    // The index and block table are read in place, so they must be in bounds and aligned for their types
+    const size_t FileSize = ArchiveFile.GetSize();
+    const uint64_t IndexSize = static_cast<uint64_t>(Header.EntryCount) * sizeof(PackedArchiveFormat::Entry);
+    const uint64_t BlockTableSize = static_cast<uint64_t>(Header.BlockCount) * sizeof(uint32_t);
+    if (!IsRangeInFile(Header.IndexOffset, IndexSize, FileSize) || Header.IndexOffset % alignof(PackedArchiveFormat::Entry) != 0
+        || !IsRangeInFile(Header.BlockTableOffset, BlockTableSize, FileSize) || Header.BlockTableOffset % alignof(uint32_t) != 0
+        || !IsRangeInFile(Header.PathsOffset, Header.PathsSize, FileSize) || Header.BlockSize == 0)
+    {
+        UNICA_LOG(spdlog::level::err, "Packed archive '{}' is corrupt", ArchivePath.string());
+        return nullptr;
+    }
+
+    std::unique_ptr<PackedArchive> Archive(new PackedArchive());
+    Archive->m_ArchivePath = ArchivePath;
+    Archive->m_BlockSize = Header.BlockSize;
+    Archive->m_Entries = { reinterpret_cast<const PackedArchiveFormat::Entry*>(ArchiveFile.GetData() + Header.IndexOffset), Header.EntryCount };
+    Archive->m_BlockSizes = { reinterpret_cast<const uint32_t*>(ArchiveFile.GetData() + Header.BlockTableOffset), Header.BlockCount };
+    Archive->m_Paths = ArchiveFile.GetStringView().substr(Header.PathsOffset, Header.PathsSize);
+    Archive->m_ArchiveFile = std::move(ArchiveFile);
+
+    for (const PackedArchiveFormat::Entry& Entry : Archive->m_Entries)
+    {
+        const bool bIsCompressed = Entry.Flags & PackedArchiveFormat::EntryFlagCompressed;
+        const uint64_t BlockCount = (Entry.Size + Header.BlockSize - 1) / Header.BlockSize;
+        if (!IsRangeInFile(Entry.DataOffset, Entry.StoredSize, FileSize) || !IsRangeInFile(Entry.PathOffset, Entry.PathSize, Header.PathsSize)
+            || (!bIsCompressed && Entry.StoredSize != Entry.Size) || (bIsCompressed && !IsRangeInFile(Entry.FirstBlock, BlockCount, Header.BlockCount)))
+        {
+            UNICA_LOG(spdlog::level::err, "Packed archive '{}' is corrupt", ArchivePath.string());
+            return nullptr;
+        }
+    }
+
+    UNICA_LOG_DEBUG("Opened packed archive '{}' with {} files", ArchivePath.string(), Header.EntryCount);
+    return Archive;
+}
+
+UnicaMappedFile PackedArchive::ReadFile(const std::string_view RelativePath) const
+{
+    UNICA_PROFILE_FUNCTION
+    const PackedArchiveFormat::Entry* Entry = FindEntry(RelativePath);
+    if (Entry == nullptr)
+    {
+        return { };
+    }
+
+    if (Entry->Flags & PackedArchiveFormat::EntryFlagCompressed)
+    {
+        return ReadCompressedEntry(*Entry);
+    }
+    return m_ArchiveFile.Slice(Entry->DataOffset, Entry->Size);
+}
+
+void PackedArchive::ForEachFile(const std::function<void(std::string_view RelativePath)>& Callback) const
+{
+    for (const PackedArchiveFormat::Entry& Entry : m_Entries)
+    {
+        Callback(GetEntryPath(Entry));
+    }
+}
+
+const PackedArchiveFormat::Entry* PackedArchive::FindEntry(const std::string_view RelativePath) const
+{
+    const uint64_t PathHash = PackedArchiveFormat::HashPath(RelativePath);
+    const std::span<const PackedArchiveFormat::Entry>::iterator FirstEntry = std::lower_bound(m_Entries.begin(), m_Entries.end(), PathHash,
+        [](const PackedArchiveFormat::Entry& Entry, const uint64_t Hash) { return Entry.PathHash < Hash; });
+
+    // Colliding hashes sit next to each other, the path tells them apart
+    for (std::span<const PackedArchiveFormat::Entry>::iterator Entry = FirstEntry; Entry != m_Entries.end() && Entry->PathHash == PathHash; ++Entry)
+    {
+        if (GetEntryPath(*Entry) == RelativePath)
+        {
+            return &*Entry;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view PackedArchive::GetEntryPath(const PackedArchiveFormat::Entry& Entry) const
+{
+    return m_Paths.substr(Entry.PathOffset, Entry.PathSize);
+}
+
+UnicaMappedFile PackedArchive::ReadCompressedEntry(const PackedArchiveFormat::Entry& Entry) const
+{
+    UNICA_PROFILE_FUNCTION
+    std::vector<char> Buffer(Entry.Size);
+    const char* StoredBlock = m_ArchiveFile.GetData() + Entry.DataOffset;
+    const char* const StoredEnd = StoredBlock + Entry.StoredSize;
+
+    uint32 BlockIndex = Entry.FirstBlock;
+    for (uint64_t BlockOffset = 0; BlockOffset < Entry.Size; BlockOffset += m_BlockSize, BlockIndex++)
+    {
+        const size_t BlockSize = static_cast<size_t>(std::min<uint64_t>(m_BlockSize, Entry.Size - BlockOffset));
+        const size_t StoredBlockSize = m_BlockSizes[BlockIndex];
+        if (StoredBlockSize > static_cast<size_t>(StoredEnd - StoredBlock))
+        {
+            UNICA_LOG(spdlog::level::err, "'{}' in packed archive '{}' is corrupt", GetEntryPath(Entry), m_ArchivePath.string());
+            return { };
+        }
+
+        // Blocks that wouldn't shrink are stored as they are
+        if (StoredBlockSize == BlockSize)
+        {
+            std::memcpy(Buffer.data() + BlockOffset, StoredBlock, BlockSize);
+        }
+        else if (!BlockCompression::Decompress(StoredBlock, StoredBlockSize, Buffer.data() + BlockOffset, BlockSize))
+        {
+            UNICA_LOG(spdlog::level::err, "'{}' in packed archive '{}' is corrupt", GetEntryPath(Entry), m_ArchivePath.string());
+            return { };
+        }
+        StoredBlock += StoredBlockSize;
+    }
+
+    return UnicaMappedFile::FromBuffer(std::move(Buffer));
+}
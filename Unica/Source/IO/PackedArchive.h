@@ -0,0 +1,51 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+#include "PackedArchiveFormat.h"
+
+/**
+ * A read-only archive in the PackedArchiveFormat, mapped once and looked up in place. Uncompressed files are
+ * returned as slices of the archive's mapping, compressed ones are decompressed into a buffer of their own.
+ * Const member functions are safe to call from any thread
+ */
+class PackedArchive
+{
+public:
+    /** Returns null, after logging why, when the file isn't a valid archive */
+    static std::unique_ptr<PackedArchive> Open(const std::filesystem::path& ArchivePath);
+
+    /** @param RelativePath Path relative to the archive root, with forward slashes */
+    bool Contains(std::string_view RelativePath) const { return FindEntry(RelativePath) != nullptr; }
+    /** Returns an invalid view when the archive doesn't contain the file */
+    UnicaMappedFile ReadFile(std::string_view RelativePath) const;
+
+    void ForEachFile(const std::function<void(std::string_view RelativePath)>& Callback) const;
+
+    const std::filesystem::path& GetArchivePath() const { return m_ArchivePath; }
+    uint32 GetFileCount() const { return static_cast<uint32>(m_Entries.size()); }
+
+private:
+    PackedArchive() = default;
+
+    const PackedArchiveFormat::Entry* FindEntry(std::string_view RelativePath) const;
+    std::string_view GetEntryPath(const PackedArchiveFormat::Entry& Entry) const;
+    UnicaMappedFile ReadCompressedEntry(const PackedArchiveFormat::Entry& Entry) const;
+
+    std::filesystem::path m_ArchivePath;
+    UnicaMappedFile m_ArchiveFile;
+    uint32 m_BlockSize = 0;
+
+    // Views into m_ArchiveFile
+    std::span<const PackedArchiveFormat::Entry> m_Entries;
+    std::span<const uint32_t> m_BlockSizes;
+    std::string_view m_Paths;
+};
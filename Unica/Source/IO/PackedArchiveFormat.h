@@ -0,0 +1,76 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Layout of the archives written by Tools/UnicaPacker and mounted by the VirtualFileSystem.
+ * An archive is a FileHeader followed by the file data, the block table, the index and the path strings, in host
+ * byte order. The index is sorted by path hash so lookups are a binary search straight over the mapped file.
+ *
+ * Compressed files are split into BlockSize chunks compressed on their own with BlockCompression, so a block that
+ * didn't shrink is stored raw. The block table holds the stored size of every block, in file order
+ */
+namespace PackedArchiveFormat
+{
+    constexpr std::array<char, 4> Magic = { 'U', 'P', 'A', 'K' };
+    constexpr uint32_t Version = 1;
+    constexpr const char* FileExtension = ".upak";
+
+    // Alignment of every file's data inside the archive, enough for SPIR-V and SIMD loads straight from the mapping
+    constexpr uint64_t DataAlignment = 64;
+    constexpr uint32_t DefaultBlockSize = 64 * 1024;
+
+    struct FileHeader
+    {
+        std::array<char, 4> Magic = PackedArchiveFormat::Magic;
+        uint32_t Version = PackedArchiveFormat::Version;
+        uint32_t EntryCount = 0;
+        uint32_t BlockCount = 0;
+        uint32_t BlockSize = DefaultBlockSize;
+        uint32_t Padding = 0;
+        uint64_t IndexOffset = 0;
+        uint64_t BlockTableOffset = 0;
+        uint64_t PathsOffset = 0;
+        uint64_t PathsSize = 0;
+    };
+    static_assert(sizeof(FileHeader) == 56);
+
+    enum EntryFlags : uint32_t
+    {
+        EntryFlagNone = 0,
+        EntryFlagCompressed = 1 << 0
+    };
+
+    struct Entry
+    {
+        uint64_t PathHash = 0;
+        uint64_t DataOffset = 0;
+        // Size of the file once decompressed
+        uint64_t Size = 0;
+        // Bytes the file takes in the archive, same as Size unless compressed
+        uint64_t StoredSize = 0;
+        // Path relative to the mount point, with forward slashes, in the path strings
+        uint32_t PathOffset = 0;
+        uint32_t PathSize = 0;
+        // Index of the file's first block in the block table, only used when compressed
+        uint32_t FirstBlock = 0;
+        uint32_t Flags = EntryFlagNone;
+    };
+    static_assert(sizeof(Entry) == 48);
+
+    /** 64 bit FNV-1a of a path relative to the mount point, e.g. "Shaders/shader.vert.spv" */
+    constexpr uint64_t HashPath(const std::string_view Path)
+    {
+        uint64_t Hash = 14695981039346656037ull;
+        for (const char Character : Path)
+        {
+            Hash ^= static_cast<uint8_t>(Character);
+            Hash *= 1099511628211ull;
+        }
+        return Hash;
+    }
+}
@@ -0,0 +1,190 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "VirtualFileSystem.h"
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_set>
+
+#include "FileWatcher.h"
+#include "PackedArchive.h"
+#include "PackedArchiveFormat.h"
+#include "UnicaFileUtilities.h"
+#include "UnicaSettings.h"
+
+std::shared_mutex VirtualFileSystem::m_MountsMutex;
+std::vector<VirtualFileSystem::MountedArchive> VirtualFileSystem::m_Mounts;
+
+void VirtualFileSystem::MountArchives(const std::string& ArchiveDirectory, const std::string& MountPoint)
+{
+    UNICA_PROFILE_FUNCTION
+    const std::filesystem::path& ArchiveDirectoryPath = UnicaFileUtilities::ResolveDirectory(ArchiveDirectory);
+    if (!std::filesystem::is_directory(ArchiveDirectoryPath))
+    {
+        return;
+    }
+
+    // Sorted, so archives named to override others (e.g. a patch archive) mount in a predictable order
+    std::vector<std::filesystem::path> ArchivePaths;
+    for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(ArchiveDirectoryPath))
+    {
+        if (Entry.is_regular_file() && Entry.path().extension() == PackedArchiveFormat::FileExtension)
+        {
+            ArchivePaths.push_back(Entry.path());
+        }
+    }
+    std::sort(ArchivePaths.begin(), ArchivePaths.end());
+
+    for (const std::filesystem::path& ArchivePath : ArchivePaths)
+    {
+        Mount(ArchivePath, MountPoint);
+    }
+}
+
+bool VirtualFileSystem::Mount(const std::filesystem::path& ArchivePath, const std::string& MountPoint)
+{
+    UNICA_PROFILE_FUNCTION
+    std::unique_ptr<PackedArchive> Archive = PackedArchive::Open(ArchivePath);
+    if (!Archive)
+    {
+        return false;
+    }
+
+    std::filesystem::path MountDirectory = UnicaFileUtilities::ResolveDirectory(MountPoint).lexically_normal();
+    if (!MountDirectory.has_filename())
+    {
+        MountDirectory = MountDirectory.parent_path();
+    }
+
+    UNICA_LOG_INFO("Mounted '{}' on '{}'", ArchivePath.filename().string(), MountPoint);
+    const std::unique_lock MountsLock(m_MountsMutex);
+    m_Mounts.insert(m_Mounts.begin(), MountedArchive { std::move(MountDirectory), std::move(Archive) });
+    return true;
+}
+
+void VirtualFileSystem::UnmountAll()
+{
+    const std::unique_lock MountsLock(m_MountsMutex);
+    m_Mounts.clear();
+}
+
+UnicaMappedFile VirtualFileSystem::OpenFile(const std::filesystem::path& FilePath, const FileAccessPattern AccessPattern)
+{
+    UNICA_PROFILE_FUNCTION
+    if (UnicaSettings::bLooseFileOverlay && IsLooseFile(FilePath))
+    {
+        return UnicaMappedFile::Open(FilePath, AccessPattern);
+    }
+
+    {
+        const std::shared_lock MountsLock(m_MountsMutex);
+        for (const MountedArchive& Mount : m_Mounts)
+        {
+            const std::optional<std::string> PathInMount = GetPathInMount(FilePath, Mount.MountDirectory);
+            if (!PathInMount)
+            {
+                continue;
+            }
+
+            UnicaMappedFile File = Mount.Archive->ReadFile(*PathInMount);
+            if (File.IsValid())
+            {
+                return File;
+            }
+        }
+    }
+
+    return UnicaMappedFile::Open(FilePath, AccessPattern);
+}
+
+bool VirtualFileSystem::Exists(const std::filesystem::path& FilePath)
+{
+    if (IsLooseFile(FilePath))
+    {
+        return true;
+    }
+
+    const std::shared_lock MountsLock(m_MountsMutex);
+    return std::any_of(m_Mounts.begin(), m_Mounts.end(), [&FilePath](const MountedArchive& Mount)
+    {
+        const std::optional<std::string> PathInMount = GetPathInMount(FilePath, Mount.MountDirectory);
+        return PathInMount && Mount.Archive->Contains(*PathInMount);
+    });
+}
+
+std::vector<std::filesystem::path> VirtualFileSystem::FindFiles(const std::filesystem::path& Directory, const std::vector<std::string>& FileExtensions)
+{
+    UNICA_PROFILE_FUNCTION
+    const auto HasExtension = [&FileExtensions](const std::filesystem::path& FilePath)
+    {
+        return std::find(FileExtensions.begin(), FileExtensions.end(), FilePath.extension().string()) != FileExtensions.end();
+    };
+
+    // The watcher's index answers without touching the disk, scan only what it doesn't cover
+    std::vector<std::filesystem::path> FoundFiles;
+    if (!FileWatcher::FindFiles(Directory, FileExtensions, FoundFiles) && std::filesystem::is_directory(Directory))
+    {
+        for (const std::filesystem::directory_entry& Entry : std::filesystem::recursive_directory_iterator(Directory))
+        {
+            if (!Entry.is_directory() && HasExtension(Entry.path()))
+            {
+                FoundFiles.push_back(Entry.path());
+            }
+        }
+    }
+
+    std::unordered_set<std::string> FoundFilePaths;
+    for (const std::filesystem::path& FoundFile : FoundFiles)
+    {
+        FoundFilePaths.insert(FoundFile.lexically_normal().generic_string());
+    }
+
+    const std::shared_lock MountsLock(m_MountsMutex);
+    for (const MountedArchive& Mount : m_Mounts)
+    {
+        const std::optional<std::string> DirectoryInMount = GetPathInMount(Directory, Mount.MountDirectory);
+        if (!DirectoryInMount)
+        {
+            continue;
+        }
+
+        // The mount directory itself comes out as "."
+        const std::string PathPrefix = *DirectoryInMount == "." ? "" : *DirectoryInMount + "/";
+        Mount.Archive->ForEachFile([&](const std::string_view RelativePath)
+        {
+            if (RelativePath.substr(0, PathPrefix.size()) != PathPrefix)
+            {
+                return;
+            }
+
+            std::filesystem::path FilePath = Mount.MountDirectory / std::filesystem::path(RelativePath).make_preferred();
+            if (HasExtension(FilePath) && FoundFilePaths.insert(FilePath.generic_string()).second)
+            {
+                FoundFiles.push_back(std::move(FilePath));
+            }
+        });
+    }
+    return FoundFiles;
+}
+
+std::optional<std::string> VirtualFileSystem::GetPathInMount(const std::filesystem::path& FilePath, const std::filesystem::path& MountDirectory)
+{
+    std::filesystem::path RelativePath = FilePath.lexically_normal();
+    if (!RelativePath.has_filename())
+    {
+        RelativePath = RelativePath.parent_path();
+    }
+
+    RelativePath = RelativePath.lexically_relative(MountDirectory);
+    if (RelativePath.empty() || *RelativePath.begin() == "..")
+    {
+        return std::nullopt;
+    }
+    return RelativePath.generic_string();
+}
+
+bool VirtualFileSystem::IsLooseFile(const std::filesystem::path& FilePath)
+{
+    std::error_code Error;
+    return std::filesystem::is_regular_file(FilePath, Error);
+}
@@ -0,0 +1,57 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+
+class PackedArchive;
+
+/**
+ * Serves the files under the Engine: and Game: directories from packed archives mounted on them, so startup maps
+ * a handful of archives instead of opening hundreds of loose files. Paths are resolved as usual and then looked up
+ * relative to the directory each archive is mounted on, newest mount first.
+ * Loose files on disk override archived ones while UnicaSettings::bLooseFileOverlay is set, and are always the
+ * fallback for files no archive contains, e.g. everything under Saved
+ */
+class VirtualFileSystem
+{
+public:
+    /**
+     * Mount every archive in a directory
+     * @param ArchiveDirectory Unica path of the directory to look for archives in, e.g. "Engine:Paks"
+     * @param MountPoint Unica path of the directory the archives' contents are relative to, e.g. "Engine:"
+     */
+    static void MountArchives(const std::string& ArchiveDirectory, const std::string& MountPoint);
+    static bool Mount(const std::filesystem::path& ArchivePath, const std::string& MountPoint);
+    static void UnmountAll();
+
+    /** Returns an invalid view, after logging it, when the file is neither on disk nor in any archive */
+    static UnicaMappedFile OpenFile(const std::filesystem::path& FilePath, FileAccessPattern AccessPattern = FileAccessPattern::Sequential);
+    static bool Exists(const std::filesystem::path& FilePath);
+
+    /** Every file under Directory, on disk or archived, with one of FileExtensions. Each file is listed once */
+    static std::vector<std::filesystem::path> FindFiles(const std::filesystem::path& Directory, const std::vector<std::string>& FileExtensions);
+
+private:
+    struct MountedArchive
+    {
+        std::filesystem::path MountDirectory;
+        std::unique_ptr<PackedArchive> Archive;
+    };
+
+    /** Path relative to MountDirectory with forward slashes, like archives store them, if FilePath is inside it */
+    static std::optional<std::string> GetPathInMount(const std::filesystem::path& FilePath, const std::filesystem::path& MountDirectory);
+    static bool IsLooseFile(const std::filesystem::path& FilePath);
+
+    // Mounting happens on startup, lookups on any thread
+    static std::shared_mutex m_MountsMutex;
+    static std::vector<MountedArchive> m_Mounts;
+};
@@ -0,0 +1,219 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "InputManager.h"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+#include "UnicaInstance.h"
+
+UnicaRingBuffer<SDL_Event, InputManager::EventQueueCapacity> InputManager::m_EventQueue;
+uint64 InputManager::m_CoalescedEventCount = 0;
+std::unordered_map<uint32, std::vector<InputManager::InputSubscription>> InputManager::m_Subscriptions;
+std::vector<std::pair<uint32, InputManager::InputSubscription>> InputManager::m_PendingSubscriptions;
+InputSubscriptionHandle InputManager::m_LastSubscriptionHandle = 0;
+bool InputManager::m_bIsDispatching = false;
+InputSubscriptionHandle InputManager::m_QuitSubscription = 0;
+
+void InputManager::Init()
+{
+    m_QuitSubscription = Subscribe(SDL_EVENT_QUIT, [](const SDL_Event&)
+    {
+        UNICA_LOG_DEBUG("Window's close button (X) was pressed");
+        UnicaInstance::RequestExit();
+    });
+}
+
+void InputManager::Tick()
+{
+    UNICA_PROFILE_FUNCTION
+    PumpEvents();
+    DispatchEvents();
+}
+
+void InputManager::Shutdown()
+{
+    Unsubscribe(m_QuitSubscription);
+}
+
+InputSubscriptionHandle InputManager::Subscribe(const SDL_EventType EventType, InputEventCallback Callback)
+{
+    InputSubscription Subscription;
+    Subscription.Handle = ++m_LastSubscriptionHandle;
+    Subscription.Callback = std::move(Callback);
+    const InputSubscriptionHandle Handle = Subscription.Handle;
+
+    // Adding to a list that's being iterated could move the callback that's running
+    if (m_bIsDispatching)
+    {
+        m_PendingSubscriptions.emplace_back(EventType, std::move(Subscription));
+    }
+    else
+    {
+        m_Subscriptions[EventType].push_back(std::move(Subscription));
+    }
+    return Handle;
+}
+
+void InputManager::Unsubscribe(const InputSubscriptionHandle Handle)
+{
+    std::erase_if(m_PendingSubscriptions, [Handle](const std::pair<uint32, InputSubscription>& PendingSubscription)
+    {
+        return PendingSubscription.second.Handle == Handle;
+    });
+
+    for (std::pair<const uint32, std::vector<InputSubscription>>& EventSubscriptions : m_Subscriptions)
+    {
+        for (InputSubscription& Subscription : EventSubscriptions.second)
+        {
+            if (Subscription.Handle == Handle)
+            {
+                // Only cleared while dispatching, the callback might be the one unsubscribing itself
+                Subscription.Handle = 0;
+            }
+        }
+
+        if (!m_bIsDispatching)
+        {
+            std::erase_if(EventSubscriptions.second, [](const InputSubscription& Subscription) { return Subscription.Handle == 0; });
+        }
+    }
+}
+
+void InputManager::PumpEvents()
+{
+    UNICA_PROFILE_FUNCTION
+    {
+        UNICA_PROFILE_FUNCTION_NAMED("sdl::SDL_PumpEvents");
+        SDL_PumpEvents();
+    }
+
+    // Only the size the window ended the frame with matters, so these go in last
+    std::optional<SDL_Event> WindowResizedEvent;
+    std::optional<SDL_Event> PixelSizeChangedEvent;
+    std::optional<SDL_Event> PendingEvent;
+
+    // Room for the pending and resize events above. Whatever doesn't fit stays in SDL's queue for the next frame
+    constexpr uint32 ReservedEventCount = 3;
+    std::array<SDL_Event, 64> Events;
+    while (true)
+    {
+        const uint32 FreeEventCount = EventQueueCapacity - ReservedEventCount - m_EventQueue.GetSize();
+        const int32 EventCount = SDL_PeepEvents(Events.data(), static_cast<int32>(std::min<uint32>(FreeEventCount, Events.size())),
+            SDL_GETEVENT, SDL_EVENT_FIRST, SDL_EVENT_LAST);
+        if (EventCount <= 0)
+        {
+            break;
+        }
+
+        for (int32 EventIndex = 0; EventIndex < EventCount; EventIndex++)
+        {
+            const SDL_Event& Event = Events[EventIndex];
+            std::optional<SDL_Event>* const LatestResizeEvent = Event.type == SDL_EVENT_WINDOW_RESIZED ? &WindowResizedEvent
+                : Event.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED ? &PixelSizeChangedEvent : nullptr;
+            if (LatestResizeEvent)
+            {
+                m_CoalescedEventCount += LatestResizeEvent->has_value();
+                *LatestResizeEvent = Event;
+                continue;
+            }
+
+            if (PendingEvent && TryCoalesce(*PendingEvent, Event))
+            {
+                m_CoalescedEventCount++;
+                continue;
+            }
+
+            if (PendingEvent)
+            {
+                m_EventQueue.Push(*PendingEvent);
+            }
+            PendingEvent = Event;
+        }
+    }
+
+    for (const std::optional<SDL_Event>& Event : { PendingEvent, WindowResizedEvent, PixelSizeChangedEvent })
+    {
+        if (Event)
+        {
+            m_EventQueue.Push(*Event);
+        }
+    }
+    UNICA_PROFILE_PLOT("Input events", static_cast<int64>(m_EventQueue.GetSize()));
+}
+
+void InputManager::DispatchEvents()
+{
+    UNICA_PROFILE_FUNCTION
+    m_bIsDispatching = true;
+    SDL_Event Event;
+    while (m_EventQueue.Pop(Event))
+    {
+        const std::unordered_map<uint32, std::vector<InputSubscription>>::const_iterator EventSubscriptions = m_Subscriptions.find(Event.type);
+        if (EventSubscriptions == m_Subscriptions.end())
+        {
+            continue;
+        }
+
+        for (const InputSubscription& Subscription : EventSubscriptions->second)
+        {
+            if (Subscription.Handle != 0)
+            {
+                Subscription.Callback(Event);
+            }
+        }
+    }
+    m_bIsDispatching = false;
+
+    for (std::pair<const uint32, std::vector<InputSubscription>>& EventSubscriptions : m_Subscriptions)
+    {
+        std::erase_if(EventSubscriptions.second, [](const InputSubscription& Subscription) { return Subscription.Handle == 0; });
+    }
+    for (std::pair<uint32, InputSubscription>& PendingSubscription : m_PendingSubscriptions)
+    {
+        m_Subscriptions[PendingSubscription.first].push_back(std::move(PendingSubscription.second));
+    }
+    m_PendingSubscriptions.clear();
+}
+
+bool InputManager::TryCoalesce(SDL_Event& PendingEvent, const SDL_Event& Event)
+{
+    if (PendingEvent.type != Event.type)
+    {
+        return false;
+    }
+
+    switch (Event.type)
+    {
+    case SDL_EVENT_MOUSE_MOTION:
+    {
+        // A change in buttons held splits the motion, so drags still start and end where they did
+        SDL_MouseMotionEvent& PendingMotion = PendingEvent.motion;
+        if (PendingMotion.windowID != Event.motion.windowID || PendingMotion.which != Event.motion.which || PendingMotion.state != Event.motion.state)
+        {
+            return false;
+        }
+        PendingMotion.timestamp = Event.motion.timestamp;
+        PendingMotion.x = Event.motion.x;
+        PendingMotion.y = Event.motion.y;
+        PendingMotion.xrel += Event.motion.xrel;
+        PendingMotion.yrel += Event.motion.yrel;
+        return true;
+    }
+    case SDL_EVENT_MOUSE_WHEEL:
+    {
+        SDL_MouseWheelEvent& PendingWheel = PendingEvent.wheel;
+        if (PendingWheel.windowID != Event.wheel.windowID || PendingWheel.which != Event.wheel.which || PendingWheel.direction != Event.wheel.direction)
+        {
+            return false;
+        }
+        PendingWheel.timestamp = Event.wheel.timestamp;
+        PendingWheel.x += Event.wheel.x;
+        PendingWheel.y += Event.wheel.y;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,65 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "SDL3/SDL.h"
+
+#include "UnicaMinimal.h"
+#include "UnicaRingBuffer.h"
+#include "Subsystem/SubsystemBase.h"
+
+using InputEventCallback = std::function<void(const SDL_Event&)>;
+
+/** Identifies a subscription to pass to InputManager::Unsubscribe. Zero is never a valid handle */
+using InputSubscriptionHandle = uint64;
+
+/**
+ * Drains every pending SDL event once per frame into a fixed size ring and dispatches them to the subscribers
+ * of each event type. Consecutive mouse motion and wheel events are merged, and only the last resize of a frame
+ * is kept, so a burst of events costs one dispatch instead of adding latency frame after frame
+ */
+class InputManager final : public SubsystemBase
+{
+public:
+    /** Main thread only. Subscribing from within a callback takes effect from the next event on */
+    static InputSubscriptionHandle Subscribe(SDL_EventType EventType, InputEventCallback Callback);
+    static void Unsubscribe(InputSubscriptionHandle Handle);
+
+    static uint64 GetCoalescedEventCount() { return m_CoalescedEventCount; }
+
+private:
+    void Init() override;
+    void Tick() override;
+    void Shutdown() override;
+    bool ShouldTick() override { return true; }
+
+    // SDL only delivers events to the thread that initialized video
+    bool RequiresMainThread() const override { return true; }
+
+    static constexpr uint32 EventQueueCapacity = 1024;
+
+    struct InputSubscription
+    {
+        InputSubscriptionHandle Handle = 0;
+        InputEventCallback Callback;
+    };
+
+    static void PumpEvents();
+    static void DispatchEvents();
+
+    /** Merge Event into PendingEvent when the pair carries no information beyond the latest of them */
+    static bool TryCoalesce(SDL_Event& PendingEvent, const SDL_Event& Event);
+
+    static UnicaRingBuffer<SDL_Event, EventQueueCapacity> m_EventQueue;
+    static uint64 m_CoalescedEventCount;
+
+    static std::unordered_map<uint32, std::vector<InputSubscription>> m_Subscriptions;
+    static std::vector<std::pair<uint32, InputSubscription>> m_PendingSubscriptions;
+    static InputSubscriptionHandle m_LastSubscriptionHandle;
+    static bool m_bIsDispatching;
+    static InputSubscriptionHandle m_QuitSubscription;
+};
@@ -0,0 +1,22 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+class JobCounter;
+
+struct Job
+{
+    std::function<void()> Task;
+
+    // Decremented once Task has finished executing, may be null
+    JobCounter* Counter = nullptr;
+
+    // Shown as the zone name in Tracy, must outlive the job
+    const char* Name = "Job";
+
+    // Set while the job is queued or running so the pool can detect when it wraps onto live jobs
+    std::atomic<bool> bInFlight = false;
+};
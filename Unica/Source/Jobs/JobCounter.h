@@ -0,0 +1,35 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+struct Job;
+
+/**
+ * Tracks how many dispatched jobs are still pending. Jobs can be dispatched with a dependency on a counter,
+ * in which case they're only queued once the counter reaches zero.
+ * A counter must outlive every job referencing it, only destroy it after JobSystem::WaitForCounter returns
+ */
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    uint32 GetValue() const { return m_Value.load(std::memory_order_acquire); }
+    bool IsComplete() const { return GetValue() == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32> m_Value = 0;
+
+    mutable std::mutex m_ContinuationsMutex;
+    std::vector<Job*> m_Continuations;
+};
@@ -0,0 +1,66 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "JobQueue.h"
+
+bool JobQueue::Push(Job* const NewJob)
+{
+    const int64 Bottom = m_Bottom.load(std::memory_order_relaxed);
+    const int64 Top = m_Top.load(std::memory_order_acquire);
+    if (Bottom - Top >= Capacity)
+    {
+        return false;
+    }
+
+    m_Jobs[Bottom & CapacityMask].store(NewJob, std::memory_order_relaxed);
+    m_Bottom.store(Bottom + 1, std::memory_order_release);
+    return true;
+}
+
+Job* JobQueue::Pop()
+{
+    const int64 Bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(Bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64 Top = m_Top.load(std::memory_order_relaxed);
+
+    if (Top > Bottom)
+    {
+        // Queue was already empty
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* PoppedJob = m_Jobs[Bottom & CapacityMask].load(std::memory_order_relaxed);
+    if (Top == Bottom)
+    {
+        // Last job in the queue, race any stealer for it
+        if (!m_Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            PoppedJob = nullptr;
+        }
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+    }
+
+    return PoppedJob;
+}
+
+Job* JobQueue::Steal()
+{
+    int64 Top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64 Bottom = m_Bottom.load(std::memory_order_acquire);
+
+    if (Top >= Bottom)
+    {
+        return nullptr;
+    }
+
+    Job* StolenJob = m_Jobs[Top & CapacityMask].load(std::memory_order_relaxed);
+    if (!m_Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        // Lost the race against the owner or another stealer
+        return nullptr;
+    }
+
+    return StolenJob;
+}
@@ -0,0 +1,37 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "UnicaMinimal.h"
+
+struct Job;
+
+/**
+ * Fixed capacity Chase-Lev work-stealing deque. The owning worker pushes and pops from the bottom,
+ * every other worker steals from the top
+ */
+class JobQueue
+{
+public:
+    static constexpr int64 Capacity = 4096;
+
+    /** Owning thread only. Returns false when the queue is full */
+    bool Push(Job* NewJob);
+
+    /** Owning thread only */
+    Job* Pop();
+
+    /** Any thread */
+    Job* Steal();
+
+private:
+    static constexpr int64 CapacityMask = Capacity - 1;
+    static_assert((Capacity & CapacityMask) == 0, "JobQueue capacity must be a power of two");
+
+    alignas(64) std::atomic<int64> m_Top = 0;
+    alignas(64) std::atomic<int64> m_Bottom = 0;
+    std::array<std::atomic<Job*>, Capacity> m_Jobs { };
+};
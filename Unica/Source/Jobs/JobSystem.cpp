@@ -0,0 +1,326 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <array>
+
+#include <fmt/format.h>
+
+#include "Job.h"
+#include "UnicaMinimal.h"
+#include "UnicaSettings.h"
+
+namespace
+{
+    // Amount of failed job searches a worker does before going to sleep
+    constexpr uint32 IdleSpinCount = 64;
+
+    struct JobPool
+    {
+        std::array<Job, JobQueue::Capacity> Jobs;
+        uint32 NextJobIndex = 0;
+    };
+    thread_local std::unique_ptr<JobPool> ThreadJobPool;
+}
+
+std::vector<std::unique_ptr<JobQueue>> JobSystem::m_WorkerQueues;
+std::vector<std::thread> JobSystem::m_WorkerThreads;
+std::mutex JobSystem::m_InjectedJobsMutex;
+std::deque<Job*> JobSystem::m_InjectedJobs;
+std::atomic<uint32> JobSystem::m_InjectedJobCount = 0;
+std::atomic<int32> JobSystem::m_PendingJobCount = 0;
+std::atomic<uint32> JobSystem::m_SleepingWorkerCount = 0;
+std::mutex JobSystem::m_WakeUpMutex;
+std::condition_variable JobSystem::m_WakeUpCondition;
+std::atomic<bool> JobSystem::m_bShuttingDown = false;
+thread_local uint32 JobSystem::m_ThreadWorkerIndex = JobSystem::InvalidWorkerIndex;
+thread_local uint32 JobSystem::m_ThreadStealIndex = 0;
+
+void JobSystem::Init()
+{
+    uint32 WorkerThreadCount = UnicaSettings::JobWorkerThreadCount;
+    if (WorkerThreadCount == 0)
+    {
+        // The thread initializing the job system also executes jobs, so leave its core out
+        WorkerThreadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_bShuttingDown = false;
+    m_WorkerQueues.resize(WorkerThreadCount + 1);
+    for (std::unique_ptr<JobQueue>& WorkerQueue : m_WorkerQueues)
+    {
+        WorkerQueue = std::make_unique<JobQueue>();
+    }
+
+    m_ThreadWorkerIndex = 0;
+    for (uint32 WorkerIndex = 1; WorkerIndex <= WorkerThreadCount; WorkerIndex++)
+    {
+        m_WorkerThreads.emplace_back(&JobSystem::WorkerThreadMain, WorkerIndex);
+    }
+
+    UNICA_LOG_DEBUG("JobSystem started {} worker threads", WorkerThreadCount);
+}
+
+void JobSystem::Shutdown()
+{
+    {
+        const std::lock_guard WakeUpLock(m_WakeUpMutex);
+        m_bShuttingDown = true;
+    }
+    m_WakeUpCondition.notify_all();
+
+    for (std::thread& WorkerThread : m_WorkerThreads)
+    {
+        WorkerThread.join();
+    }
+
+    m_WorkerThreads.clear();
+    m_WorkerQueues.clear();
+    m_InjectedJobs.clear();
+    m_InjectedJobCount = 0;
+    m_PendingJobCount = 0;
+    m_ThreadWorkerIndex = InvalidWorkerIndex;
+}
+
+void JobSystem::Dispatch(const char* Name, std::function<void()> Task, JobCounter* Counter, JobCounter* Dependency)
+{
+    Job* const NewJob = AllocateJob();
+    NewJob->Task = std::move(Task);
+    NewJob->Counter = Counter;
+    NewJob->Name = Name;
+
+    if (Counter != nullptr)
+    {
+        Counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (Dependency != nullptr)
+    {
+        std::unique_lock ContinuationsLock(Dependency->m_ContinuationsMutex);
+        if (!Dependency->IsComplete())
+        {
+            // Queued by DecrementCounter once the dependency completes
+            Dependency->m_Continuations.push_back(NewJob);
+            return;
+        }
+    }
+
+    EnqueueJob(NewJob);
+}
+
+void JobSystem::ParallelFor(const char* Name, const uint32 Count, uint32 BatchSize, const std::function<void(uint32 Begin, uint32 End)>& Task)
+{
+    UNICA_PROFILE_FUNCTION
+    if (Count == 0)
+    {
+        return;
+    }
+
+    if (BatchSize == 0)
+    {
+        // A few batches per worker so faster workers can steal the remainder from slower ones
+        BatchSize = std::max(Count / (GetWorkerCount() * 4), 1u);
+    }
+
+    JobCounter ParallelForCounter;
+    for (uint32 BatchBegin = 0; BatchBegin < Count; BatchBegin += BatchSize)
+    {
+        const uint32 BatchEnd = std::min(BatchBegin + BatchSize, Count);
+        Dispatch(Name, [&Task, BatchBegin, BatchEnd] { Task(BatchBegin, BatchEnd); }, &ParallelForCounter);
+    }
+
+    WaitForCounter(ParallelForCounter);
+}
+
+void JobSystem::WaitForCounter(const JobCounter& Counter)
+{
+    UNICA_PROFILE_FUNCTION
+    while (!Counter.IsComplete())
+    {
+        if (!TryExecuteJob())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last decrement releases this lock after touching the counter, so it's safe to destroy once acquired
+    const std::lock_guard ContinuationsLock(Counter.m_ContinuationsMutex);
+}
+
+bool JobSystem::TryExecuteJob()
+{
+    Job* const FoundJob = FindJob();
+    if (FoundJob == nullptr)
+    {
+        return false;
+    }
+
+    ExecuteJob(FoundJob);
+    return true;
+}
+
+void JobSystem::WorkerThreadMain(const uint32 WorkerIndex)
+{
+    m_ThreadWorkerIndex = WorkerIndex;
+    m_ThreadStealIndex = WorkerIndex;
+
+    const std::string ThreadName = fmt::format("JobWorker {}", WorkerIndex);
+    UNICA_PROFILE_THREAD(ThreadName.c_str());
+
+    while (!m_bShuttingDown.load(std::memory_order_acquire))
+    {
+        if (!TryExecuteJob())
+        {
+            WaitForJobs();
+        }
+    }
+}
+
+void JobSystem::WaitForJobs()
+{
+    for (uint32 SpinIndex = 0; SpinIndex < IdleSpinCount; SpinIndex++)
+    {
+        if (m_PendingJobCount.load(std::memory_order_relaxed) > 0)
+        {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    UNICA_PROFILE_FUNCTION
+    std::unique_lock WakeUpLock(m_WakeUpMutex);
+    m_SleepingWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+    m_WakeUpCondition.wait(WakeUpLock, []
+    {
+        return m_PendingJobCount.load(std::memory_order_seq_cst) > 0 || m_bShuttingDown.load(std::memory_order_relaxed);
+    });
+    m_SleepingWorkerCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Job* JobSystem::AllocateJob()
+{
+    if (ThreadJobPool == nullptr)
+    {
+        ThreadJobPool = std::make_unique<JobPool>();
+    }
+
+    Job* const AllocatedJob = &ThreadJobPool->Jobs[ThreadJobPool->NextJobIndex];
+    ThreadJobPool->NextJobIndex = (ThreadJobPool->NextJobIndex + 1) % ThreadJobPool->Jobs.size();
+
+    if (AllocatedJob->bInFlight.exchange(true, std::memory_order_acquire))
+    {
+        UNICA_LOG_CRITICAL("Exhausted the job pool, more than {} jobs are in flight from a single thread", ThreadJobPool->Jobs.size());
+    }
+
+    return AllocatedJob;
+}
+
+void JobSystem::EnqueueJob(Job* const NewJob)
+{
+    // Counted before the job is visible so a woken worker never observes a negative pending count
+    m_PendingJobCount.fetch_add(1, std::memory_order_seq_cst);
+
+    if (!IsWorkerThread() || !m_WorkerQueues[m_ThreadWorkerIndex]->Push(NewJob))
+    {
+        const std::lock_guard InjectedJobsLock(m_InjectedJobsMutex);
+        m_InjectedJobs.push_back(NewJob);
+        m_InjectedJobCount.fetch_add(1, std::memory_order_release);
+    }
+
+    if (m_SleepingWorkerCount.load(std::memory_order_seq_cst) > 0)
+    {
+        {
+            const std::lock_guard WakeUpLock(m_WakeUpMutex);
+        }
+        m_WakeUpCondition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob()
+{
+    if (IsWorkerThread())
+    {
+        if (Job* const OwnJob = m_WorkerQueues[m_ThreadWorkerIndex]->Pop())
+        {
+            return OwnJob;
+        }
+    }
+
+    if (m_InjectedJobCount.load(std::memory_order_acquire) > 0)
+    {
+        const std::lock_guard InjectedJobsLock(m_InjectedJobsMutex);
+        if (!m_InjectedJobs.empty())
+        {
+            Job* const InjectedJob = m_InjectedJobs.front();
+            m_InjectedJobs.pop_front();
+            m_InjectedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            return InjectedJob;
+        }
+    }
+
+    const uint32 WorkerCount = GetWorkerCount();
+    for (uint32 StealAttempt = 0; StealAttempt < WorkerCount; StealAttempt++)
+    {
+        m_ThreadStealIndex = (m_ThreadStealIndex + 1) % WorkerCount;
+        if (m_ThreadStealIndex == m_ThreadWorkerIndex)
+        {
+            continue;
+        }
+
+        if (Job* const StolenJob = m_WorkerQueues[m_ThreadStealIndex]->Steal())
+        {
+            return StolenJob;
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::ExecuteJob(Job* const JobToExecute)
+{
+    m_PendingJobCount.fetch_sub(1, std::memory_order_relaxed);
+    {
+        UNICA_PROFILE_FUNCTION_DYNAMIC(JobToExecute->Name);
+        JobToExecute->Task();
+    }
+
+    // Release whatever the task captured now instead of when the pool slot gets reused
+    JobToExecute->Task = nullptr;
+    JobCounter* const Counter = JobToExecute->Counter;
+    JobToExecute->bInFlight.store(false, std::memory_order_release);
+
+    if (Counter != nullptr)
+    {
+        DecrementCounter(*Counter);
+    }
+}
+
+void JobSystem::DecrementCounter(JobCounter& Counter)
+{
+    uint32 CounterValue = Counter.m_Value.load(std::memory_order_relaxed);
+    while (CounterValue > 1)
+    {
+        if (Counter.m_Value.compare_exchange_weak(CounterValue, CounterValue - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    // Possibly the last decrement. Done under the lock so continuations can't be added after they were released
+    std::unique_lock ContinuationsLock(Counter.m_ContinuationsMutex);
+    if (Counter.m_Value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    {
+        return;
+    }
+
+    std::vector<Job*> ReadyJobs;
+    ReadyJobs.swap(Counter.m_Continuations);
+    ContinuationsLock.unlock();
+
+    // Counter may have been destroyed by its waiter by now, only touch the local copy
+    for (Job* const ReadyJob : ReadyJobs)
+    {
+        EnqueueJob(ReadyJob);
+    }
+}
@@ -0,0 +1,76 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "UnicaMinimal.h"
+#include "JobCounter.h"
+#include "JobQueue.h"
+#include "Subsystem/SubsystemBase.h"
+
+class JobSystem final : public SubsystemBase
+{
+public:
+    /**
+     * Queue a task to be executed by any worker
+     * @param Name Zone name shown in Tracy. Must outlive the job, string literals are ideal
+     * @param Counter Optional counter incremented now and decremented once the task finishes
+     * @param Dependency Optional counter that must reach zero before the task is queued
+     */
+    static void Dispatch(const char* Name, std::function<void()> Task, JobCounter* Counter = nullptr, JobCounter* Dependency = nullptr);
+
+    /**
+     * Split [0, Count) into batches, execute them across every worker and wait for all of them to finish
+     * @param BatchSize Amount of indices per job. Zero picks one based on the amount of workers
+     */
+    static void ParallelFor(const char* Name, uint32 Count, uint32 BatchSize, const std::function<void(uint32 Begin, uint32 End)>& Task);
+
+    /** Block until Counter reaches zero, executing pending jobs on the calling thread in the meantime */
+    static void WaitForCounter(const JobCounter& Counter);
+
+    /** Execute a single pending job on the calling thread, if there's any */
+    static bool TryExecuteJob();
+
+    /** Amount of threads executing jobs, including the thread that initialized the system */
+    static uint32 GetWorkerCount() { return static_cast<uint32>(m_WorkerQueues.size()); }
+    static bool IsWorkerThread() { return m_ThreadWorkerIndex != InvalidWorkerIndex; }
+
+private:
+    void Init() override;
+    void Shutdown() override;
+
+    static constexpr uint32 InvalidWorkerIndex = UINT32_MAX;
+
+    static void WorkerThreadMain(uint32 WorkerIndex);
+    static void WaitForJobs();
+
+    static Job* AllocateJob();
+    static void EnqueueJob(Job* NewJob);
+    static Job* FindJob();
+    static void ExecuteJob(Job* JobToExecute);
+    static void DecrementCounter(JobCounter& Counter);
+
+    static std::vector<std::unique_ptr<JobQueue>> m_WorkerQueues;
+    static std::vector<std::thread> m_WorkerThreads;
+
+    // Jobs dispatched from threads that don't own a JobQueue, e.g. the render thread
+    static std::mutex m_InjectedJobsMutex;
+    static std::deque<Job*> m_InjectedJobs;
+    static std::atomic<uint32> m_InjectedJobCount;
+
+    static std::atomic<int32> m_PendingJobCount;
+    static std::atomic<uint32> m_SleepingWorkerCount;
+    static std::mutex m_WakeUpMutex;
+    static std::condition_variable m_WakeUpCondition;
+    static std::atomic<bool> m_bShuttingDown;
+
+    static thread_local uint32 m_ThreadWorkerIndex;
+    static thread_local uint32 m_ThreadStealIndex;
+};
@@ -0,0 +1,64 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+/**
+ * Layout of the files written by BinaryLogSink and read by Tools/UnicaLogDecoder.
+ * A file is a BinaryLogFileHeader followed by entries, each a BinaryLogEntryType byte and the matching struct.
+ * Everything is in host byte order and the structs are copied in and out with memcpy, so they must not have padding.
+ *
+ * Format strings and their source location are written once per file as a FormatDefinition, records then only
+ * carry the definition's ID, a timestamp and LogRecord's encoded arguments. Every file starts a new set of IDs so
+ * it can be decoded on its own after older files rotated away
+ */
+namespace BinaryLogFormat
+{
+    constexpr std::array<char, 4> Magic = { 'U', 'L', 'O', 'G' };
+    constexpr uint32_t Version = 1;
+    constexpr const char* FileExtension = ".ulog";
+
+    struct FileHeader
+    {
+        std::array<char, 4> Magic = BinaryLogFormat::Magic;
+        uint32_t Version = BinaryLogFormat::Version;
+        // Increases by one every time the sink moves on to a new file, orders files that outlived a rotation
+        uint64_t Sequence = 0;
+        // Bytes of entries after the header, updated after every entry so a crashed process still leaves a readable file
+        uint64_t EntriesSize = 0;
+    };
+    static_assert(sizeof(FileHeader) == 24);
+
+    enum class EntryType : uint8_t
+    {
+        FormatDefinition = 1,
+        Record = 2
+    };
+
+    /** Followed by the format string, source file name and function name, without null terminators */
+    struct FormatDefinition
+    {
+        uint32_t FormatId = 0;
+        int32_t SourceLine = 0;
+        uint16_t FormatSize = 0;
+        uint16_t SourceFileSize = 0;
+        uint16_t SourceFunctionSize = 0;
+        uint8_t Level = 0;
+        uint8_t Padding = 0;
+    };
+    static_assert(sizeof(FormatDefinition) == 16);
+
+    /** Followed by PayloadSize bytes of LogRecord::Payload */
+    struct Record
+    {
+        int64_t TimestampNanos = 0;
+        uint64_t ThreadId = 0;
+        uint32_t FormatId = 0;
+        uint16_t PayloadSize = 0;
+        uint8_t ArgumentCount = 0;
+        uint8_t EncodedArgumentCount = 0;
+    };
+    static_assert(sizeof(Record) == 24);
+}
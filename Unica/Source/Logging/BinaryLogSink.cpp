@@ -0,0 +1,236 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "BinaryLogSink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Leaves room for the largest possible entries, a record and the three strings of its definition
+    constexpr size_t MinFileSize = 1024 * 1024;
+
+    std::string_view GetBoundedString(const char* String)
+    {
+        const std::string_view View = String ? std::string_view(String) : std::string_view();
+        return View.substr(0, UINT16_MAX);
+    }
+}
+
+size_t BinaryLogSink::FormatSiteHash::operator()(const FormatSite& Site) const
+{
+    size_t Hash = std::hash<const char*>()(Site.Format);
+    Hash = Hash * 31 + std::hash<const char*>()(Site.SourceFile);
+    Hash = Hash * 31 + static_cast<size_t>(Site.SourceLine);
+    return Hash * 31 + static_cast<size_t>(Site.Level);
+}
+
+BinaryLogSink::BinaryLogSink(const spdlog::level::level_enum Level, std::filesystem::path Directory, const size_t FileSize, const uint32_t FileCount)
+    : LogRecordSink(Level), m_Directory(std::move(Directory)), m_FileSize(std::max(FileSize, MinFileSize)), m_FileCount(std::max(FileCount, 1u))
+{
+    std::error_code Error;
+    std::filesystem::create_directories(m_Directory, Error);
+
+    // Continue after the newest file of the previous run, so the oldest files are the ones overwritten
+    for (const std::filesystem::directory_entry& Entry : std::filesystem::directory_iterator(m_Directory, Error))
+    {
+        if (Entry.path().extension() != BinaryLogFormat::FileExtension)
+        {
+            continue;
+        }
+
+        BinaryLogFormat::FileHeader Header;
+        std::ifstream File(Entry.path(), std::ios::binary);
+        if (File.read(reinterpret_cast<char*>(&Header), sizeof(Header)) && Header.Magic == BinaryLogFormat::Magic)
+        {
+            m_Sequence = std::max(m_Sequence, Header.Sequence + 1);
+        }
+    }
+
+    OpenNextFile();
+}
+
+BinaryLogSink::~BinaryLogSink()
+{
+    CloseFile();
+}
+
+void BinaryLogSink::Write(const LogRecord& Record)
+{
+    if (!m_MappedFile)
+    {
+        return;
+    }
+
+    const size_t RecordEntrySize = sizeof(BinaryLogFormat::EntryType) + sizeof(BinaryLogFormat::Record) + Record.PayloadSize;
+    const FormatSite Site = { Record.Format, Record.Source.filename, Record.Source.line, Record.Level };
+    std::unordered_map<FormatSite, uint32_t, FormatSiteHash>::const_iterator FormatId = m_FormatIds.find(Site);
+
+    // Budget for the definition too, it has to land in the same file as the record
+    const size_t DefinitionEntrySize = FormatId == m_FormatIds.end()
+        ? sizeof(BinaryLogFormat::EntryType) + sizeof(BinaryLogFormat::FormatDefinition) + Record.FormatSize
+            + GetBoundedString(Record.Source.filename).size() + GetBoundedString(Record.Source.funcname).size()
+        : 0;
+    if (!HasRoomFor(DefinitionEntrySize + RecordEntrySize))
+    {
+        OpenNextFile();
+        if (!m_MappedFile)
+        {
+            return;
+        }
+        FormatId = m_FormatIds.end();
+    }
+
+    BinaryLogFormat::Record RecordEntry;
+    RecordEntry.FormatId = FormatId != m_FormatIds.end() ? FormatId->second : DefineFormat(Record);
+    RecordEntry.TimestampNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(Record.Time.time_since_epoch()).count();
+    RecordEntry.ThreadId = Record.ThreadId;
+    RecordEntry.PayloadSize = Record.PayloadSize;
+    RecordEntry.ArgumentCount = Record.ArgumentCount;
+    RecordEntry.EncodedArgumentCount = Record.EncodedArgumentCount;
+
+    constexpr BinaryLogFormat::EntryType EntryType = BinaryLogFormat::EntryType::Record;
+    WriteBytes(&EntryType, sizeof(EntryType));
+    WriteBytes(&RecordEntry, sizeof(RecordEntry));
+    WriteBytes(Record.Payload.data(), Record.PayloadSize);
+    CommitEntry();
+}
+
+void BinaryLogSink::Flush()
+{
+    if (!m_MappedFile)
+    {
+        return;
+    }
+
+    // The pages already belong to the OS and survive a crash of the engine, this only schedules them to hit the disk
+#if defined(_WIN32)
+    FlushViewOfFile(m_MappedFile, m_WriteOffset);
+#else
+    msync(m_MappedFile, m_WriteOffset, MS_ASYNC);
+#endif
+}
+
+void BinaryLogSink::OpenNextFile()
+{
+    CloseFile();
+    m_FormatIds.clear();
+
+    m_FilePath = m_Directory / ("Unica_" + std::to_string(m_Sequence % m_FileCount) + BinaryLogFormat::FileExtension);
+    std::ofstream(m_FilePath, std::ios::binary | std::ios::trunc).close();
+    std::error_code Error;
+    std::filesystem::resize_file(m_FilePath, m_FileSize, Error);
+
+#if defined(_WIN32)
+    const HANDLE File = CreateFileW(m_FilePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (File != INVALID_HANDLE_VALUE)
+    {
+        const HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        if (Mapping)
+        {
+            m_MappedFile = static_cast<std::byte*>(MapViewOfFile(Mapping, FILE_MAP_WRITE, 0, 0, m_FileSize));
+            CloseHandle(Mapping);
+        }
+        CloseHandle(File);
+    }
+#else
+    const int File = open(m_FilePath.c_str(), O_RDWR);
+    if (File >= 0)
+    {
+        void* Mapping = mmap(nullptr, m_FileSize, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+        m_MappedFile = Mapping != MAP_FAILED ? static_cast<std::byte*>(Mapping) : nullptr;
+        close(File);
+    }
+#endif
+
+    if (Error || !m_MappedFile)
+    {
+        // Logging from a sink would recurse into it
+        fmt::print(stderr, "Failed to map binary log file '{}', binary logging is disabled\n", m_FilePath.string());
+        m_MappedFile = nullptr;
+        return;
+    }
+
+    BinaryLogFormat::FileHeader Header;
+    Header.Sequence = m_Sequence++;
+    std::memcpy(m_MappedFile, &Header, sizeof(Header));
+    m_WriteOffset = sizeof(Header);
+}
+
+void BinaryLogSink::CloseFile()
+{
+    if (!m_MappedFile)
+    {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(m_MappedFile);
+#else
+    munmap(m_MappedFile, m_FileSize);
+#endif
+    m_MappedFile = nullptr;
+
+    // Drop the unused preallocated tail
+    std::error_code Error;
+    std::filesystem::resize_file(m_FilePath, m_WriteOffset, Error);
+}
+
+uint32_t BinaryLogSink::DefineFormat(const LogRecord& Record)
+{
+    const std::string_view SourceFile = GetBoundedString(Record.Source.filename);
+    const std::string_view SourceFunction = GetBoundedString(Record.Source.funcname);
+
+    BinaryLogFormat::FormatDefinition Definition;
+    Definition.FormatId = static_cast<uint32_t>(m_FormatIds.size());
+    Definition.SourceLine = Record.Source.line;
+    Definition.FormatSize = static_cast<uint16_t>(std::min<size_t>(Record.FormatSize, UINT16_MAX));
+    Definition.SourceFileSize = static_cast<uint16_t>(SourceFile.size());
+    Definition.SourceFunctionSize = static_cast<uint16_t>(SourceFunction.size());
+    Definition.Level = static_cast<uint8_t>(Record.Level);
+
+    constexpr BinaryLogFormat::EntryType EntryType = BinaryLogFormat::EntryType::FormatDefinition;
+    WriteBytes(&EntryType, sizeof(EntryType));
+    WriteBytes(&Definition, sizeof(Definition));
+    WriteBytes(Record.Format, Definition.FormatSize);
+    WriteBytes(SourceFile.data(), SourceFile.size());
+    WriteBytes(SourceFunction.data(), SourceFunction.size());
+    CommitEntry();
+
+    m_FormatIds.emplace(FormatSite { Record.Format, Record.Source.filename, Record.Source.line, Record.Level }, Definition.FormatId);
+    return Definition.FormatId;
+}
+
+bool BinaryLogSink::HasRoomFor(const size_t EntrySize) const
+{
+    return m_WriteOffset + EntrySize <= m_FileSize;
+}
+
+void BinaryLogSink::WriteBytes(const void* Data, const size_t Size)
+{
+    if (Size == 0)
+    {
+        return;
+    }
+    std::memcpy(m_MappedFile + m_WriteOffset, Data, Size);
+    m_WriteOffset += Size;
+}
+
+void BinaryLogSink::CommitEntry()
+{
+    const uint64_t EntriesSize = m_WriteOffset - sizeof(BinaryLogFormat::FileHeader);
+    std::memcpy(m_MappedFile + offsetof(BinaryLogFormat::FileHeader, EntriesSize), &EntriesSize, sizeof(EntriesSize));
+}
@@ -0,0 +1,61 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <unordered_map>
+
+#include "BinaryLogFormat.h"
+#include "LogRecordSink.h"
+
+/**
+ * Writes log records in the compact BinaryLogFormat instead of text, so trace logging can stay on without paying
+ * for formatting. Files are memory mapped and rotate between FileCount files of FileSize bytes in Directory,
+ * overwriting the oldest. Decode them with Tools/UnicaLogDecoder
+ */
+class BinaryLogSink final : public LogRecordSink
+{
+public:
+    BinaryLogSink(spdlog::level::level_enum Level, std::filesystem::path Directory, size_t FileSize, uint32_t FileCount);
+    ~BinaryLogSink() override;
+
+    void Write(const LogRecord& Record) override;
+    void Flush() override;
+
+private:
+    /** A log call site, the same format string can be logged from several places and levels */
+    struct FormatSite
+    {
+        const char* Format;
+        const char* SourceFile;
+        int32_t SourceLine;
+        spdlog::level::level_enum Level;
+
+        bool operator==(const FormatSite& Other) const = default;
+    };
+
+    struct FormatSiteHash
+    {
+        size_t operator()(const FormatSite& Site) const;
+    };
+
+    void OpenNextFile();
+    void CloseFile();
+    uint32_t DefineFormat(const LogRecord& Record);
+    bool HasRoomFor(size_t EntrySize) const;
+    void WriteBytes(const void* Data, size_t Size);
+    void CommitEntry();
+
+    std::filesystem::path m_Directory;
+    size_t m_FileSize;
+    uint32_t m_FileCount;
+
+    std::filesystem::path m_FilePath;
+    std::byte* m_MappedFile = nullptr;
+    size_t m_WriteOffset = 0;
+    uint64_t m_Sequence = 0;
+
+    // Reset with every file, so each file carries the definitions its records use
+    std::unordered_map<FormatSite, uint32_t, FormatSiteHash> m_FormatIds;
+};
@@ -0,0 +1,89 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "LogRecord.h"
+
+#include <algorithm>
+
+namespace
+{
+    template <typename T>
+    T ReadValue(const std::byte* const Data)
+    {
+        T Value;
+        std::memcpy(&Value, Data, sizeof(T));
+        return Value;
+    }
+}
+
+void LogRecord::EncodeString(const std::string_view Value)
+{
+    constexpr size_t HeaderSize = sizeof(LogArgumentType) + sizeof(uint16_t);
+    if (PayloadSize + HeaderSize > PayloadCapacity)
+    {
+        PayloadSize = PayloadCapacity;
+        return;
+    }
+
+    const uint16_t StringSize = static_cast<uint16_t>(std::min(Value.size(), PayloadCapacity - PayloadSize - HeaderSize));
+    const LogArgumentType Type = LogArgumentType::String;
+    std::memcpy(&Payload[PayloadSize], &Type, sizeof(Type));
+    std::memcpy(&Payload[PayloadSize + sizeof(Type)], &StringSize, sizeof(StringSize));
+    std::memcpy(&Payload[PayloadSize + HeaderSize], Value.data(), StringSize);
+    PayloadSize += static_cast<uint16_t>(HeaderSize + StringSize);
+    EncodedArgumentCount++;
+}
+
+void LogRecord::DecodeArguments(fmt::dynamic_format_arg_store<fmt::format_context>& OutArguments) const
+{
+    const std::byte* Data = Payload.data();
+    for (uint8_t ArgumentIndex = 0; ArgumentIndex < EncodedArgumentCount; ArgumentIndex++)
+    {
+        const LogArgumentType Type = ReadValue<LogArgumentType>(Data);
+        Data += sizeof(Type);
+
+        switch (Type)
+        {
+        case LogArgumentType::Int64:
+            OutArguments.push_back(ReadValue<int64_t>(Data));
+            Data += sizeof(int64_t);
+            break;
+        case LogArgumentType::UInt64:
+            OutArguments.push_back(ReadValue<uint64_t>(Data));
+            Data += sizeof(uint64_t);
+            break;
+        case LogArgumentType::Float:
+            OutArguments.push_back(ReadValue<float>(Data));
+            Data += sizeof(float);
+            break;
+        case LogArgumentType::Double:
+            OutArguments.push_back(ReadValue<double>(Data));
+            Data += sizeof(double);
+            break;
+        case LogArgumentType::Bool:
+            OutArguments.push_back(ReadValue<bool>(Data));
+            Data += sizeof(bool);
+            break;
+        case LogArgumentType::Char:
+            OutArguments.push_back(ReadValue<char>(Data));
+            Data += sizeof(char);
+            break;
+        case LogArgumentType::String:
+        {
+            const uint16_t StringSize = ReadValue<uint16_t>(Data);
+            Data += sizeof(StringSize);
+            OutArguments.push_back(std::string_view(reinterpret_cast<const char*>(Data), StringSize));
+            Data += StringSize;
+            break;
+        }
+        case LogArgumentType::Pointer:
+            OutArguments.push_back(ReadValue<const void*>(Data));
+            Data += sizeof(const void*);
+            break;
+        }
+    }
+
+    for (uint8_t ArgumentIndex = EncodedArgumentCount; ArgumentIndex < ArgumentCount; ArgumentIndex++)
+    {
+        OutArguments.push_back(std::string_view());
+    }
+}
@@ -0,0 +1,131 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+#include <fmt/args.h>
+#include <fmt/format.h>
+#include <spdlog/common.h>
+
+enum class LogArgumentType : uint8_t
+{
+    Int64,
+    UInt64,
+    Float,
+    Double,
+    Bool,
+    Char,
+    String,
+    Pointer
+};
+
+/**
+ * A log call captured on the calling thread for the async writer to format later.
+ * The format string is kept by pointer, so it must be a literal, and the arguments are copied into Payload as
+ * type tagged values. Strings longer than the payload has room for are truncated
+ */
+struct LogRecord
+{
+    static constexpr size_t RecordSize = 256;
+
+    spdlog::log_clock::time_point Time;
+    size_t ThreadId = 0;
+    spdlog::source_loc Source;
+    const char* Format = nullptr;
+    uint32_t FormatSize = 0;
+    spdlog::level::level_enum Level = spdlog::level::off;
+    uint8_t ArgumentCount = 0;
+    // Arguments that fit in Payload, the rest are formatted as empty strings
+    uint8_t EncodedArgumentCount = 0;
+    uint16_t PayloadSize = 0;
+
+    static constexpr size_t PayloadCapacity = RecordSize - sizeof(Time) - sizeof(ThreadId) - sizeof(Source) - sizeof(Format)
+        - sizeof(FormatSize) - sizeof(Level) - sizeof(ArgumentCount) - sizeof(EncodedArgumentCount) - sizeof(PayloadSize);
+    std::array<std::byte, PayloadCapacity> Payload;
+
+    template <typename... Types>
+    void EncodeArguments(const Types&... Arguments)
+    {
+        static_assert(sizeof...(Types) <= UINT8_MAX, "Too many log arguments");
+        ArgumentCount = static_cast<uint8_t>(sizeof...(Types));
+        EncodedArgumentCount = 0;
+        PayloadSize = 0;
+        (EncodeArgument(Arguments), ...);
+    }
+
+    /** Pushes every argument to OutArguments. Strings point into Payload, so this record must outlive the formatting */
+    void DecodeArguments(fmt::dynamic_format_arg_store<fmt::format_context>& OutArguments) const;
+
+    std::string_view GetFormat() const { return { Format, FormatSize }; }
+
+private:
+    template <typename T>
+    void EncodeArgument(const T& Argument)
+    {
+        using ArgumentType = std::decay_t<T>;
+        if constexpr (std::is_same_v<ArgumentType, bool>)
+        {
+            EncodeValue(LogArgumentType::Bool, Argument);
+        }
+        else if constexpr (std::is_same_v<ArgumentType, char>)
+        {
+            EncodeValue(LogArgumentType::Char, Argument);
+        }
+        else if constexpr (std::is_integral_v<ArgumentType> && std::is_signed_v<ArgumentType>)
+        {
+            EncodeValue(LogArgumentType::Int64, static_cast<int64_t>(Argument));
+        }
+        else if constexpr (std::is_integral_v<ArgumentType>)
+        {
+            EncodeValue(LogArgumentType::UInt64, static_cast<uint64_t>(Argument));
+        }
+        else if constexpr (std::is_same_v<ArgumentType, float>)
+        {
+            EncodeValue(LogArgumentType::Float, Argument);
+        }
+        else if constexpr (std::is_same_v<ArgumentType, double>)
+        {
+            EncodeValue(LogArgumentType::Double, Argument);
+        }
+        else if constexpr (std::is_convertible_v<const ArgumentType&, std::string_view>)
+        {
+            EncodeString(std::string_view(Argument));
+        }
+        else if constexpr (std::is_same_v<ArgumentType, void*> || std::is_same_v<ArgumentType, const void*>)
+        {
+            EncodeValue(LogArgumentType::Pointer, static_cast<const void*>(Argument));
+        }
+        else
+        {
+            // Types with their own formatter can reference anything, so they're formatted right away
+            fmt::basic_memory_buffer<char, PayloadCapacity> FormattedArgument;
+            fmt::format_to(std::back_inserter(FormattedArgument), "{}", Argument);
+            EncodeString(std::string_view(FormattedArgument.data(), FormattedArgument.size()));
+        }
+    }
+
+    template <typename T>
+    void EncodeValue(const LogArgumentType Type, const T Value)
+    {
+        if (PayloadSize + sizeof(Type) + sizeof(T) > PayloadCapacity)
+        {
+            // Arguments are decoded in order, so nothing after this one can be encoded either
+            PayloadSize = PayloadCapacity;
+            return;
+        }
+        std::memcpy(&Payload[PayloadSize], &Type, sizeof(Type));
+        std::memcpy(&Payload[PayloadSize + sizeof(Type)], &Value, sizeof(T));
+        PayloadSize += sizeof(Type) + sizeof(T);
+        EncodedArgumentCount++;
+    }
+
+    void EncodeString(std::string_view Value);
+};
+
+static_assert(sizeof(LogRecord) == LogRecord::RecordSize, "LogRecord fields are expected to pack without padding");
+static_assert(std::is_trivially_copyable_v<LogRecord>, "LogRecords are copied through the log queues");
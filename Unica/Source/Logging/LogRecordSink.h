@@ -0,0 +1,24 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include "LogRecord.h"
+
+/**
+ * Receives log records before they're formatted, for outputs that don't need text.
+ * Called from a single thread at a time, the async writer or a logging thread while the Logger is synchronous
+ */
+class LogRecordSink
+{
+public:
+    explicit LogRecordSink(const spdlog::level::level_enum Level) : m_Level(Level) { }
+    virtual ~LogRecordSink() = default;
+
+    virtual void Write(const LogRecord& Record) = 0;
+    virtual void Flush() { }
+
+    spdlog::level::level_enum GetLevel() const { return m_Level; }
+
+private:
+    spdlog::level::level_enum m_Level;
+};
@@ -2,15 +2,347 @@
 
 #include "Logger.h"
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include "UnicaMinimal.h"
+#include "UnicaRingBuffer.h"
+
+struct LogThreadQueue
+{
+    static constexpr uint32 Capacity = 512;
+
+    UnicaRingBuffer<LogRecord, Capacity> Records;
+    // Set once the owning thread can no longer push, so the writer frees the queue after draining it
+    std::atomic<bool> bThreadExited = false;
+};
+
+struct LogFormatScratch
+{
+    fmt::memory_buffer Message;
+    fmt::dynamic_format_arg_store<fmt::format_context> Arguments;
+};
+
+namespace
+{
+    // Upper bound of how long a record waits in its queue when nothing wakes the writer
+    constexpr std::chrono::milliseconds WriterPollInterval(2);
+
+    thread_local LogThreadQueue* ThreadQueue = nullptr;
+    thread_local bool bThreadExiting = false;
+
+    struct ThreadQueueRelease
+    {
+        ~ThreadQueueRelease()
+        {
+            if (ThreadQueue)
+            {
+                ThreadQueue->bThreadExited.store(true, std::memory_order_release);
+                ThreadQueue = nullptr;
+            }
+            bThreadExiting = true;
+        }
+    };
+    thread_local ThreadQueueRelease ThreadQueueReleaser;
+}
+
 std::shared_ptr<spdlog::logger> Logger::m_CoreLogger;
+std::atomic<spdlog::level::level_enum> Logger::m_Level = spdlog::level::trace;
+std::atomic<bool> Logger::m_bAsync = false;
+std::atomic<uint32> Logger::m_ActiveEnqueuers = 0;
+std::mutex Logger::m_RecordSinksMutex;
+std::vector<std::unique_ptr<LogRecordSink>> Logger::m_RecordSinks;
+std::atomic<bool> Logger::m_bHasRecordSinks = false;
+std::mutex Logger::m_ThreadQueuesMutex;
+std::vector<std::unique_ptr<LogThreadQueue>> Logger::m_ThreadQueues;
+std::thread Logger::m_WriterThread;
+std::mutex Logger::m_WriterMutex;
+std::condition_variable Logger::m_WriterWakeup;
+std::condition_variable Logger::m_FlushCompleted;
+bool Logger::m_bWriterWakeRequested = false;
+bool Logger::m_bWriterRunning = false;
+std::atomic<uint64> Logger::m_FlushRequests = 0;
+uint64 Logger::m_CompletedFlushes = 0;
+std::vector<LogRecord> Logger::m_WriteBatch;
+
 void Logger::Init()
 {
     auto StdoutLogSink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
     m_CoreLogger = std::make_shared<spdlog::logger>("UNICA", StdoutLogSink);
-    m_CoreLogger->set_level(spdlog::level::trace);
     m_CoreLogger->set_pattern("[%T.%e] %-37!! %^%5!l%$: %v");
+    SetLevel(spdlog::level::trace);
+}
+
+void Logger::StartAsync()
+{
+    if (m_bAsync.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    m_WriteBatch.reserve(LogThreadQueue::Capacity);
+    m_bWriterRunning = true;
+    m_WriterThread = std::thread(&Logger::WriterLoop);
+    m_bAsync.store(true, std::memory_order_release);
+}
+
+void Logger::Shutdown()
+{
+    if (m_bAsync.exchange(false))
+    {
+        // A thread that saw async logging before the exchange may still be pushing, possibly into a full queue
+        while (m_ActiveEnqueuers.load() > 0)
+        {
+            std::this_thread::yield();
+        }
+
+        {
+            std::lock_guard Lock(m_WriterMutex);
+            m_bWriterRunning = false;
+        }
+        m_WriterWakeup.notify_one();
+        m_WriterThread.join();
+
+        // Anything queued between the writer's last drain and it stopping
+        LogFormatScratch FormatScratch;
+        WriteQueuedRecords(FormatScratch);
+    }
+    FlushSinks();
+
+    std::lock_guard Lock(m_RecordSinksMutex);
+    m_bHasRecordSinks.store(false, std::memory_order_relaxed);
+    m_RecordSinks.clear();
+    UpdateLevel();
+}
+
+void Logger::Flush()
+{
+    if (!m_bAsync.load(std::memory_order_acquire))
+    {
+        FlushSinks();
+        return;
+    }
+
+    const uint64 FlushRequest = m_FlushRequests.fetch_add(1) + 1;
+    std::unique_lock Lock(m_WriterMutex);
+    m_bWriterWakeRequested = true;
+    m_WriterWakeup.notify_one();
+    m_FlushCompleted.wait(Lock, [FlushRequest] { return m_CompletedFlushes >= FlushRequest || !m_bWriterRunning; });
+}
+
+void Logger::SetLevel(const spdlog::level::level_enum Level)
+{
+    std::lock_guard Lock(m_RecordSinksMutex);
+    m_CoreLogger->set_level(Level);
+    UpdateLevel();
+}
+
+void Logger::AddRecordSink(std::unique_ptr<LogRecordSink> Sink)
+{
+    std::lock_guard Lock(m_RecordSinksMutex);
+    m_RecordSinks.push_back(std::move(Sink));
+    m_bHasRecordSinks.store(true, std::memory_order_relaxed);
+    UpdateLevel();
+}
+
+bool Logger::Enqueue(LogRecord& Record)
+{
+    if (bThreadExiting)
+    {
+        // Thread locals are being destroyed, so this thread's queue may already be gone
+        LogFormatScratch FormatScratch;
+        WriteRecord(Record, FormatScratch);
+        return true;
+    }
+
+    // Sequentially consistent along with Shutdown's exchange, either it waits for this thread or this thread sees
+    // async logging is off and never touches a queue the writer won't drain again
+    m_ActiveEnqueuers.fetch_add(1);
+    if (!m_bAsync.load())
+    {
+        m_ActiveEnqueuers.fetch_sub(1);
+        return false;
+    }
+
+    LogThreadQueue* Queue = ThreadQueue ? ThreadQueue : RegisterThreadQueue();
+    while (!Queue->Records.Push(Record))
+    {
+        WakeWriter();
+        std::this_thread::yield();
+    }
+
+    if (Queue->Records.GetSize() == LogThreadQueue::Capacity / 2)
+    {
+        WakeWriter();
+    }
+    m_ActiveEnqueuers.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+LogThreadQueue* Logger::RegisterThreadQueue()
+{
+    // Touching the releaser constructs it, so its destructor runs when this thread exits
+    (void)ThreadQueueReleaser;
+
+    std::lock_guard Lock(m_ThreadQueuesMutex);
+    ThreadQueue = m_ThreadQueues.emplace_back(std::make_unique<LogThreadQueue>()).get();
+    return ThreadQueue;
+}
+
+void Logger::WriterLoop()
+{
+    UNICA_PROFILE_THREAD("LogWriter");
+    LogFormatScratch FormatScratch;
+
+    std::unique_lock Lock(m_WriterMutex);
+    while (true)
+    {
+        m_WriterWakeup.wait_for(Lock, WriterPollInterval, [] { return m_bWriterWakeRequested || !m_bWriterRunning; });
+        m_bWriterWakeRequested = false;
+        const bool bStopping = !m_bWriterRunning;
+        const uint64 FlushRequests = m_FlushRequests.load(std::memory_order_acquire);
+        const bool bFlushRequested = FlushRequests != m_CompletedFlushes;
+        Lock.unlock();
+
+        WriteQueuedRecords(FormatScratch);
+        if (bFlushRequested)
+        {
+            FlushSinks();
+        }
+
+        Lock.lock();
+        if (bFlushRequested)
+        {
+            m_CompletedFlushes = FlushRequests;
+            m_FlushCompleted.notify_all();
+        }
+        if (bStopping)
+        {
+            m_FlushCompleted.notify_all();
+            return;
+        }
+    }
+}
+
+void Logger::WriteQueuedRecords(LogFormatScratch& FormatScratch)
+{
+    UNICA_PROFILE_FUNCTION
+    {
+        std::lock_guard Lock(m_ThreadQueuesMutex);
+        for (std::unique_ptr<LogThreadQueue>& Queue : m_ThreadQueues)
+        {
+            // Read before draining, once set the thread can't push anything the drain would miss
+            const bool bThreadExited = Queue->bThreadExited.load(std::memory_order_acquire);
+
+            LogRecord Record;
+            while (Queue->Records.Pop(Record))
+            {
+                m_WriteBatch.push_back(Record);
+            }
+
+            if (bThreadExited)
+            {
+                Queue.reset();
+            }
+        }
+        std::erase(m_ThreadQueues, nullptr);
+    }
+
+    // Each queue is in order, merging them by time keeps the output readable across threads
+    std::stable_sort(m_WriteBatch.begin(), m_WriteBatch.end(), [](const LogRecord& Left, const LogRecord& Right)
+    {
+        return Left.Time < Right.Time;
+    });
+
+    for (const LogRecord& Record : m_WriteBatch)
+    {
+        WriteRecord(Record, FormatScratch);
+    }
+    m_WriteBatch.clear();
+}
+
+void Logger::WriteRecord(const LogRecord& Record, LogFormatScratch& FormatScratch)
+{
+    WriteToRecordSinks(Record);
+    if (!m_CoreLogger->should_log(Record.Level))
+    {
+        return;
+    }
+
+    FormatScratch.Message.clear();
+    FormatScratch.Arguments.clear();
+    Record.DecodeArguments(FormatScratch.Arguments);
+
+    spdlog::string_view_t Message;
+    try
+    {
+        fmt::vformat_to(std::back_inserter(FormatScratch.Message), Record.GetFormat(), FormatScratch.Arguments);
+        Message = spdlog::string_view_t(FormatScratch.Message.data(), FormatScratch.Message.size());
+    }
+    catch (const fmt::format_error&)
+    {
+        // Only reachable through fmt::runtime format strings, the rest are checked at compile time
+        Message = Record.GetFormat();
+    }
+
+    spdlog::details::log_msg LogMessage(Record.Time, Record.Source, m_CoreLogger->name(), Record.Level, Message);
+    LogMessage.thread_id = Record.ThreadId;
+    for (const spdlog::sink_ptr& Sink : m_CoreLogger->sinks())
+    {
+        if (Sink->should_log(Record.Level))
+        {
+            Sink->log(LogMessage);
+        }
+    }
+}
+
+void Logger::WakeWriter()
+{
+    {
+        std::lock_guard Lock(m_WriterMutex);
+        m_bWriterWakeRequested = true;
+    }
+    m_WriterWakeup.notify_one();
+}
+
+void Logger::WriteToRecordSinks(const LogRecord& Record)
+{
+    if (!m_bHasRecordSinks.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    std::lock_guard Lock(m_RecordSinksMutex);
+    for (const std::unique_ptr<LogRecordSink>& Sink : m_RecordSinks)
+    {
+        if (Record.Level >= Sink->GetLevel())
+        {
+            Sink->Write(Record);
+        }
+    }
+}
+
+void Logger::FlushSinks()
+{
+    m_CoreLogger->flush();
+
+    std::lock_guard Lock(m_RecordSinksMutex);
+    for (const std::unique_ptr<LogRecordSink>& Sink : m_RecordSinks)
+    {
+        Sink->Flush();
+    }
+}
+
+void Logger::UpdateLevel()
+{
+    // Calls are let through when anything would output them
+    spdlog::level::level_enum Level = m_CoreLogger->level();
+    for (const std::unique_ptr<LogRecordSink>& Sink : m_RecordSinks)
+    {
+        Level = std::min(Level, Sink->GetLevel());
+    }
+    m_Level.store(Level, std::memory_order_relaxed);
 }
@@ -2,14 +2,113 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 #include <spdlog/spdlog.h>
+#include <spdlog/details/os.h>
+
+#include "LogRecord.h"
+#include "LogRecordSink.h"
 
+struct LogThreadQueue;
+struct LogFormatScratch;
+
+/**
+ * Engine log. Starts out synchronous, writing on the calling thread, and moves to a background writer once
+ * StartAsync is called. In async mode a log call only copies its arguments into a per-thread lock-free queue,
+ * formatting and writing to the sinks happens on the writer thread.
+ * Besides spdlog's text sinks, LogRecordSinks receive every record unformatted
+ */
 class Logger
 {
 public:
     static void Init();
-    static std::shared_ptr<spdlog::logger> GetCoreLogger() { return m_CoreLogger; }
+
+    static void StartAsync();
+    /** Writes out everything still queued and returns to synchronous logging */
+    static void Shutdown();
+
+    /** Blocks until everything this thread logged so far reached the sinks */
+    static void Flush();
+
+    /** Level of the text output, record sinks keep their own */
+    static void SetLevel(spdlog::level::level_enum Level);
+    static void AddRecordSink(std::unique_ptr<LogRecordSink> Sink);
+    static bool ShouldLog(const spdlog::level::level_enum Level) { return Level >= m_Level.load(std::memory_order_relaxed); }
+
+    template <typename... Types>
+    static void Log(const spdlog::source_loc& Source, const spdlog::level::level_enum Level, fmt::format_string<Types...> Format, Types&&... Arguments)
+    {
+        const bool bAsync = m_bAsync.load(std::memory_order_acquire);
+        if (bAsync || m_bHasRecordSinks.load(std::memory_order_relaxed))
+        {
+            const fmt::string_view FormatView = Format;
+            LogRecord Record;
+            Record.Time = spdlog::log_clock::now();
+            Record.ThreadId = spdlog::details::os::thread_id();
+            Record.Source = Source;
+            Record.Format = FormatView.data();
+            Record.FormatSize = static_cast<uint32_t>(FormatView.size());
+            Record.Level = Level;
+            Record.EncodeArguments(Arguments...);
+
+            if (bAsync && Enqueue(Record))
+            {
+                return;
+            }
+            WriteToRecordSinks(Record);
+        }
+
+        if (m_CoreLogger->should_log(Level))
+        {
+            m_CoreLogger->log(Source, Level, Format, std::forward<Types>(Arguments)...);
+        }
+    }
+
+    static spdlog::logger* GetCoreLogger() { return m_CoreLogger.get(); }
+
 private:
+    /** @return False when the writer is stopping, the caller writes Record itself then */
+    static bool Enqueue(LogRecord& Record);
+    static LogThreadQueue* RegisterThreadQueue();
+
+    static void WriterLoop();
+    /** Writer thread only, or any thread once the writer stopped */
+    static void WriteQueuedRecords(LogFormatScratch& FormatScratch);
+    static void WriteRecord(const LogRecord& Record, LogFormatScratch& FormatScratch);
+    static void WakeWriter();
+    static void WriteToRecordSinks(const LogRecord& Record);
+    static void FlushSinks();
+    /** Callers hold m_RecordSinksMutex */
+    static void UpdateLevel();
+
     static std::shared_ptr<spdlog::logger> m_CoreLogger;
+    static std::atomic<spdlog::level::level_enum> m_Level;
+    static std::atomic<bool> m_bAsync;
+    // Threads within Enqueue, Shutdown keeps the writer draining until they're all out
+    static std::atomic<uint32_t> m_ActiveEnqueuers;
+
+    static std::mutex m_RecordSinksMutex;
+    static std::vector<std::unique_ptr<LogRecordSink>> m_RecordSinks;
+    static std::atomic<bool> m_bHasRecordSinks;
+
+    static std::mutex m_ThreadQueuesMutex;
+    static std::vector<std::unique_ptr<LogThreadQueue>> m_ThreadQueues;
+
+    static std::thread m_WriterThread;
+    static std::mutex m_WriterMutex;
+    static std::condition_variable m_WriterWakeup;
+    static std::condition_variable m_FlushCompleted;
+    static bool m_bWriterWakeRequested;
+    static bool m_bWriterRunning;
+    static std::atomic<uint64_t> m_FlushRequests;
+    static uint64_t m_CompletedFlushes;
+    static std::vector<LogRecord> m_WriteBatch;
 };
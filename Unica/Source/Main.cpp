@@ -1,6 +1,7 @@
 // 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
 
 #include "UnicaMinimal.h"
+#include "UnicaConfig.h"
 #include "UnicaInstance.h"
 
 int main(int argc, char* argv[])
@@ -9,6 +10,7 @@ int main(int argc, char* argv[])
 
     Logger::Init();
     EngineInstance->SetProjectRootDirectory(/* SystemStyledExecutableDirectory */ argv[0]);
+    UnicaConfig::Init(argc, argv);
     EngineInstance->Init();
 
     while (!UnicaInstance::HasRequestedExit())
@@ -18,5 +20,6 @@ int main(int argc, char* argv[])
     }
 
     EngineInstance->Shutdown();
+    Logger::Shutdown();
     return 0;
 }
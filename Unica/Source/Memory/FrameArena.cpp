@@ -0,0 +1,100 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "FrameArena.h"
+
+#include <numeric>
+
+#include "UnicaSettings.h"
+
+namespace
+{
+    class FrameArenaMemoryResource final : public std::pmr::memory_resource
+    {
+        void* do_allocate(const size_t Bytes, const size_t Alignment) override
+        {
+            return FrameArena::Allocate(Bytes, Alignment);
+        }
+
+        void do_deallocate(void* /* Pointer */, size_t /* Bytes */, size_t /* Alignment */) override { }
+
+        bool do_is_equal(const std::pmr::memory_resource& Other) const noexcept override
+        {
+            return this == &Other;
+        }
+    };
+
+    FrameArenaMemoryResource MemoryResource;
+}
+
+std::atomic<uint64> FrameArena::m_FrameNumber = 0;
+thread_local std::array<FrameArena::ArenaBuffer, 2> FrameArena::m_ThreadBuffers;
+
+void* FrameArena::Allocate(const size_t Size, const size_t Alignment)
+{
+    const uint64 FrameNumber = GetFrameNumber();
+    ArenaBuffer& Buffer = m_ThreadBuffers[FrameNumber % m_ThreadBuffers.size()];
+    if (Buffer.FrameNumber != FrameNumber)
+    {
+        ResetBuffer(Buffer);
+        Buffer.FrameNumber = FrameNumber;
+    }
+
+    void* Memory = TryAllocateFromLastBlock(Buffer, Size, Alignment);
+    if (Memory == nullptr)
+    {
+        AddBlock(Buffer, Size + Alignment);
+        Memory = TryAllocateFromLastBlock(Buffer, Size, Alignment);
+    }
+    return Memory;
+}
+
+void* FrameArena::TryAllocateFromLastBlock(ArenaBuffer& Buffer, const size_t Size, const size_t Alignment)
+{
+    if (Buffer.Blocks.empty())
+    {
+        return nullptr;
+    }
+
+    const ArenaBlock& Block = Buffer.Blocks.back();
+    const uintptr_t BlockAddress = reinterpret_cast<uintptr_t>(Block.Memory.get());
+    const uintptr_t AlignedAddress = (BlockAddress + Buffer.Offset + Alignment - 1) & ~(Alignment - 1);
+    const size_t AlignedOffset = AlignedAddress - BlockAddress;
+    if (AlignedOffset + Size > Block.Size)
+    {
+        return nullptr;
+    }
+
+    Buffer.Offset = AlignedOffset + Size;
+    return Block.Memory.get() + AlignedOffset;
+}
+
+std::pmr::memory_resource* FrameArena::GetMemoryResource()
+{
+    return &MemoryResource;
+}
+
+void FrameArena::ResetBuffer(ArenaBuffer& Buffer)
+{
+    Buffer.Offset = 0;
+    if (Buffer.Blocks.size() <= 1)
+    {
+        return;
+    }
+
+    const size_t TotalSize = std::accumulate(Buffer.Blocks.begin(), Buffer.Blocks.end(), size_t(0), [](const size_t Sum, const ArenaBlock& Block)
+    {
+        return Sum + Block.Size;
+    });
+
+    UNICA_LOG_DEBUG("Frame arena overflowed, growing it to {} bytes", TotalSize);
+    Buffer.Blocks.clear();
+    AddBlock(Buffer, TotalSize);
+}
+
+void FrameArena::AddBlock(ArenaBuffer& Buffer, const size_t MinimumSize)
+{
+    ArenaBlock& Block = Buffer.Blocks.emplace_back();
+    Block.Size = std::max<size_t>(MinimumSize, UnicaSettings::FrameArenaBlockSize);
+    Block.Memory = std::make_unique_for_overwrite<std::byte[]>(Block.Size);
+    Buffer.Offset = 0;
+}
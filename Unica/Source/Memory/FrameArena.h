@@ -0,0 +1,57 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Per-thread linear allocator for memory that only has to live until the end of the next frame.
+ * Every thread owns two buffers and allocates from the one matching the current frame's parity, which is reset the
+ * first time the thread allocates in a new frame. Memory from frame N thus stays valid while the render thread
+ * consumes frame N during frame N+1. Deallocation is a no-op
+ */
+class FrameArena
+{
+public:
+    /** Start a new frame, invalidating memory allocated two frames ago. Called at the top of UnicaInstance::Tick */
+    static void BeginFrame() { m_FrameNumber.fetch_add(1, std::memory_order_release); }
+    static uint64 GetFrameNumber() { return m_FrameNumber.load(std::memory_order_acquire); }
+
+    static void* Allocate(size_t Size, size_t Alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    static T* Allocate(const size_t Count = 1) { return static_cast<T*>(Allocate(sizeof(T) * Count, alignof(T))); }
+
+    /** Memory resource for std::pmr containers, e.g. std::pmr::vector<T> Values(FrameArena::GetMemoryResource()) */
+    static std::pmr::memory_resource* GetMemoryResource();
+
+private:
+    struct ArenaBlock
+    {
+        std::unique_ptr<std::byte[]> Memory;
+        size_t Size = 0;
+    };
+
+    struct ArenaBuffer
+    {
+        // Allocations are carved from the last block. A frame that overflows it chains new ones, which are merged
+        // into a single bigger block on the next reset so steady state frames never reach the heap
+        std::vector<ArenaBlock> Blocks;
+        size_t Offset = 0;
+        uint64 FrameNumber = UINT64_MAX;
+    };
+
+    static void* TryAllocateFromLastBlock(ArenaBuffer& Buffer, size_t Size, size_t Alignment);
+    static void ResetBuffer(ArenaBuffer& Buffer);
+    static void AddBlock(ArenaBuffer& Buffer, size_t MinimumSize);
+
+    static std::atomic<uint64> m_FrameNumber;
+    static thread_local std::array<ArenaBuffer, 2> m_ThreadBuffers;
+};
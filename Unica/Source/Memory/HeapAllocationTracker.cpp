@@ -0,0 +1,98 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "HeapAllocationTracker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "FrameArena.h"
+#include "UnicaSettings.h"
+
+std::atomic<uint64> HeapAllocationTracker::m_AllocationCount = 0;
+std::atomic<uint64> HeapAllocationTracker::m_AllocatedBytes = 0;
+uint64 HeapAllocationTracker::m_LastReportedAllocationCount = 0;
+uint64 HeapAllocationTracker::m_LastReportedAllocatedBytes = 0;
+
+void HeapAllocationTracker::ReportFrameAllocations()
+{
+    if constexpr (!IsEnabled())
+    {
+        return;
+    }
+
+    const uint64 AllocationCount = GetAllocationCount();
+    const uint64 AllocatedBytes = GetAllocatedBytes();
+    const uint64 FrameAllocationCount = AllocationCount - m_LastReportedAllocationCount;
+    const uint64 FrameAllocatedBytes = AllocatedBytes - m_LastReportedAllocatedBytes;
+
+    UNICA_PROFILE_PLOT("Heap Allocations", static_cast<int64>(FrameAllocationCount));
+
+    if (UnicaSettings::bReportFrameHeapAllocations && FrameAllocationCount > 0 && FrameArena::GetFrameNumber() > UnicaSettings::FrameHeapAllocationWarmupFrames)
+    {
+        if (UnicaSettings::bFatalFrameHeapAllocations)
+        {
+            UNICA_LOG_CRITICAL("Frame {} made {} heap allocations ({} bytes) outside of the frame arena", FrameArena::GetFrameNumber(), FrameAllocationCount, FrameAllocatedBytes);
+        }
+        UNICA_LOG_WARN("Frame {} made {} heap allocations ({} bytes) outside of the frame arena", FrameArena::GetFrameNumber(), FrameAllocationCount, FrameAllocatedBytes);
+    }
+
+    // Read again so the allocations made by the report itself don't count towards the next frame
+    m_LastReportedAllocationCount = GetAllocationCount();
+    m_LastReportedAllocatedBytes = GetAllocatedBytes();
+}
+
+#if !UNICA_SHIPPING
+// Array and nothrow variants forward to these by default
+
+void* operator new(const size_t Size)
+{
+    HeapAllocationTracker::RecordAllocation(Size);
+    if (void* const Memory = std::malloc(Size > 0 ? Size : 1))
+    {
+        return Memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(const size_t Size, const std::align_val_t Alignment)
+{
+    HeapAllocationTracker::RecordAllocation(Size);
+    const size_t AlignmentBytes = static_cast<size_t>(Alignment);
+#ifdef _WIN32
+    void* const Memory = _aligned_malloc(Size > 0 ? Size : 1, AlignmentBytes);
+#else
+    // aligned_alloc requires the size to be a multiple of the alignment
+    void* const Memory = std::aligned_alloc(AlignmentBytes, (std::max<size_t>(Size, 1) + AlignmentBytes - 1) & ~(AlignmentBytes - 1));
+#endif
+    if (Memory != nullptr)
+    {
+        return Memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* Memory) noexcept
+{
+    std::free(Memory);
+}
+
+void operator delete(void* Memory, size_t /* Size */) noexcept
+{
+    std::free(Memory);
+}
+
+void operator delete(void* Memory, std::align_val_t /* Alignment */) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(Memory);
+#else
+    std::free(Memory);
+#endif
+}
+
+void operator delete(void* Memory, size_t /* Size */, const std::align_val_t Alignment) noexcept
+{
+    operator delete(Memory, Alignment);
+}
+#endif
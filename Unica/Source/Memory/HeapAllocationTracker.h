@@ -0,0 +1,42 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Counts every general heap allocation made by any thread. Non-shipping builds replace the global operator new to
+ * feed it, so per-frame code that still reaches the heap instead of the FrameArena can be reported
+ */
+class HeapAllocationTracker
+{
+public:
+    static constexpr bool IsEnabled() { return !UNICA_SHIPPING; }
+
+    static uint64 GetAllocationCount() { return m_AllocationCount.load(std::memory_order_relaxed); }
+    static uint64 GetAllocatedBytes() { return m_AllocatedBytes.load(std::memory_order_relaxed); }
+
+    /** Called by the replaced operator new, must not allocate */
+    static void RecordAllocation(const size_t Size)
+    {
+        m_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+        m_AllocatedBytes.fetch_add(Size, std::memory_order_relaxed);
+    }
+
+    /**
+     * Plot the allocations made since the last call and, when UnicaSettings::bReportFrameHeapAllocations is set, warn
+     * about them once the engine is past its warm-up frames, or fail with a critical error when
+     * UnicaSettings::bFatalFrameHeapAllocations is set too. Called once per frame by UnicaInstance
+     */
+    static void ReportFrameAllocations();
+
+private:
+    static std::atomic<uint64> m_AllocationCount;
+    static std::atomic<uint64> m_AllocatedBytes;
+
+    static uint64 m_LastReportedAllocationCount;
+    static uint64 m_LastReportedAllocatedBytes;
+};
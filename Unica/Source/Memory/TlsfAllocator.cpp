@@ -0,0 +1,246 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "TlsfAllocator.h"
+
+#include <algorithm>
+#include <bit>
+
+TlsfAllocator::TlsfAllocator(const uint64 Size) : m_Size(Size)
+{
+    for (std::array<uint32, SecondLevelCount>& SecondLevelLists : m_FreeLists)
+    {
+        SecondLevelLists.fill(InvalidHandle);
+    }
+
+    if (Size > 0)
+    {
+        const uint32 WholeRange = CreateRange();
+        m_Ranges[WholeRange].Size = Size;
+        m_Ranges[WholeRange].bFree = true;
+        InsertFreeRange(WholeRange);
+    }
+}
+
+uint32 TlsfAllocator::Allocate(uint64 Size, const uint64 Alignment)
+{
+    Size = std::max<uint64>(Size, 1);
+    // Enough room to align the start of any range found, without having to look at more than one
+    const uint64 SearchSize = Size + Alignment - 1;
+    if (SearchSize > m_Size)
+    {
+        return InvalidHandle;
+    }
+
+    uint32 Handle = FindFreeRange(SearchSize);
+    if (Handle == InvalidHandle)
+    {
+        return InvalidHandle;
+    }
+    RemoveFreeRange(Handle);
+
+    // Free ranges never border each other, so both leftovers become free ranges of their own instead of merging
+    const uint64 Padding = ((m_Ranges[Handle].Offset + Alignment - 1) & ~(Alignment - 1)) - m_Ranges[Handle].Offset;
+    if (Padding > 0)
+    {
+        SplitRange(Handle, Padding);
+        InsertFreeRange(Handle);
+        Handle = m_Ranges[Handle].NextPhysical;
+    }
+    if (m_Ranges[Handle].Size > Size)
+    {
+        SplitRange(Handle, Size);
+        InsertFreeRange(m_Ranges[Handle].NextPhysical);
+    }
+
+    m_Ranges[Handle].bFree = false;
+    m_AllocatedSize += m_Ranges[Handle].Size;
+    m_AllocationCount++;
+    return Handle;
+}
+
+void TlsfAllocator::Free(uint32 Handle)
+{
+    m_AllocatedSize -= m_Ranges[Handle].Size;
+    m_AllocationCount--;
+    m_Ranges[Handle].bFree = true;
+
+    const uint32 NextPhysical = m_Ranges[Handle].NextPhysical;
+    if (NextPhysical != InvalidHandle && m_Ranges[NextPhysical].bFree)
+    {
+        RemoveFreeRange(NextPhysical);
+        MergeWithPrevious(NextPhysical);
+    }
+
+    const uint32 PreviousPhysical = m_Ranges[Handle].PreviousPhysical;
+    if (PreviousPhysical != InvalidHandle && m_Ranges[PreviousPhysical].bFree)
+    {
+        RemoveFreeRange(PreviousPhysical);
+        MergeWithPrevious(Handle);
+        Handle = PreviousPhysical;
+    }
+
+    InsertFreeRange(Handle);
+}
+
+void TlsfAllocator::MapSize(const uint64 Size, uint32& OutFirstLevel, uint32& OutSecondLevel)
+{
+    if (Size < SecondLevelCount)
+    {
+        OutFirstLevel = 0;
+        OutSecondLevel = static_cast<uint32>(Size);
+        return;
+    }
+
+    const uint32 MostSignificantBit = static_cast<uint32>(std::bit_width(Size)) - 1;
+    OutFirstLevel = MostSignificantBit - SecondLevelBits + 1;
+    OutSecondLevel = static_cast<uint32>(Size >> (MostSignificantBit - SecondLevelBits)) ^ SecondLevelCount;
+}
+
+uint32 TlsfAllocator::FindFreeRange(const uint64 Size) const
+{
+    // Rounded up to where the next list starts, any range in it is then big enough
+    uint64 RoundedSize = Size;
+    if (Size >= SecondLevelCount)
+    {
+        RoundedSize += (1ull << (std::bit_width(Size) - 1 - SecondLevelBits)) - 1;
+    }
+
+    uint32 FirstLevel = 0;
+    uint32 SecondLevel = 0;
+    MapSize(RoundedSize, FirstLevel, SecondLevel);
+
+    uint32 SecondLevelBitmap = m_SecondLevelBitmaps[FirstLevel] & (~0u << SecondLevel);
+    if (SecondLevelBitmap == 0)
+    {
+        const uint64 FirstLevelBitmap = FirstLevel + 1 < FirstLevelCount ? m_FirstLevelBitmap & (~0ull << (FirstLevel + 1)) : 0;
+        if (FirstLevelBitmap == 0)
+        {
+            return FindFreeRangeInList(Size);
+        }
+        FirstLevel = static_cast<uint32>(std::countr_zero(FirstLevelBitmap));
+        SecondLevelBitmap = m_SecondLevelBitmaps[FirstLevel];
+    }
+    return m_FreeLists[FirstLevel][std::countr_zero(SecondLevelBitmap)];
+}
+
+uint32 TlsfAllocator::FindFreeRangeInList(const uint64 Size) const
+{
+    uint32 FirstLevel = 0;
+    uint32 SecondLevel = 0;
+    MapSize(Size, FirstLevel, SecondLevel);
+
+    for (uint32 Handle = m_FreeLists[FirstLevel][SecondLevel]; Handle != InvalidHandle; Handle = m_Ranges[Handle].NextFree)
+    {
+        if (m_Ranges[Handle].Size >= Size)
+        {
+            return Handle;
+        }
+    }
+    return InvalidHandle;
+}
+
+void TlsfAllocator::InsertFreeRange(const uint32 Handle)
+{
+    uint32 FirstLevel = 0;
+    uint32 SecondLevel = 0;
+    MapSize(m_Ranges[Handle].Size, FirstLevel, SecondLevel);
+
+    const uint32 Head = m_FreeLists[FirstLevel][SecondLevel];
+    m_Ranges[Handle].bFree = true;
+    m_Ranges[Handle].PreviousFree = InvalidHandle;
+    m_Ranges[Handle].NextFree = Head;
+    if (Head != InvalidHandle)
+    {
+        m_Ranges[Head].PreviousFree = Handle;
+    }
+
+    m_FreeLists[FirstLevel][SecondLevel] = Handle;
+    m_SecondLevelBitmaps[FirstLevel] |= 1u << SecondLevel;
+    m_FirstLevelBitmap |= 1ull << FirstLevel;
+}
+
+void TlsfAllocator::RemoveFreeRange(const uint32 Handle)
+{
+    uint32 FirstLevel = 0;
+    uint32 SecondLevel = 0;
+    MapSize(m_Ranges[Handle].Size, FirstLevel, SecondLevel);
+
+    const Range& FreeRange = m_Ranges[Handle];
+    if (FreeRange.PreviousFree != InvalidHandle)
+    {
+        m_Ranges[FreeRange.PreviousFree].NextFree = FreeRange.NextFree;
+    }
+    if (FreeRange.NextFree != InvalidHandle)
+    {
+        m_Ranges[FreeRange.NextFree].PreviousFree = FreeRange.PreviousFree;
+    }
+
+    if (m_FreeLists[FirstLevel][SecondLevel] == Handle)
+    {
+        m_FreeLists[FirstLevel][SecondLevel] = FreeRange.NextFree;
+        if (FreeRange.NextFree == InvalidHandle)
+        {
+            m_SecondLevelBitmaps[FirstLevel] &= ~(1u << SecondLevel);
+            if (m_SecondLevelBitmaps[FirstLevel] == 0)
+            {
+                m_FirstLevelBitmap &= ~(1ull << FirstLevel);
+            }
+        }
+    }
+}
+
+void TlsfAllocator::SplitRange(const uint32 Handle, const uint64 Size)
+{
+    // Creating the range may grow m_Ranges, so nothing in it is held by reference before that
+    const uint32 Remainder = CreateRange();
+    Range& OriginalRange = m_Ranges[Handle];
+    Range& RemainderRange = m_Ranges[Remainder];
+
+    RemainderRange.Offset = OriginalRange.Offset + Size;
+    RemainderRange.Size = OriginalRange.Size - Size;
+    RemainderRange.PreviousPhysical = Handle;
+    RemainderRange.NextPhysical = OriginalRange.NextPhysical;
+    if (OriginalRange.NextPhysical != InvalidHandle)
+    {
+        m_Ranges[OriginalRange.NextPhysical].PreviousPhysical = Remainder;
+    }
+
+    OriginalRange.Size = Size;
+    OriginalRange.NextPhysical = Remainder;
+}
+
+void TlsfAllocator::MergeWithPrevious(const uint32 Handle)
+{
+    const Range& MergedRange = m_Ranges[Handle];
+    Range& PreviousRange = m_Ranges[MergedRange.PreviousPhysical];
+
+    PreviousRange.Size += MergedRange.Size;
+    PreviousRange.NextPhysical = MergedRange.NextPhysical;
+    if (MergedRange.NextPhysical != InvalidHandle)
+    {
+        m_Ranges[MergedRange.NextPhysical].PreviousPhysical = MergedRange.PreviousPhysical;
+    }
+
+    ReleaseRange(Handle);
+}
+
+uint32 TlsfAllocator::CreateRange()
+{
+    if (m_FirstUnusedRange == InvalidHandle)
+    {
+        m_Ranges.emplace_back();
+        return static_cast<uint32>(m_Ranges.size() - 1);
+    }
+
+    const uint32 Handle = m_FirstUnusedRange;
+    m_FirstUnusedRange = m_Ranges[Handle].NextFree;
+    m_Ranges[Handle] = { };
+    return Handle;
+}
+
+void TlsfAllocator::ReleaseRange(const uint32 Handle)
+{
+    m_Ranges[Handle] = { };
+    m_Ranges[Handle].NextFree = m_FirstUnusedRange;
+    m_FirstUnusedRange = Handle;
+}
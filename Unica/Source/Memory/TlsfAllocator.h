@@ -0,0 +1,81 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Two-Level Segregated Fit allocator over a range of offsets it doesn't own, e.g. a block of GPU memory, so none of
+ * its bookkeeping lives in the memory it hands out. Free ranges are kept in lists indexed by the power of two of their
+ * size and a linear subdivision of it, and two bitmaps find a list with a range that fits in constant time.
+ * Freed ranges merge with their free neighbours right away. Not thread safe
+ */
+class TlsfAllocator
+{
+public:
+    static constexpr uint32 InvalidHandle = UINT32_MAX;
+
+    explicit TlsfAllocator(uint64 Size);
+
+    /**
+     * Alignment must be a power of two
+     * @return Handle of the allocation, InvalidHandle when no free range fits it
+     */
+    uint32 Allocate(uint64 Size, uint64 Alignment);
+    void Free(uint32 Handle);
+
+    uint64 GetOffset(const uint32 Handle) const { return m_Ranges[Handle].Offset; }
+    uint64 GetSize() const { return m_Size; }
+    uint64 GetAllocatedSize() const { return m_AllocatedSize; }
+    uint32 GetAllocationCount() const { return m_AllocationCount; }
+    bool IsEmpty() const { return m_AllocationCount == 0; }
+
+private:
+    // Sizes in [2^n, 2^(n+1)) are split into 2^SecondLevelBits lists, smaller ones get a list per size
+    static constexpr uint32 SecondLevelBits = 4;
+    static constexpr uint32 SecondLevelCount = 1 << SecondLevelBits;
+    static constexpr uint32 FirstLevelCount = 64 - SecondLevelBits + 1;
+
+    struct Range
+    {
+        uint64 Offset = 0;
+        uint64 Size = 0;
+        // Neighbours by offset, InvalidHandle at either end
+        uint32 PreviousPhysical = InvalidHandle;
+        uint32 NextPhysical = InvalidHandle;
+        // Neighbours in the free list of its size, also links unused entries of m_Ranges together
+        uint32 PreviousFree = InvalidHandle;
+        uint32 NextFree = InvalidHandle;
+        bool bFree = false;
+    };
+
+    static void MapSize(uint64 Size, uint32& OutFirstLevel, uint32& OutSecondLevel);
+    /** A free range at least Size big, InvalidHandle when there's none */
+    uint32 FindFreeRange(uint64 Size) const;
+    /** Last resort once no bigger list has a range, e.g. when asking for all of a block. Walks the list Size is in */
+    uint32 FindFreeRangeInList(uint64 Size) const;
+
+    void InsertFreeRange(uint32 Handle);
+    void RemoveFreeRange(uint32 Handle);
+    /** Split the part of Handle past Size into a range of its own, which the caller inserts in a free list or uses */
+    void SplitRange(uint32 Handle, uint64 Size);
+    /** Fold Handle into its previous physical neighbour, which absorbs its size */
+    void MergeWithPrevious(uint32 Handle);
+
+    uint32 CreateRange();
+    void ReleaseRange(uint32 Handle);
+
+    std::vector<Range> m_Ranges;
+    uint32 m_FirstUnusedRange = InvalidHandle;
+
+    uint64 m_FirstLevelBitmap = 0;
+    std::array<uint32, FirstLevelCount> m_SecondLevelBitmaps { };
+    std::array<std::array<uint32, SecondLevelCount>, FirstLevelCount> m_FreeLists;
+
+    uint64 m_Size = 0;
+    uint64 m_AllocatedSize = 0;
+    uint32 m_AllocationCount = 0;
+};
@@ -11,12 +11,6 @@ void ManagedInterface::Init()
     }
 }
 
-void ManagedInterface::Tick()
-{
-    UNICA_PROFILE_FUNCTION
-    m_SdlRenderWindow->Tick();
-}
-
 void ManagedInterface::Shutdown()
 {
 }
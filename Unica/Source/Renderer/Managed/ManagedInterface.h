@@ -8,7 +8,7 @@ class ManagedInterface : public RenderInterface
 {
 public:
     void Init() override;
-    void Tick() override;
+    void RenderFrame() override { }
     void Shutdown() override;
 
 private:
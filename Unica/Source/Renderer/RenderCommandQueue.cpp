@@ -0,0 +1,71 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "RenderCommandQueue.h"
+
+void RenderCommandQueue::Enqueue(RenderCommand Command)
+{
+    const std::lock_guard QueueLock(m_QueueMutex);
+    m_CommandBuffers[m_RecordingBufferIndex].push_back(std::move(Command));
+}
+
+void RenderCommandQueue::SubmitFrame()
+{
+    UNICA_PROFILE_FUNCTION
+    std::unique_lock QueueLock(m_QueueMutex);
+    m_FrameExecutedCondition.wait(QueueLock, [this]
+    {
+        return !m_bFrameSubmitted;
+    });
+
+    m_RecordingBufferIndex = 1 - m_RecordingBufferIndex;
+    m_bFrameSubmitted = true;
+    m_FrameSubmittedCondition.notify_one();
+}
+
+void RenderCommandQueue::Flush()
+{
+    UNICA_PROFILE_FUNCTION
+    SubmitFrame();
+
+    std::unique_lock QueueLock(m_QueueMutex);
+    m_FrameExecutedCondition.wait(QueueLock, [this]
+    {
+        return !m_bFrameSubmitted;
+    });
+}
+
+bool RenderCommandQueue::ExecuteNextFrame()
+{
+    std::unique_lock QueueLock(m_QueueMutex);
+    m_FrameSubmittedCondition.wait(QueueLock, [this]
+    {
+        return m_bFrameSubmitted || m_bClosed;
+    });
+
+    if (!m_bFrameSubmitted)
+    {
+        return false;
+    }
+
+    // The game thread only swaps buffers once this frame is marked as executed, so this one is ours until then
+    std::vector<RenderCommand>& CommandBuffer = m_CommandBuffers[1 - m_RecordingBufferIndex];
+    QueueLock.unlock();
+
+    for (const RenderCommand& Command : CommandBuffer)
+    {
+        Command();
+    }
+    CommandBuffer.clear();
+
+    QueueLock.lock();
+    m_bFrameSubmitted = false;
+    m_FrameExecutedCondition.notify_all();
+    return true;
+}
+
+void RenderCommandQueue::Close()
+{
+    const std::lock_guard QueueLock(m_QueueMutex);
+    m_bClosed = true;
+    m_FrameSubmittedCondition.notify_one();
+}
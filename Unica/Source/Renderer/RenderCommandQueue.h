@@ -0,0 +1,53 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+using RenderCommand = std::function<void()>;
+
+/**
+ * Double-buffered stream of commands from the game thread to the render thread. The game thread records frame N+1
+ * into one buffer while the render thread executes frame N from the other, and SubmitFrame swaps them
+ */
+class RenderCommandQueue
+{
+public:
+    /** Record a command into the frame being built. Safe to call from any game side thread */
+    void Enqueue(RenderCommand Command);
+
+    /**
+     * Hand the recorded frame over to the render thread. Blocks while the render thread is still executing the previous
+     * one, which keeps the game thread at most one frame ahead
+     */
+    void SubmitFrame();
+
+    /** Submit whatever was recorded and block until the render thread executed every frame */
+    void Flush();
+
+    /**
+     * Render thread only. Wait for a submitted frame and execute its commands in recording order
+     * @return False once the queue was closed and every submitted frame was executed
+     */
+    bool ExecuteNextFrame();
+
+    /** Wake the render thread up for good, after it executes any frame that is still pending */
+    void Close();
+
+private:
+    std::array<std::vector<RenderCommand>, 2> m_CommandBuffers;
+    uint32 m_RecordingBufferIndex = 0;
+
+    bool m_bFrameSubmitted = false;
+    bool m_bClosed = false;
+
+    std::mutex m_QueueMutex;
+    std::condition_variable m_FrameSubmittedCondition;
+    std::condition_variable m_FrameExecutedCondition;
+};
@@ -7,6 +7,9 @@ class RenderInterface
 public:
     virtual void Init() = 0;
     virtual void Shutdown() = 0;
-    virtual void Tick() = 0;
+    /** Main thread part of a frame, after InputManager dispatched this frame's events */
+    virtual void Tick() { }
+    /** Record and present a frame. Runs on the render thread */
+    virtual void RenderFrame() = 0;
     virtual ~RenderInterface() = default;
 };
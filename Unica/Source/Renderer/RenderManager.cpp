@@ -3,20 +3,45 @@
 #include "RenderManager.h"
 
 #include "UnicaMinimal.h"
+#include "Input/InputManager.h"
+#include "Subsystem/SubsystemDependencies.h"
+#include "Timer/FramePacer.h"
 #include "Vulkan/VulkanInterface.h"
 
 void RenderManager::Init()
 {
     m_RenderInterface->Init();
+    m_RenderThread->Start();
 }
 
 void RenderManager::Tick()
 {
     UNICA_PROFILE_FUNCTION
     m_RenderInterface->Tick();
+    if (FramePacer::IsIdle())
+    {
+        // Nothing is visible, and a minimized window has no size to build a swap chain for
+        return;
+    }
+
+    // Logic for the next frame overlaps the render thread drawing this one
+    EnqueueRenderCommand([this]
+    {
+        m_RenderInterface->RenderFrame();
+    });
+    m_RenderThread->GetCommandQueue().SubmitFrame();
+}
+
+void RenderManager::DeclareDependencies(SubsystemDependencies& Dependencies) const
+{
+    // The swap chain picks its present mode based on how frames are paced
+    Dependencies.Reads<FramePacer>();
+    // Window events, resizes in particular, are dispatched before the frame is handed to the render thread
+    Dependencies.Reads<InputManager>();
 }
 
 void RenderManager::Shutdown()
 {
+    m_RenderThread->Stop();
     m_RenderInterface->Shutdown();
 }
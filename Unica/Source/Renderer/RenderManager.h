@@ -2,17 +2,30 @@
 
 #pragma once
 
+#include "RenderThread.h"
 #include "Managed/ManagedInterface.h"
 #include "Subsystem/SubsystemBase.h"
 #include "Vulkan/VulkanInterface.h"
 
 class RenderManager final : public SubsystemBase
 {
+public:
+    /** Record a command to run on the render thread as part of the next submitted frame */
+    void EnqueueRenderCommand(RenderCommand Command) { m_RenderThread->GetCommandQueue().Enqueue(std::move(Command)); }
+
+    /** Block until the render thread executed everything submitted so far */
+    void FlushRenderCommands() { m_RenderThread->GetCommandQueue().Flush(); }
+
 private:
     void Init() override;
     void Tick() override;
     void Shutdown() override;
     bool ShouldTick() override { return true; }
+    void DeclareDependencies(SubsystemDependencies& Dependencies) const override;
+
+    // SDL windows and their events belong to the main thread, which hands frames over to the render thread
+    bool RequiresMainThread() const override { return true; }
 
     std::unique_ptr<RenderInterface> m_RenderInterface = std::make_unique<VulkanInterface>();
+    std::unique_ptr<RenderThread> m_RenderThread = std::make_unique<RenderThread>();
 };
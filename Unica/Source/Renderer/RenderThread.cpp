@@ -0,0 +1,33 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "RenderThread.h"
+
+#include "UnicaMinimal.h"
+
+void RenderThread::Start()
+{
+    m_Thread = std::thread(&RenderThread::RenderThreadMain, this);
+    UNICA_LOG_DEBUG("Render thread started");
+}
+
+void RenderThread::Stop()
+{
+    if (!m_Thread.joinable())
+    {
+        return;
+    }
+
+    m_CommandQueue.Flush();
+    m_CommandQueue.Close();
+    m_Thread.join();
+    UNICA_LOG_DEBUG("Render thread stopped");
+}
+
+void RenderThread::RenderThreadMain()
+{
+    UNICA_PROFILE_THREAD("RenderThread");
+    while (m_CommandQueue.ExecuteNextFrame())
+    {
+        UNICA_PROFILE_FRAME("RenderFrame");
+    }
+}
@@ -0,0 +1,25 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <thread>
+
+#include "RenderCommandQueue.h"
+
+/** Thread that owns GPU submission and presentation, fed through a RenderCommandQueue by the game thread */
+class RenderThread
+{
+public:
+    void Start();
+
+    /** Execute every frame submitted so far and join the thread */
+    void Stop();
+
+    RenderCommandQueue& GetCommandQueue() { return m_CommandQueue; }
+
+private:
+    void RenderThreadMain();
+
+    RenderCommandQueue m_CommandQueue;
+    std::thread m_Thread;
+};
@@ -2,9 +2,9 @@
 
 #include "RenderWindow.h"
 
-#include "UnicaInstance.h"
 #include "UnicaMinimal.h"
 #include "UnicaSettings.h"
+#include "Timer/FramePacer.h"
 
 RenderWindow::RenderWindow()
 {
@@ -20,20 +20,15 @@ RenderWindow::RenderWindow()
     }
 
     SDL_SetWindowMinimumSize(m_SdlWindow, 260, 144);
+    UpdateWindowSizeInPixels();
 
-    UNICA_LOG_TRACE("SDL window created");
-}
-
-void RenderWindow::Tick()
-{
-    UNICA_PROFILE_FUNCTION
-    SDL_Event SdlEvent;
+    for (const SDL_EventType EventType : { SDL_EVENT_WINDOW_RESIZED, SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED, SDL_EVENT_WINDOW_MINIMIZED,
+        SDL_EVENT_WINDOW_RESTORED, SDL_EVENT_WINDOW_MAXIMIZED })
     {
-        UNICA_PROFILE_FUNCTION_NAMED("sdl::SDL_PollEvent");
-        SDL_PollEvent(&SdlEvent);
+        m_EventSubscriptions.push_back(InputManager::Subscribe(EventType, [this](const SDL_Event& Event) { HandleSdlEvent(Event); }));
     }
 
-    HandleSdlEvent(SdlEvent);
+    UNICA_LOG_TRACE("SDL window created");
 }
 
 void RenderWindow::HandleSdlEvent(const SDL_Event& Event)
@@ -44,39 +39,60 @@ void RenderWindow::HandleSdlEvent(const SDL_Event& Event)
     case SDL_EVENT_WINDOW_RESIZED:
     {
         UNICA_LOG_DEBUG("Window has been resized to {}x{}", Event.window.data1, Event.window.data2);
+        UpdateWindowSizeInPixels();
         m_bWindowResized = true;
         break;
     }    
+    case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+        UpdateWindowSizeInPixels();
+        m_bWindowResized = true;
+        break;
     case SDL_EVENT_WINDOW_MINIMIZED:
         UNICA_LOG_DEBUG("Window has been minimized");
         m_bWindowIsMinimized = true;
-        while (m_bWindowIsMinimized)
+        FramePacer::SetIdle(true);
+        break;
+    // Un-minimizing a maximized window only reports it as maximized again
+    case SDL_EVENT_WINDOW_RESTORED:
+    case SDL_EVENT_WINDOW_MAXIMIZED:
+        if (m_bWindowIsMinimized)
         {
-            SDL_Event WaitEvent;
-            {
-                UNICA_PROFILE_FUNCTION_NAMED("sdl::SDL_WaitEvent");
-                SDL_WaitEvent(&WaitEvent);
-            }
-            if (WaitEvent.type == SDL_EVENT_WINDOW_RESTORED)
-            {
-                UNICA_LOG_TRACE("Window has been restored");
-                m_bWindowIsMinimized = false;
-            }
+            UNICA_LOG_TRACE("Window has been restored");
+            m_bWindowIsMinimized = false;
+            FramePacer::SetIdle(false);
+
+            // The swap chain may have gone stale while nothing was presented
+            UpdateWindowSizeInPixels();
+            m_bWindowResized = true;
         }
-        
-        break;
-    case SDL_EVENT_QUIT:
-        UNICA_LOG_DEBUG("Window's close button (X) was pressed");
-        UnicaInstance::RequestExit();
         break;
     default:
         break;
     }
 }
 
+void RenderWindow::GetWindowSizeInPixels(int32& OutWidth, int32& OutHeight) const
+{
+    // Both dimensions are packed together so the render thread never sees half of a resize
+    const uint64 WindowSizeInPixels = m_WindowSizeInPixels.load(std::memory_order_acquire);
+    OutWidth = static_cast<int32>(WindowSizeInPixels >> 32);
+    OutHeight = static_cast<int32>(WindowSizeInPixels & UINT32_MAX);
+}
+
+void RenderWindow::UpdateWindowSizeInPixels()
+{
+    int32 Width, Height;
+    SDL_GetWindowSizeInPixels(m_SdlWindow, &Width, &Height);
+    m_WindowSizeInPixels.store(static_cast<uint64>(static_cast<uint32>(Width)) << 32 | static_cast<uint32>(Height), std::memory_order_release);
+}
+
 RenderWindow::~RenderWindow()
 {
     UNICA_LOG_TRACE("Destroying SDL window");
+    for (const InputSubscriptionHandle EventSubscription : m_EventSubscriptions)
+    {
+        InputManager::Unsubscribe(EventSubscription);
+    }
     SDL_DestroyWindow(m_SdlWindow);
     SDL_Quit();
 }
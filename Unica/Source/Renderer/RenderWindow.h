@@ -2,16 +2,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include "SDL3/SDL.h"
 
+#include "UnicaMinimal.h"
+#include "Input/InputManager.h"
+
 class RenderWindow
 {
 public:
     RenderWindow();
     ~RenderWindow();
 
-    void Tick();
-
     void HandleSdlEvent(const SDL_Event& Event);
 
     SDL_Window* GetSdlWindow() const { return m_SdlWindow; }
@@ -20,9 +24,22 @@ public:
 
     void SetWindowResized(const bool Value) { m_bWindowResized = Value; }
 
+    /** Whether the window was resized since the last call. Safe to call from the render thread */
+    bool ConsumeWindowResized() { return m_bWindowResized.exchange(false); }
+
+    /** Drawable size as of the last processed event. Safe to call from the render thread, unlike querying SDL */
+    void GetWindowSizeInPixels(int32& OutWidth, int32& OutHeight) const;
+
 private:
     SDL_Window* m_SdlWindow = nullptr;
     
-    bool m_bWindowResized = false;
+    // Written by the main thread while handling events, read by the render thread
+    std::atomic<bool> m_bWindowResized = false;
+    std::atomic<uint64> m_WindowSizeInPixels = 0;
+
     bool m_bWindowIsMinimized = false;
+
+    std::vector<InputSubscriptionHandle> m_EventSubscriptions;
+
+    void UpdateWindowSizeInPixels();
 };
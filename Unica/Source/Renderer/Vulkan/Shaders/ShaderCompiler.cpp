@@ -0,0 +1,281 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "ShaderCompiler.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+#include <fmt/format.h>
+#include <shaderc/shaderc.hpp>
+
+#include "UnicaFileUtilities.h"
+#include "UnicaHash.h"
+#include "IO/AsyncFileWriter.h"
+#include "IO/VirtualFileSystem.h"
+
+namespace
+{
+    // Bump whenever the key or the layout of cache files changes, old entries are then simply never hit again
+    constexpr uint32 CacheFormatVersion = 1;
+    constexpr uint32 CacheFileMagic = 0x43485355; // "USHC"
+    constexpr const char* CacheDirectory = "Engine:Saved/ShaderCache";
+
+    struct CacheFileHeader
+    {
+        uint32 Magic = CacheFileMagic;
+        uint32 Version = CacheFormatVersion;
+        uint64 CacheKey = 0;
+        uint32 IncludedFileCount = 0;
+        uint32 SpirvOffset = 0;
+        uint64 SpirvSize = 0;
+    };
+
+    shaderc_shader_kind GetShaderKind(const std::filesystem::path& SourcePath)
+    {
+        const std::filesystem::path FileExtension = SourcePath.extension();
+        if (FileExtension == ".vert")
+        {
+            return shaderc_vertex_shader;
+        }
+        if (FileExtension == ".frag")
+        {
+            return shaderc_fragment_shader;
+        }
+        if (FileExtension == ".comp")
+        {
+            return shaderc_compute_shader;
+        }
+        if (FileExtension == ".geom")
+        {
+            return shaderc_geometry_shader;
+        }
+        if (FileExtension == ".tesc")
+        {
+            return shaderc_tess_control_shader;
+        }
+        if (FileExtension == ".tese")
+        {
+            return shaderc_tess_evaluation_shader;
+        }
+        return shaderc_glsl_infer_from_source;
+    }
+
+    /** Owns an include's source for as long as shaderc reads it */
+    struct IncludeResult
+    {
+        shaderc_include_result Result { };
+        std::string SourceName;
+        std::string ErrorMessage;
+        UnicaMappedFile Source;
+    };
+
+    /** Resolves #include "File" next to the including file and #include <File> from Engine:Shaders, through the VirtualFileSystem */
+    class ShaderIncluder final : public shaderc::CompileOptions::IncluderInterface
+    {
+    public:
+        using IncludedFileCallback = std::function<void(const std::string& FilePath, std::span<const char> Source)>;
+
+        explicit ShaderIncluder(IncludedFileCallback OnIncludedFile) : m_OnIncludedFile(std::move(OnIncludedFile)) { }
+
+        shaderc_include_result* GetInclude(const char* RequestedSource, const shaderc_include_type IncludeType, const char* RequestingSource, size_t IncludeDepth) override
+        {
+            const std::filesystem::path IncludeDirectory = IncludeType == shaderc_include_type_relative
+                ? std::filesystem::path(RequestingSource).parent_path()
+                : UnicaFileUtilities::ResolveDirectory("Engine:Shaders");
+
+            std::unique_ptr<IncludeResult> Include = std::make_unique<IncludeResult>();
+            const std::string FilePath = (IncludeDirectory / RequestedSource).lexically_normal().generic_string();
+            Include->Source = UnicaFileUtilities::MapFile(FilePath);
+            if (Include->Source.IsValid())
+            {
+                Include->SourceName = FilePath;
+                m_OnIncludedFile(FilePath, Include->Source.GetView());
+            }
+            else
+            {
+                // shaderc reports an include failure as an empty source name, with the error as the content
+                Include->ErrorMessage = fmt::format("Can't find '{}' in '{}'", RequestedSource, IncludeDirectory.generic_string());
+            }
+
+            Include->Result.source_name = Include->SourceName.data();
+            Include->Result.source_name_length = Include->SourceName.size();
+            Include->Result.content = Include->Source.IsValid() ? Include->Source.GetData() : Include->ErrorMessage.data();
+            Include->Result.content_length = Include->Source.IsValid() ? Include->Source.GetSize() : Include->ErrorMessage.size();
+            Include->Result.user_data = Include.get();
+            return &Include.release()->Result;
+        }
+
+        void ReleaseInclude(shaderc_include_result* Result) override
+        {
+            delete static_cast<IncludeResult*>(Result->user_data);
+        }
+
+    private:
+        IncludedFileCallback m_OnIncludedFile;
+    };
+}
+
+UnicaMappedFile ShaderCompiler::Compile(const std::string& FileLocation, const ShaderCompileOptions& Options)
+{
+    UNICA_PROFILE_FUNCTION
+    const UnicaMappedFile Source = UnicaFileUtilities::MapFile(FileLocation);
+    if (!Source.IsValid())
+    {
+        return { };
+    }
+
+    const std::filesystem::path& SourcePath = UnicaFileUtilities::ResolveDirectory(FileLocation);
+    const uint64 CacheKey = ComputeCacheKey(SourcePath, Source.GetView(), Options);
+    UnicaMappedFile CachedShader = LoadCachedShader(CacheKey);
+    if (CachedShader.IsValid())
+    {
+        UNICA_LOG_TRACE("Shader '{}' is up to date in the shader cache", FileLocation);
+        return CachedShader;
+    }
+
+    UNICA_PROFILE_FUNCTION_NAMED("ShaderCompiler::CompileGlslToSpv");
+    std::vector<IncludedFile> IncludedFiles;
+    shaderc::CompileOptions CompileOptions;
+    CompileOptions.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+    CompileOptions.SetOptimizationLevel(Options.bOptimize ? shaderc_optimization_level_performance : shaderc_optimization_level_zero);
+    if (Options.bGenerateDebugInfo)
+    {
+        CompileOptions.SetGenerateDebugInfo();
+    }
+    for (const std::pair<std::string, std::string>& Define : Options.Defines)
+    {
+        CompileOptions.AddMacroDefinition(Define.first, Define.second);
+    }
+    CompileOptions.SetIncluder(std::make_unique<ShaderIncluder>([&IncludedFiles](const std::string& FilePath, const std::span<const char> IncludeSource)
+    {
+        IncludedFiles.push_back({ FilePath, UnicaHash::HashBytes(IncludeSource) });
+    }));
+
+    // One compiler per call, so shaders compiling on several workers at once share no state
+    const shaderc::Compiler Compiler;
+    const std::string SourceName = SourcePath.generic_string();
+    const shaderc::SpvCompilationResult Result = Compiler.CompileGlslToSpv(Source.GetData(), Source.GetSize(), GetShaderKind(SourcePath),
+        SourceName.c_str(), "main", CompileOptions);
+    if (Result.GetCompilationStatus() != shaderc_compilation_status_success)
+    {
+        UNICA_LOG_ERROR("Failed to compile shader '{}':\n{}", FileLocation, Result.GetErrorMessage());
+        return { };
+    }
+    if (Result.GetNumWarnings() > 0)
+    {
+        UNICA_LOG_WARN("Compiled shader '{}' with warnings:\n{}", FileLocation, Result.GetErrorMessage());
+    }
+
+    const std::span<const uint32> Spirv(Result.cbegin(), Result.cend());
+    StoreCachedShader(CacheKey, IncludedFiles, Spirv);
+    UNICA_LOG_DEBUG("Compiled shader '{}' to {} bytes of SPIR-V", FileLocation, Spirv.size_bytes());
+
+    const char* SpirvData = reinterpret_cast<const char*>(Spirv.data());
+    return UnicaMappedFile::FromBuffer(std::vector<char>(SpirvData, SpirvData + Spirv.size_bytes()));
+}
+
+uint64 ShaderCompiler::ComputeCacheKey(const std::filesystem::path& SourcePath, const std::span<const char> Source, const ShaderCompileOptions& Options)
+{
+    uint32 SpirvVersion = 0;
+    uint32 SpirvRevision = 0;
+    shaderc_get_spv_version(&SpirvVersion, &SpirvRevision);
+
+    uint64 Hash = UnicaHash::HashValue(CacheFormatVersion);
+    Hash = UnicaHash::HashValue(SpirvVersion, Hash);
+    Hash = UnicaHash::HashValue(SpirvRevision, Hash);
+    // The path decides the shader kind and where relative includes are looked up
+    Hash = UnicaHash::HashString(SourcePath.generic_string(), Hash);
+    Hash = UnicaHash::HashValue(Options.bOptimize, Hash);
+    Hash = UnicaHash::HashValue(Options.bGenerateDebugInfo, Hash);
+    for (const std::pair<std::string, std::string>& Define : Options.Defines)
+    {
+        Hash = UnicaHash::HashString(Define.first, Hash);
+        Hash = UnicaHash::HashString(Define.second, Hash);
+    }
+    return UnicaHash::HashBytes(Source, UnicaHash::HashValue(Source.size(), Hash));
+}
+
+std::filesystem::path ShaderCompiler::GetCacheFilePath(const uint64 CacheKey)
+{
+    return UnicaFileUtilities::ResolveDirectory(CacheDirectory) / fmt::format("{:016x}.spv", CacheKey);
+}
+
+UnicaMappedFile ShaderCompiler::LoadCachedShader(const uint64 CacheKey)
+{
+    UNICA_PROFILE_FUNCTION
+    const std::filesystem::path CacheFilePath = GetCacheFilePath(CacheKey);
+    std::error_code Error;
+    if (!std::filesystem::exists(CacheFilePath, Error))
+    {
+        return { };
+    }
+
+    // Anything unexpected is treated as a miss, the entry gets replaced by a fresh compile
+    const UnicaMappedFile CacheFile = UnicaMappedFile::Open(CacheFilePath);
+    CacheFileHeader Header;
+    if (CacheFile.GetSize() < sizeof(Header))
+    {
+        return { };
+    }
+    std::memcpy(&Header, CacheFile.GetData(), sizeof(Header));
+    if (Header.Magic != CacheFileMagic || Header.Version != CacheFormatVersion || Header.CacheKey != CacheKey
+        || Header.SpirvOffset > CacheFile.GetSize() || Header.SpirvSize > CacheFile.GetSize() - Header.SpirvOffset)
+    {
+        return { };
+    }
+
+    size_t Offset = sizeof(Header);
+    for (uint32 IncludeIndex = 0; IncludeIndex < Header.IncludedFileCount; IncludeIndex++)
+    {
+        uint64 ContentHash = 0;
+        uint32 PathSize = 0;
+        if (Offset + sizeof(ContentHash) + sizeof(PathSize) > Header.SpirvOffset)
+        {
+            return { };
+        }
+        std::memcpy(&ContentHash, CacheFile.GetData() + Offset, sizeof(ContentHash));
+        std::memcpy(&PathSize, CacheFile.GetData() + Offset + sizeof(ContentHash), sizeof(PathSize));
+        Offset += sizeof(ContentHash) + sizeof(PathSize);
+        if (Offset + PathSize > Header.SpirvOffset)
+        {
+            return { };
+        }
+
+        const std::string IncludePath(CacheFile.GetData() + Offset, PathSize);
+        Offset += PathSize;
+        if (!VirtualFileSystem::Exists(IncludePath) || UnicaHash::HashBytes(UnicaFileUtilities::MapFile(IncludePath).GetView()) != ContentHash)
+        {
+            return { };
+        }
+    }
+
+    return CacheFile.Slice(Header.SpirvOffset, Header.SpirvSize);
+}
+
+void ShaderCompiler::StoreCachedShader(const uint64 CacheKey, const std::vector<IncludedFile>& IncludedFiles, const std::span<const uint32> Spirv)
+{
+    std::vector<char> CacheFile(sizeof(CacheFileHeader));
+    for (const IncludedFile& Include : IncludedFiles)
+    {
+        const uint32 PathSize = static_cast<uint32>(Include.FilePath.size());
+        const size_t Offset = CacheFile.size();
+        CacheFile.resize(Offset + sizeof(Include.ContentHash) + sizeof(PathSize) + PathSize);
+        std::memcpy(CacheFile.data() + Offset, &Include.ContentHash, sizeof(Include.ContentHash));
+        std::memcpy(CacheFile.data() + Offset + sizeof(Include.ContentHash), &PathSize, sizeof(PathSize));
+        std::memcpy(CacheFile.data() + Offset + sizeof(Include.ContentHash) + sizeof(PathSize), Include.FilePath.data(), PathSize);
+    }
+
+    // Keep the SPIR-V word aligned, it's handed to Vulkan straight from the mapping
+    CacheFileHeader Header;
+    Header.CacheKey = CacheKey;
+    Header.IncludedFileCount = static_cast<uint32>(IncludedFiles.size());
+    Header.SpirvOffset = static_cast<uint32>((CacheFile.size() + alignof(uint64) - 1) & ~(alignof(uint64) - 1));
+    Header.SpirvSize = Spirv.size_bytes();
+    std::memcpy(CacheFile.data(), &Header, sizeof(Header));
+
+    CacheFile.resize(Header.SpirvOffset + Spirv.size_bytes());
+    std::memcpy(CacheFile.data() + Header.SpirvOffset, Spirv.data(), Spirv.size_bytes());
+    AsyncFileWriter::WriteFile(std::move(CacheFile), GetCacheFilePath(CacheKey).string());
+}
@@ -0,0 +1,49 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+
+struct ShaderCompileOptions
+{
+    // Name and value pairs, as if #defined at the top of the source
+    std::vector<std::pair<std::string, std::string>> Defines;
+    bool bOptimize = true;
+    bool bGenerateDebugInfo = false;
+
+    bool operator==(const ShaderCompileOptions& Other) const = default;
+};
+
+/**
+ * Compiles GLSL to SPIR-V with shaderc. Results are cached in Engine:Saved/ShaderCache under a hash of the source,
+ * its defines and the compiler options and version, along with the contents of every file it included, so a cache hit
+ * maps the SPIR-V straight from disk without compiling anything and an edited include is never served stale.
+ * Safe to call from any thread
+ */
+class ShaderCompiler
+{
+public:
+    /** @return SPIR-V of the shader at FileLocation, empty when it doesn't compile */
+    static UnicaMappedFile Compile(const std::string& FileLocation, const ShaderCompileOptions& Options = { });
+
+private:
+    struct IncludedFile
+    {
+        std::string FilePath;
+        uint64 ContentHash = 0;
+    };
+
+    static uint64 ComputeCacheKey(const std::filesystem::path& SourcePath, std::span<const char> Source, const ShaderCompileOptions& Options);
+    static std::filesystem::path GetCacheFilePath(uint64 CacheKey);
+
+    /** Cached SPIR-V for CacheKey, empty when there's none or one of its includes changed since */
+    static UnicaMappedFile LoadCachedShader(uint64 CacheKey);
+    static void StoreCachedShader(uint64 CacheKey, const std::vector<IncludedFile>& IncludedFiles, std::span<const uint32> Spirv);
+};
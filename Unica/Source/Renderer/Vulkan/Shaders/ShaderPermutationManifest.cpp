@@ -0,0 +1,135 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "ShaderPermutationManifest.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include <fmt/format.h>
+
+#include "UnicaFileUtilities.h"
+#include "Logging/Logger.h"
+
+namespace
+{
+    constexpr std::string_view ManifestHeader = "unica-shader-permutations 1";
+    constexpr std::string_view ManifestFileName = "Permutations.manifest";
+
+    /** Next whitespace separated field of Line, which is consumed up to its end */
+    std::string_view NextField(std::string_view& Line)
+    {
+        const size_t FieldBegin = std::min(Line.find_first_not_of(' '), Line.size());
+        const size_t FieldEnd = std::min(Line.find(' ', FieldBegin), Line.size());
+        const std::string_view Field = Line.substr(FieldBegin, FieldEnd - FieldBegin);
+        Line.remove_prefix(FieldEnd);
+        return Field;
+    }
+}
+
+std::mutex ShaderPermutationManifest::m_ManifestsMutex;
+std::unordered_map<std::string, ShaderPermutationManifest::ShaderPermutationsMap> ShaderPermutationManifest::m_Manifests;
+
+std::string ShaderPermutationManifest::FindPermutation(const std::string& FileLocation, const std::vector<std::pair<std::string, std::string>>& Defines)
+{
+    const size_t FileNameBegin = FileLocation.find_last_of("/:") + 1;
+    const std::string ManifestLocation = fmt::format("{}{}", std::string_view(FileLocation).substr(0, FileNameBegin), ManifestFileName);
+    const std::string FileName = FileLocation.substr(FileNameBegin);
+
+    const std::lock_guard ManifestsLock(m_ManifestsMutex);
+    const ShaderPermutationsMap& Manifest = LoadManifest(ManifestLocation);
+    const ShaderPermutationsMap::const_iterator Permutations = Manifest.find(FileName);
+    if (Permutations == Manifest.end())
+    {
+        UNICA_LOG_ERROR("Shader '{}' isn't in '{}', was UnicaBuildTool run?", FileLocation, ManifestLocation);
+        return { };
+    }
+
+    uint32 Mask = 0;
+    for (const std::pair<std::string, std::string>& Define : Defines)
+    {
+        const std::vector<std::string>& Features = Permutations->second.Features;
+        const std::vector<std::string>::const_iterator Feature = std::find(Features.begin(), Features.end(), Define.first);
+        if (Feature == Features.end())
+        {
+            UNICA_LOG_ERROR("'{}' isn't a feature of shader '{}', declare it with '// @feature {}'", Define.first, FileLocation, Define.first);
+            return { };
+        }
+
+        if (Define.second != "0")
+        {
+            Mask |= 1u << static_cast<uint32>(Feature - Features.begin());
+        }
+    }
+
+    if (!Permutations->second.CompiledMasks.contains(Mask))
+    {
+        UNICA_LOG_ERROR("Permutation {:x} of shader '{}' wasn't compiled", Mask, FileLocation);
+        return { };
+    }
+    return Mask == 0 ? FileLocation + ".spv" : fmt::format("{}.{:x}.spv", FileLocation, Mask);
+}
+
+const ShaderPermutationManifest::ShaderPermutationsMap& ShaderPermutationManifest::LoadManifest(const std::string& ManifestLocation)
+{
+    const std::unordered_map<std::string, ShaderPermutationsMap>::const_iterator LoadedManifest = m_Manifests.find(ManifestLocation);
+    if (LoadedManifest != m_Manifests.end())
+    {
+        return LoadedManifest->second;
+    }
+
+    // A missing or broken manifest is remembered as an empty one, and not read again for every shader
+    ShaderPermutationsMap& Permutations = m_Manifests[ManifestLocation];
+    const UnicaMappedFile Manifest = UnicaFileUtilities::MapFile(ManifestLocation);
+    if (!Manifest.IsEmpty() && !ParseManifest(Manifest.GetStringView(), Permutations))
+    {
+        UNICA_LOG_ERROR("Shader permutation manifest '{}' is malformed", ManifestLocation);
+        Permutations.clear();
+    }
+    return Permutations;
+}
+
+bool ShaderPermutationManifest::ParseManifest(std::string_view Manifest, ShaderPermutationsMap& OutPermutations)
+{
+    ShaderPermutations* CurrentShader = nullptr;
+    bool bIsHeader = true;
+    while (!Manifest.empty())
+    {
+        const size_t LineEnd = std::min(Manifest.find('\n'), Manifest.size());
+        std::string_view Line = Manifest.substr(0, LineEnd);
+        Manifest.remove_prefix(std::min(LineEnd + 1, Manifest.size()));
+        if (!Line.empty() && Line.back() == '\r')
+        {
+            Line.remove_suffix(1);
+        }
+
+        if (bIsHeader)
+        {
+            if (Line != ManifestHeader)
+            {
+                return false;
+            }
+            bIsHeader = false;
+            continue;
+        }
+
+        // "<shader> <features>...", followed by " <mask> <content hash>" for each compiled permutation
+        if (!Line.starts_with(' '))
+        {
+            CurrentShader = &OutPermutations[std::string(NextField(Line))];
+            for (std::string_view Feature = NextField(Line); !Feature.empty(); Feature = NextField(Line))
+            {
+                CurrentShader->Features.emplace_back(Feature);
+            }
+            continue;
+        }
+
+        const std::string_view MaskField = NextField(Line);
+        uint32 Mask = 0;
+        if (!CurrentShader || std::from_chars(MaskField.data(), MaskField.data() + MaskField.size(), Mask, 16).ec != std::errc())
+        {
+            return false;
+        }
+        CurrentShader->CompiledMasks.insert(Mask);
+    }
+    return !bIsHeader;
+}
@@ -0,0 +1,47 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "UnicaMinimal.h"
+
+/**
+ * Permutations.manifest, written by UnicaBuildTool next to the shaders it precompiles. Lists the features each shader
+ * declares and which of its permutations were compiled, each to '<shader>.<mask>.spv' with one mask bit per feature in
+ * declaration order, or to '<shader>.spv' when none is enabled.
+ * Manifests are read once, a rerun of the tool shows up on the next launch
+ */
+class ShaderPermutationManifest
+{
+public:
+    /**
+     * Unica path of the precompiled SPIR-V of FileLocation for Defines, a feature being enabled by a define whose
+     * value isn't "0". Any thread
+     * @return Empty when a define isn't one of the shader's features or its permutation wasn't compiled
+     */
+    static std::string FindPermutation(const std::string& FileLocation, const std::vector<std::pair<std::string, std::string>>& Defines);
+
+private:
+    struct ShaderPermutations
+    {
+        std::vector<std::string> Features;
+        std::unordered_set<uint32> CompiledMasks;
+    };
+
+    // Keyed by shader file name
+    using ShaderPermutationsMap = std::unordered_map<std::string, ShaderPermutations>;
+
+    /** Empty when there's no manifest or it can't be parsed. Call with m_ManifestsMutex held */
+    static const ShaderPermutationsMap& LoadManifest(const std::string& ManifestLocation);
+    static bool ParseManifest(std::string_view Manifest, ShaderPermutationsMap& OutPermutations);
+
+    static std::mutex m_ManifestsMutex;
+    static std::unordered_map<std::string, ShaderPermutationsMap> m_Manifests;
+};
@@ -9,18 +9,55 @@
 #include <fmt/format.h>
 #include <shaderc/shaderc.hpp>
 
+#include "ShaderCompiler.h"
+#include "ShaderPermutationManifest.h"
 #include "UnicaFileUtilities.h"
+#include "UnicaSettings.h"
+#include "IO/VirtualFileSystem.h"
+#include "Jobs/JobSystem.h"
 #include "Logging/Logger.h"
 
-std::vector<char> ShaderUtilities::LoadShader(const std::string& FileLocation)
+UnicaMappedFile ShaderUtilities::LoadShader(const std::string& FileLocation, const ShaderCompileOptions& Options)
 {
-    const std::string SpvFileName = FileLocation + ".spv";
-    std::vector<char> SpvShaderBinary = UnicaFileUtilities::ReadFileAsBinary(SpvFileName);
+    UNICA_PROFILE_FUNCTION
+    // The source is what's current, a .spv next to it may predate the last edit
+    if (UnicaSettings::bCompileShaders && VirtualFileSystem::Exists(UnicaFileUtilities::ResolveDirectory(FileLocation)))
+    {
+        UnicaMappedFile CompiledShader = ShaderCompiler::Compile(FileLocation, Options);
+        if (!CompiledShader.IsEmpty())
+        {
+            return CompiledShader;
+        }
+        UNICA_LOG_WARN("Falling back to the precompiled SPIR-V of shader '{}'", FileLocation);
+    }
+
+    // Permutations are looked up in the manifest UnicaBuildTool writes along with them
+    const std::string SpvFileName = Options.Defines.empty() ? FileLocation + ".spv" : ShaderPermutationManifest::FindPermutation(FileLocation, Options.Defines);
+    if (SpvFileName.empty())
+    {
+        return { };
+    }
 
-    if (SpvShaderBinary.empty())
+    UnicaMappedFile SpvShaderBinary = UnicaFileUtilities::MapFile(SpvFileName);
+
+    if (SpvShaderBinary.IsEmpty())
     {
-        UNICA_LOG(spdlog::level::level_enum::err, fmt::format("Shader '{}' may not be compiled", FileLocation));
+        UNICA_LOG(spdlog::level::level_enum::err, "Shader '{}' may not be compiled", FileLocation);
     }
     
     return SpvShaderBinary;
 }
+
+std::vector<UnicaMappedFile> ShaderUtilities::LoadShaders(const std::vector<std::string>& FileLocations, const ShaderCompileOptions& Options)
+{
+    UNICA_PROFILE_FUNCTION
+    std::vector<UnicaMappedFile> Shaders(FileLocations.size());
+    JobSystem::ParallelFor("LoadShaders", static_cast<uint32>(FileLocations.size()), 1, [&FileLocations, &Options, &Shaders](const uint32 Begin, const uint32 End)
+    {
+        for (uint32 ShaderIndex = Begin; ShaderIndex < End; ShaderIndex++)
+        {
+            Shaders[ShaderIndex] = LoadShader(FileLocations[ShaderIndex], Options);
+        }
+    });
+    return Shaders;
+}
@@ -3,13 +3,26 @@
 #pragma once
 
 #include <filesystem>
+#include <string>
+#include <vector>
+
 #include <shaderc/shaderc.h>
 
 #include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+#include "ShaderCompiler.h"
 
 class ShaderUtilities
 {
 public:
-    static std::vector<char> LoadShader(const std::string& FileLocation);
-    
+    /**
+     * SPIR-V of a shader, compiled from its GLSL source through the shader cache when there is one, see ShaderCompiler.
+     * Falls back to the precompiled .spv next to it, or for Defines to the permutation UnicaBuildTool compiled for them,
+     * see ShaderPermutationManifest.
+     * Keep the view alive for as long as the code is read
+     */
+    static UnicaMappedFile LoadShader(const std::string& FileLocation, const ShaderCompileOptions& Options = { });
+    /** Same as LoadShader for several shaders, compiled in parallel on the job workers. Results keep the order of FileLocations */
+    static std::vector<UnicaMappedFile> LoadShaders(const std::vector<std::string>& FileLocations, const ShaderCompileOptions& Options = { });
+
 };
@@ -8,13 +8,14 @@
 #include <vector>
 
 #include "UnicaFileUtilities.h"
-#include "UnicaInstance.h"
 #include "fmt/format.h"
 #include "shaderc/shaderc.hpp"
 
 #include "UnicaMinimal.h"
 #include "VulkanQueueFamilyIndices.h"
+#include "Memory/FrameArena.h"
 #include "Shaders/ShaderUtilities.h"
+#include "Timer/FrameStatistics.h"
 
 void VulkanInterface::Init()
 {
@@ -22,10 +23,13 @@ void VulkanInterface::Init()
 	m_VulkanWindowSurface->Init();
 	m_VulkanPhysicalDevice->Init();
 	m_VulkanLogicalDevice->Init();
+	m_VulkanMemoryAllocator->Init();
+	m_VulkanPipelineCache->Init();
 	m_VulkanSwapChain->Init();
 	InitVulkanImageViews();
 	m_VulkanRenderPass->Init();
-	m_VulkanPipeline->Init();
+	m_VulkanPipelineStateCache->Init();
+	InitHardcodedPipeline();
 	InitVulkanFramebuffers();
 	m_VulkanCommandPool->Init();
 	m_VulkanVertexBuffer->Init();
@@ -38,13 +42,14 @@ void VulkanInterface::Init()
 void VulkanInterface::Tick()
 {
 	UNICA_PROFILE_FUNCTION
-	m_SdlRenderWindow->Tick();
-	DrawFrame();
+	m_VulkanPipelineStateCache->Tick();
+	m_VulkanMemoryAllocator->Tick();
+}
 
-	if (UnicaInstance::HasRequestedExit())
-	{
-		vkDeviceWaitIdle(m_VulkanLogicalDevice->GetVulkanObject());
-	}
+void VulkanInterface::RenderFrame()
+{
+	UNICA_PROFILE_FUNCTION
+	DrawFrame();
 }
 
 void VulkanInterface::DrawFrame()
@@ -52,8 +57,12 @@ void VulkanInterface::DrawFrame()
 	UNICA_PROFILE_FUNCTION
 	{
 		UNICA_PROFILE_FUNCTION_NAMED("vulkan::vkWaitForFences");
+		const std::chrono::time_point StartWaitTime = std::chrono::steady_clock::now();
 		vkWaitForFences(m_VulkanLogicalDevice->GetVulkanObject(), 1, &m_FencesInFlight[m_CurrentFrameIndex], VK_TRUE, UINT64_MAX);
+		FrameStatistics::AddGpuWaitTime(std::chrono::steady_clock::now() - StartWaitTime);
 	}
+	// A frame boundary, the only point a rebuilt pipeline can be swapped in without waiting on the device
+	m_VulkanPipelineStateCache->BeginFrame(m_CurrentFrameIndex);
 	uint32 VulkanImageIndex;
 	{
 		UNICA_PROFILE_FUNCTION_NAMED("vulkan::vkAcquireNextImageKHR");
@@ -112,9 +121,8 @@ void VulkanInterface::DrawFrame()
 		UNICA_PROFILE_FUNCTION_NAMED("vulkan::vkQueuePresentKHR");
 		const VkResult QueuePresentResult = vkQueuePresentKHR(m_VulkanLogicalDevice->GetVulkanPresentImagesQueue(), &VulkanPresentInfo);
 
-		if (QueuePresentResult == VK_ERROR_OUT_OF_DATE_KHR || QueuePresentResult == VK_SUBOPTIMAL_KHR || m_SdlRenderWindow->GetWindowResized())
+		if (QueuePresentResult == VK_ERROR_OUT_OF_DATE_KHR || QueuePresentResult == VK_SUBOPTIMAL_KHR || m_SdlRenderWindow->ConsumeWindowResized())
 		{
-			m_SdlRenderWindow->SetWindowResized(false);
 			RecreateSwapChainObjects();
 		}
 		else if (QueuePresentResult != VK_SUCCESS)
@@ -126,6 +134,16 @@ void VulkanInterface::DrawFrame()
 	m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % m_MaxFramesInFlight;
 }
 
+void VulkanInterface::InitHardcodedPipeline()
+{
+	// Compiled up front, there'd be nothing to fall back to while it compiles
+	m_HardcodedPipelineDescription.RenderPass = m_VulkanRenderPass->GetVulkanObject();
+	if (m_VulkanPipelineStateCache->WaitForPipeline(m_HardcodedPipelineDescription) == VK_NULL_HANDLE)
+	{
+		UNICA_LOG_CRITICAL("Failed to create the VulkanPipeline for the hardcoded geometry");
+	}
+}
+
 void VulkanInterface::InitVulkanImageViews()
 {
 	uint32 SwapChainImageIteration = 0;
@@ -198,7 +216,7 @@ VulkanQueueFamilyIndices VulkanInterface::GetDeviceQueueFamilies(const VkPhysica
 	uint32 QueueFamilyCount = 0;
 	vkGetPhysicalDeviceQueueFamilyProperties(VulkanPhysicalDevice, &QueueFamilyCount, nullptr);
 
-	std::vector<VkQueueFamilyProperties> QueueFamilies(QueueFamilyCount);
+	std::pmr::vector<VkQueueFamilyProperties> QueueFamilies(QueueFamilyCount, FrameArena::GetMemoryResource());
 	vkGetPhysicalDeviceQueueFamilyProperties(VulkanPhysicalDevice, &QueueFamilyCount, QueueFamilies.data());
 
 	uint32 QueueFamilyIndex = 0;
@@ -282,12 +300,15 @@ void VulkanInterface::DestroySwapChainObjects()
 
 void VulkanInterface::Shutdown()
 {
+	vkDeviceWaitIdle(m_VulkanLogicalDevice->GetVulkanObject());
 	DestroySwapChainObjects();
 	m_VulkanVertexBuffer->Destroy();
 	DestroySyncObjects();
 	m_VulkanCommandPool->Destroy();	
-	m_VulkanPipeline->Destroy();
+	m_VulkanPipelineStateCache->Destroy();
 	m_VulkanRenderPass->Destroy();	
+	m_VulkanPipelineCache->Destroy();
+	m_VulkanMemoryAllocator->Destroy();
 	m_VulkanLogicalDevice->Destroy();
 	m_VulkanWindowSurface->Destroy();
 	m_VulkanInstance->Destroy();
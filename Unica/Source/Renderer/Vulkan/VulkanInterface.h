@@ -6,6 +6,7 @@
 #include <vulkan/vulkan_core.h>
 
 #include "UnicaMinimal.h"
+#include "UnicaSettings.h"
 #include "Renderer/RenderWindow.h"
 #include "VulkanSwapChainSupportDetails.h"
 #include "VulkanVertex.h"
@@ -18,7 +19,10 @@
 #include "VulkanTypes/VulkanCommandPool.h"
 #include "VulkanTypes/VulkanFramebuffer.h"
 #include "VulkanTypes/VulkanImageView.h"
-#include "VulkanTypes/VulkanPipeline.h"
+#include "VulkanTypes/VulkanMemoryAllocator.h"
+#include "VulkanPipelineDescription.h"
+#include "VulkanTypes/VulkanPipelineCache.h"
+#include "VulkanTypes/VulkanPipelineStateCache.h"
 #include "VulkanTypes/VulkanRenderPass.h"
 #include "VulkanTypes/VulkanSwapChain.h"
 #include "VulkanTypes/VulkanVertexBuffer.h"
@@ -32,6 +36,7 @@ class VulkanInterface : public RenderInterface
 public:
 	void Init() override;
 	void Tick() override;
+	void RenderFrame() override;
 	void Shutdown() override;
 
 	RenderWindow* GetSdlRenderWindow() const { return m_SdlRenderWindow.get(); }
@@ -39,9 +44,11 @@ public:
 	VulkanWindowSurface* GetVulkanWindowSurface() const { return m_VulkanWindowSurface.get(); }
 	VulkanPhysicalDevice* GetVulkanPhysicalDevice() const { return m_VulkanPhysicalDevice.get(); }
 	VulkanLogicalDevice* GetVulkanLogicalDevice() const { return m_VulkanLogicalDevice.get(); }
+	VulkanMemoryAllocator* GetVulkanMemoryAllocator() const { return m_VulkanMemoryAllocator.get(); }
 	VulkanSwapChain* GetVulkanSwapChain() const { return m_VulkanSwapChain.get(); }
 	VulkanRenderPass* GetVulkanRenderPass() const { return m_VulkanRenderPass.get(); }
-	VulkanPipeline* GetVulkanPipeline() const { return m_VulkanPipeline.get(); }
+	VulkanPipelineCache* GetVulkanPipelineCache() const { return m_VulkanPipelineCache.get(); }
+	VulkanPipelineStateCache* GetVulkanPipelineStateCache() const { return m_VulkanPipelineStateCache.get(); }
 	VulkanCommandPool* GetVulkanCommandPool() const { return m_VulkanCommandPool.get(); }
 	VulkanVertexBuffer* GetVulkanVertexBuffer() const { return m_VulkanVertexBuffer.get(); }
 	
@@ -59,11 +66,13 @@ public:
 
 	const std::vector<VulkanVertex>& GetHardcodedVertices() const { return m_HardcodedVertices; }
 	const std::vector<uint16>& GetHardcodedIndices() const { return m_HardcodedIndices; }
+	const VulkanPipelineDescription& GetHardcodedPipelineDescription() const { return m_HardcodedPipelineDescription; }
 
 
 private:
 	void DrawFrame();
 	
+	void InitHardcodedPipeline();
 	void InitVulkanImageViews();
 	void InitVulkanFramebuffers();
 	void InitSyncObjects();
@@ -77,9 +86,11 @@ private:
 	std::unique_ptr<VulkanWindowSurface> m_VulkanWindowSurface = std::make_unique<VulkanWindowSurface>(this);
 	std::unique_ptr<VulkanPhysicalDevice> m_VulkanPhysicalDevice = std::make_unique<VulkanPhysicalDevice>(this);
 	std::unique_ptr<VulkanLogicalDevice> m_VulkanLogicalDevice = std::make_unique<VulkanLogicalDevice>(this);
+	std::unique_ptr<VulkanMemoryAllocator> m_VulkanMemoryAllocator = std::make_unique<VulkanMemoryAllocator>(this);
 	std::unique_ptr<VulkanSwapChain> m_VulkanSwapChain = std::make_unique<VulkanSwapChain>(this);
 	std::unique_ptr<VulkanRenderPass> m_VulkanRenderPass = std::make_unique<VulkanRenderPass>(this);
-	std::unique_ptr<VulkanPipeline> m_VulkanPipeline = std::make_unique<VulkanPipeline>(this);
+	std::unique_ptr<VulkanPipelineCache> m_VulkanPipelineCache = std::make_unique<VulkanPipelineCache>(this);
+	std::unique_ptr<VulkanPipelineStateCache> m_VulkanPipelineStateCache = std::make_unique<VulkanPipelineStateCache>(this);
 	std::unique_ptr<VulkanCommandPool> m_VulkanCommandPool = std::make_unique<VulkanCommandPool>(this);
 	std::unique_ptr<VulkanCommandBuffer> m_VulkanCommandBuffer = std::make_unique<VulkanCommandBuffer>(this);
 	std::unique_ptr<VulkanVertexBuffer> m_VulkanVertexBuffer = std::make_unique<VulkanVertexBuffer>(this);
@@ -99,7 +110,7 @@ private:
     };
 	const std::vector<const char*> m_RequestedValidationLayers = { "VK_LAYER_KHRONOS_validation" };
 
-	const uint8 m_MaxFramesInFlight = 2;
+	const uint8 m_MaxFramesInFlight = UnicaSettings::MaxFramesInFlight;
 	uint8 m_CurrentFrameIndex = 0;
 
 	const std::vector<VulkanVertex> m_HardcodedVertices = {
@@ -113,6 +124,9 @@ private:
 		0, 1, 2, 2, 3, 0
 	};
 
+	// The engine's shaders with the VulkanVertex layout, its render pass is filled in once created
+	VulkanPipelineDescription m_HardcodedPipelineDescription;
+
 private:
 #if UNICA_SHIPPING
 	const bool m_bValidationLayersEnabled = false;
@@ -0,0 +1,63 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "VulkanPipelineDescription.h"
+
+#include <algorithm>
+#include <array>
+
+#include "UnicaHash.h"
+#include "VulkanVertex.h"
+
+VulkanPipelineDescription::VulkanPipelineDescription()
+{
+    VertexBinding = VulkanVertex::GetBindingDescription();
+    const std::array<VkVertexInputAttributeDescription, 2> VertexAttributeDescriptions = VulkanVertex::GetAttributeDescriptions();
+    VertexAttributes.assign(VertexAttributeDescriptions.begin(), VertexAttributeDescriptions.end());
+}
+
+uint64 VulkanPipelineDescription::GetHash() const
+{
+    uint64 Hash = UnicaHash::HashString(VertexShader);
+    Hash = UnicaHash::HashString(FragmentShader, Hash);
+    for (const std::pair<std::string, std::string>& Define : ShaderOptions.Defines)
+    {
+        Hash = UnicaHash::HashString(Define.first, Hash);
+        Hash = UnicaHash::HashString(Define.second, Hash);
+    }
+    Hash = UnicaHash::HashValue(ShaderOptions.bOptimize, Hash);
+    Hash = UnicaHash::HashValue(ShaderOptions.bGenerateDebugInfo, Hash);
+
+    Hash = UnicaHash::HashValue(VertexBinding.binding, Hash);
+    Hash = UnicaHash::HashValue(VertexBinding.stride, Hash);
+    Hash = UnicaHash::HashValue(VertexBinding.inputRate, Hash);
+    for (const VkVertexInputAttributeDescription& VertexAttribute : VertexAttributes)
+    {
+        Hash = UnicaHash::HashValue(VertexAttribute.location, Hash);
+        Hash = UnicaHash::HashValue(VertexAttribute.binding, Hash);
+        Hash = UnicaHash::HashValue(VertexAttribute.format, Hash);
+        Hash = UnicaHash::HashValue(VertexAttribute.offset, Hash);
+    }
+
+    Hash = UnicaHash::HashValue(RenderPass, Hash);
+    Hash = UnicaHash::HashValue(Subpass, Hash);
+    Hash = UnicaHash::HashValue(Topology, Hash);
+    Hash = UnicaHash::HashValue(PolygonMode, Hash);
+    Hash = UnicaHash::HashValue(CullMode, Hash);
+    Hash = UnicaHash::HashValue(FrontFace, Hash);
+    return UnicaHash::HashValue(bAlphaBlend, Hash);
+}
+
+bool VulkanPipelineDescription::operator==(const VulkanPipelineDescription& Other) const
+{
+    const bool bSameVertexLayout = VertexBinding.binding == Other.VertexBinding.binding && VertexBinding.stride == Other.VertexBinding.stride
+        && VertexBinding.inputRate == Other.VertexBinding.inputRate
+        && std::equal(VertexAttributes.begin(), VertexAttributes.end(), Other.VertexAttributes.begin(), Other.VertexAttributes.end(),
+            [](const VkVertexInputAttributeDescription& Left, const VkVertexInputAttributeDescription& Right)
+            {
+                return Left.location == Right.location && Left.binding == Right.binding && Left.format == Right.format && Left.offset == Right.offset;
+            });
+
+    return bSameVertexLayout && VertexShader == Other.VertexShader && FragmentShader == Other.FragmentShader && ShaderOptions == Other.ShaderOptions
+        && RenderPass == Other.RenderPass && Subpass == Other.Subpass && Topology == Other.Topology && PolygonMode == Other.PolygonMode
+        && CullMode == Other.CullMode && FrontFace == Other.FrontFace && bAlphaBlend == Other.bAlphaBlend;
+}
@@ -0,0 +1,46 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "vulkan/vulkan_core.h"
+
+#include "UnicaMinimal.h"
+#include "Renderer/Vulkan/Shaders/ShaderCompiler.h"
+
+/**
+ * Everything a graphics pipeline is built from, which makes it the key of its variant in VulkanPipelineStateCache.
+ * Defaults to the engine's hardcoded shaders and VulkanVertex layout, the render pass has to be filled in
+ */
+struct VulkanPipelineDescription
+{
+    VulkanPipelineDescription();
+
+    std::string VertexShader = "Engine:Shaders/shader.vert";
+    std::string FragmentShader = "Engine:Shaders/shader.frag";
+    // Both stages are compiled with the same options, their defines pick the permutation
+    ShaderCompileOptions ShaderOptions;
+
+    VkVertexInputBindingDescription VertexBinding { };
+    std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+
+    VkRenderPass RenderPass = VK_NULL_HANDLE;
+    uint32 Subpass = 0;
+
+    VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode PolygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags CullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace FrontFace = VK_FRONT_FACE_CLOCKWISE;
+    bool bAlphaBlend = false;
+
+    /** Hashes every field, keep it in sync with operator== when adding one */
+    uint64 GetHash() const;
+    bool operator==(const VulkanPipelineDescription& Other) const;
+
+    struct Hasher
+    {
+        size_t operator()(const VulkanPipelineDescription& Description) const { return static_cast<size_t>(Description.GetHash()); }
+    };
+};
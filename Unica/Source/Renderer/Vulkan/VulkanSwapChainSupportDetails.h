@@ -2,9 +2,15 @@
 
 #pragma once
 
+#include <memory_resource>
+#include <vector>
+
+#include "Memory/FrameArena.h"
+
+/** Allocated from the FrameArena, don't keep it beyond the current frame */
 struct VulkanSwapChainSupportDetails
 {
     VkSurfaceCapabilitiesKHR SurfaceCapabilities;
-    std::vector<VkSurfaceFormatKHR> SurfaceFormats;
-    std::vector<VkPresentModeKHR> PresentModes;
+    std::pmr::vector<VkSurfaceFormatKHR> SurfaceFormats { FrameArena::GetMemoryResource() };
+    std::pmr::vector<VkPresentModeKHR> PresentModes { FrameArena::GetMemoryResource() };
 };
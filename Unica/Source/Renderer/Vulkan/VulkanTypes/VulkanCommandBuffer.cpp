@@ -46,28 +46,33 @@ void VulkanCommandBuffer::Record(uint8 VulkanCommandBufferIndex, uint32 VulkanIm
     RenderPassBeginInfo.pClearValues = &ClearColor;
 
     vkCmdBeginRenderPass(m_VulkanCommandBuffers[VulkanCommandBufferIndex], &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(m_VulkanCommandBuffers[VulkanCommandBufferIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_OwningVulkanAPI->GetVulkanPipeline()->GetVulkanObject());
+    // Skipped while its pipeline variant compiles, the frame is still cleared and presented
+    const VkPipeline Pipeline = m_OwningVulkanAPI->GetVulkanPipelineStateCache()->FindPipeline(m_OwningVulkanAPI->GetHardcodedPipelineDescription());
+    if (Pipeline != VK_NULL_HANDLE)
+    {
+        vkCmdBindPipeline(m_VulkanCommandBuffers[VulkanCommandBufferIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline);
 
-    VkViewport Viewport { };
-    Viewport .x = 0.0f;
-    Viewport .y = 0.0f;
-    Viewport .width = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().width);
-    Viewport .height = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().height);
-    Viewport .minDepth = 0.0f;
-    Viewport .maxDepth = 1.0f;
-    vkCmdSetViewport(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, &Viewport );
+        VkViewport Viewport { };
+        Viewport .x = 0.0f;
+        Viewport .y = 0.0f;
+        Viewport .width = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().width);
+        Viewport .height = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().height);
+        Viewport .minDepth = 0.0f;
+        Viewport .maxDepth = 1.0f;
+        vkCmdSetViewport(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, &Viewport );
 
-    VkRect2D Scissor{};
-    Scissor.offset = {0, 0};
-    Scissor.extent = m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent();
-    vkCmdSetScissor(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, &Scissor);
+        VkRect2D Scissor{};
+        Scissor.offset = {0, 0};
+        Scissor.extent = m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent();
+        vkCmdSetScissor(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, &Scissor);
 
-    VkBuffer VulkanVertexBuffers[] = { m_OwningVulkanAPI->GetVulkanVertexBuffer()->m_VulkanObject };
-    VkDeviceSize DeviceOffsets[] = { 0 };
-    vkCmdBindVertexBuffers(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, VulkanVertexBuffers, DeviceOffsets);
-    vkCmdBindIndexBuffer(m_VulkanCommandBuffers[VulkanCommandBufferIndex], m_OwningVulkanAPI->GetVulkanVertexBuffer()->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
+        VkBuffer VulkanVertexBuffers[] = { m_OwningVulkanAPI->GetVulkanVertexBuffer()->m_VulkanObject };
+        VkDeviceSize DeviceOffsets[] = { 0 };
+        vkCmdBindVertexBuffers(m_VulkanCommandBuffers[VulkanCommandBufferIndex], 0, 1, VulkanVertexBuffers, DeviceOffsets);
+        vkCmdBindIndexBuffer(m_VulkanCommandBuffers[VulkanCommandBufferIndex], m_OwningVulkanAPI->GetVulkanVertexBuffer()->GetIndexBuffer(), 0, VK_INDEX_TYPE_UINT16);
 
-    vkCmdDrawIndexed(m_VulkanCommandBuffers[VulkanCommandBufferIndex], static_cast<uint32>(m_OwningVulkanAPI->GetHardcodedIndices().size()), 1, 0, 0, 0);
+        vkCmdDrawIndexed(m_VulkanCommandBuffers[VulkanCommandBufferIndex], static_cast<uint32>(m_OwningVulkanAPI->GetHardcodedIndices().size()), 1, 0, 0, 0);
+    }
     vkCmdEndRenderPass(m_VulkanCommandBuffers[VulkanCommandBufferIndex]);
     if (vkEndCommandBuffer(m_VulkanCommandBuffers[VulkanCommandBufferIndex]) != VK_SUCCESS)
     {
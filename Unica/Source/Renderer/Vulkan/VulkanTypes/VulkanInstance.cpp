@@ -77,7 +77,7 @@ void VulkanInstance::AddRequiredExtensions(VkInstanceCreateInfo& VulkanCreateInf
         }
         if (!bWasExtensionFound)
         {
-            UNICA_LOG(spdlog::level::err, fmt::format("Graphic instance extension \"{}\" not found", RequiredExtensionName));
+            UNICA_LOG(spdlog::level::err, "Graphic instance extension \"{}\" not found", RequiredExtensionName);
             bAllExtensionsFound = false;
         }
     }
@@ -118,7 +118,7 @@ void VulkanInstance::AddValidationLayers(VkInstanceCreateInfo& VulkanCreateInfo,
         }
         if (!bWasLayerFound)
         {
-            UNICA_LOG(spdlog::level::err, fmt::format("VulkanValidationLayer \"{}\" not found", RequestedLayerName));
+            UNICA_LOG(spdlog::level::err, "VulkanValidationLayer \"{}\" not found", RequestedLayerName);
             bAllLayersFound = false;
         }
     }
@@ -186,11 +186,11 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VulkanInstance::VulkanDebugCallback(VkDebugUtilsM
 {
     if ((MessageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) == VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
     {
-        UNICA_LOG_WARN(CallbackData->pMessage);
+        UNICA_LOG_WARN("{}", CallbackData->pMessage);
     }
     else if ((MessageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) == VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
     {
-        UNICA_LOG_ERROR(CallbackData->pMessage);
+        UNICA_LOG_ERROR("{}", CallbackData->pMessage);
     }
 
     return VK_FALSE;
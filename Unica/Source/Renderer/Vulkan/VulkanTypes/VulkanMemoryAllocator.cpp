@@ -0,0 +1,359 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "VulkanMemoryAllocator.h"
+
+#include <algorithm>
+
+#include "UnicaSettings.h"
+#include "Logging/Logger.h"
+#include "Renderer/Vulkan/VulkanInterface.h"
+
+namespace
+{
+    constexpr VkDeviceSize AlignUp(const VkDeviceSize Value, const VkDeviceSize Alignment)
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    constexpr double ToMebibytes(const VkDeviceSize Bytes)
+    {
+        return static_cast<double>(Bytes) / (1024 * 1024);
+    }
+}
+
+void VulkanMemoryAllocator::Init()
+{
+    vkGetPhysicalDeviceMemoryProperties(m_OwningVulkanAPI->GetVulkanPhysicalDevice()->GetVulkanObject(), &m_MemoryProperties);
+
+    VkPhysicalDeviceProperties PhysicalDeviceProperties { };
+    vkGetPhysicalDeviceProperties(m_OwningVulkanAPI->GetVulkanPhysicalDevice()->GetVulkanObject(), &PhysicalDeviceProperties);
+    m_BufferImageGranularity = std::max<VkDeviceSize>(PhysicalDeviceProperties.limits.bufferImageGranularity, 1);
+    m_NonCoherentAtomSize = std::max<VkDeviceSize>(PhysicalDeviceProperties.limits.nonCoherentAtomSize, 1);
+    m_MaxMemoryAllocationCount = PhysicalDeviceProperties.limits.maxMemoryAllocationCount;
+
+    m_Blocks.resize(m_MemoryProperties.memoryTypeCount);
+    m_HeapStats.resize(m_MemoryProperties.memoryHeapCount);
+    for (uint32 HeapIndex = 0; HeapIndex < m_MemoryProperties.memoryHeapCount; HeapIndex++)
+    {
+        // Leaves room for other applications and the driver's own allocations
+        m_HeapStats[HeapIndex].Budget = m_MemoryProperties.memoryHeaps[HeapIndex].size / 10 * 8;
+    }
+
+    UNICA_LOG_TRACE("VulkanMemoryAllocator created");
+}
+
+void VulkanMemoryAllocator::Destroy()
+{
+    UNICA_LOG_TRACE("Destroying VulkanMemoryAllocator");
+    const std::lock_guard Lock(m_Mutex);
+    for (uint32 MemoryTypeIndex = 0; MemoryTypeIndex < m_Blocks.size(); MemoryTypeIndex++)
+    {
+        for (const std::unique_ptr<VulkanMemoryBlock>& Block : m_Blocks[MemoryTypeIndex])
+        {
+            if (!Block->Ranges.IsEmpty())
+            {
+                UNICA_LOG_ERROR("{} allocations of memory type {} weren't freed", Block->Ranges.GetAllocationCount(), MemoryTypeIndex);
+            }
+            FreeDeviceMemory(MemoryTypeIndex, Block->Memory, Block->Ranges.GetSize());
+        }
+        m_Blocks[MemoryTypeIndex].clear();
+    }
+
+    for (uint32 HeapIndex = 0; HeapIndex < m_HeapStats.size(); HeapIndex++)
+    {
+        if (m_HeapStats[HeapIndex].DedicatedAllocationCount > 0)
+        {
+            UNICA_LOG_ERROR("{} dedicated allocations of memory heap {} weren't freed", m_HeapStats[HeapIndex].DedicatedAllocationCount, HeapIndex);
+        }
+    }
+}
+
+void VulkanMemoryAllocator::Tick() const
+{
+    const std::lock_guard Lock(m_Mutex);
+    VulkanMemoryHeapStats TotalStats;
+    for (const VulkanMemoryHeapStats& HeapStats : m_HeapStats)
+    {
+        TotalStats.ReservedBytes += HeapStats.ReservedBytes;
+        TotalStats.AllocatedBytes += HeapStats.AllocatedBytes;
+    }
+    UNICA_PROFILE_PLOT("GPU Memory Reserved (MiB)", ToMebibytes(TotalStats.ReservedBytes));
+    UNICA_PROFILE_PLOT("GPU Memory Allocated (MiB)", ToMebibytes(TotalStats.AllocatedBytes));
+    UNICA_PROFILE_PLOT("GPU Memory Objects", static_cast<int64>(m_DeviceMemoryCount));
+}
+
+VulkanAllocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& Requirements, const VkMemoryPropertyFlags RequiredFlags, const VkMemoryPropertyFlags PreferredFlags,
+    const VulkanResourceTiling Tiling)
+{
+    UNICA_PROFILE_FUNCTION
+    const uint32 MemoryTypeIndex = FindMemoryType(Requirements.memoryTypeBits, RequiredFlags, PreferredFlags);
+    if (MemoryTypeIndex == UINT32_MAX)
+    {
+        UNICA_LOG_ERROR("No memory type has the properties {:#x} a resource of {} bytes needs", RequiredFlags, Requirements.size);
+        return { };
+    }
+
+    VkDeviceSize Size = Requirements.size;
+    VkDeviceSize Alignment = Requirements.alignment;
+    const VkMemoryPropertyFlags MemoryTypeFlags = m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags;
+    if ((MemoryTypeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(MemoryTypeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        // Flushing one allocation then never touches the atoms of its neighbours
+        Alignment = std::max(Alignment, m_NonCoherentAtomSize);
+    }
+    if (Tiling == VulkanResourceTiling::Optimal)
+    {
+        // Optimal images take whole pages, so no buffer can end up in a page next to one
+        Alignment = std::max(Alignment, m_BufferImageGranularity);
+        Size = AlignUp(Size, m_BufferImageGranularity);
+    }
+
+    const std::lock_guard Lock(m_Mutex);
+    VulkanAllocation Allocation;
+    const bool bDedicated = Size > GetPreferredBlockSize(MemoryTypeIndex) / 2;
+    if (!(bDedicated ? AllocateDedicated(MemoryTypeIndex, Size, Allocation) : AllocateFromBlocks(MemoryTypeIndex, Size, Alignment, Allocation)))
+    {
+        UNICA_LOG_ERROR("Out of memory of type {} for a resource of {} bytes", MemoryTypeIndex, Size);
+        return { };
+    }
+
+    Allocation.MemoryTypeIndex = MemoryTypeIndex;
+    VulkanMemoryHeapStats& HeapStats = m_HeapStats[GetHeapIndex(MemoryTypeIndex)];
+    HeapStats.AllocationCount++;
+    HeapStats.AllocatedBytes += Size;
+    HeapStats.DedicatedAllocationCount += bDedicated ? 1 : 0;
+    return Allocation;
+}
+
+void VulkanMemoryAllocator::Free(VulkanAllocation& Allocation)
+{
+    if (!Allocation.IsValid())
+    {
+        return;
+    }
+
+    const std::lock_guard Lock(m_Mutex);
+    const uint32 MemoryTypeIndex = Allocation.MemoryTypeIndex;
+    VulkanMemoryHeapStats& HeapStats = m_HeapStats[GetHeapIndex(MemoryTypeIndex)];
+    HeapStats.AllocationCount--;
+    HeapStats.AllocatedBytes -= Allocation.Size;
+
+    if (!Allocation.Block)
+    {
+        HeapStats.DedicatedAllocationCount--;
+        FreeDeviceMemory(MemoryTypeIndex, Allocation.Memory, Allocation.Size);
+        Allocation = { };
+        return;
+    }
+
+    VulkanMemoryBlock* Block = Allocation.Block;
+    Block->Ranges.Free(Allocation.RangeHandle);
+    Allocation = { };
+
+    // The last block of a memory type stays, even empty, so a staging buffer created and destroyed every so often
+    // doesn't allocate device memory each time
+    std::vector<std::unique_ptr<VulkanMemoryBlock>>& Blocks = m_Blocks[MemoryTypeIndex];
+    if (Block->Ranges.IsEmpty() && Blocks.size() > 1)
+    {
+        const std::vector<std::unique_ptr<VulkanMemoryBlock>>::iterator EmptyBlock = std::find_if(Blocks.begin(), Blocks.end(),
+            [Block](const std::unique_ptr<VulkanMemoryBlock>& OtherBlock) { return OtherBlock.get() == Block; });
+        FreeDeviceMemory(MemoryTypeIndex, Block->Memory, Block->Ranges.GetSize());
+        Blocks.erase(EmptyBlock);
+    }
+}
+
+bool VulkanMemoryAllocator::CreateBuffer(const VkDeviceSize Size, const VkBufferUsageFlags UsageFlags, const VkMemoryPropertyFlags RequiredFlags, VkBuffer& OutBuffer,
+    VulkanAllocation& OutAllocation)
+{
+    const VkDevice LogicalDevice = m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject();
+
+    VkBufferCreateInfo BufferCreateInfo { };
+    BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    BufferCreateInfo.size = Size;
+    BufferCreateInfo.usage = UsageFlags;
+    BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    if (vkCreateBuffer(LogicalDevice, &BufferCreateInfo, nullptr, &OutBuffer) != VK_SUCCESS)
+    {
+        UNICA_LOG_ERROR("Failed to create a buffer of {} bytes", Size);
+        return false;
+    }
+
+    VkMemoryRequirements MemoryRequirements;
+    vkGetBufferMemoryRequirements(LogicalDevice, OutBuffer, &MemoryRequirements);
+
+    OutAllocation = Allocate(MemoryRequirements, RequiredFlags);
+    if (!OutAllocation.IsValid())
+    {
+        vkDestroyBuffer(LogicalDevice, OutBuffer, nullptr);
+        OutBuffer = VK_NULL_HANDLE;
+        return false;
+    }
+
+    vkBindBufferMemory(LogicalDevice, OutBuffer, OutAllocation.Memory, OutAllocation.Offset);
+    return true;
+}
+
+void VulkanMemoryAllocator::DestroyBuffer(VkBuffer& Buffer, VulkanAllocation& Allocation)
+{
+    vkDestroyBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), Buffer, nullptr);
+    Buffer = VK_NULL_HANDLE;
+    Free(Allocation);
+}
+
+uint32 VulkanMemoryAllocator::FindMemoryType(const uint32 TypeFilter, const VkMemoryPropertyFlags RequiredFlags, const VkMemoryPropertyFlags PreferredFlags) const
+{
+    for (const VkMemoryPropertyFlags WantedFlags : { RequiredFlags | PreferredFlags, RequiredFlags })
+    {
+        for (uint32 MemoryTypeIndex = 0; MemoryTypeIndex < m_MemoryProperties.memoryTypeCount; MemoryTypeIndex++)
+        {
+            if ((TypeFilter & (1u << MemoryTypeIndex)) && (m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags & WantedFlags) == WantedFlags)
+            {
+                return MemoryTypeIndex;
+            }
+        }
+    }
+    return UINT32_MAX;
+}
+
+std::vector<VulkanMemoryHeapStats> VulkanMemoryAllocator::GetHeapStats() const
+{
+    const std::lock_guard Lock(m_Mutex);
+    return m_HeapStats;
+}
+
+VkDeviceSize VulkanMemoryAllocator::GetPreferredBlockSize(const uint32 MemoryTypeIndex) const
+{
+    // Small heaps, e.g. the host visible part of VRAM, would be taken up by a few blocks of the usual size
+    const VkDeviceSize HeapSize = m_MemoryProperties.memoryHeaps[GetHeapIndex(MemoryTypeIndex)].size;
+    return HeapSize <= 1024ull * 1024 * 1024 ? HeapSize / 8 : UnicaSettings::GpuMemoryBlockSize;
+}
+
+bool VulkanMemoryAllocator::AllocateFromBlocks(const uint32 MemoryTypeIndex, const VkDeviceSize Size, const VkDeviceSize Alignment, VulkanAllocation& OutAllocation)
+{
+    // Older blocks first, so the newer ones are the likeliest to empty out and be freed
+    uint32 RangeHandle = TlsfAllocator::InvalidHandle;
+    VulkanMemoryBlock* Block = nullptr;
+    for (const std::unique_ptr<VulkanMemoryBlock>& ExistingBlock : m_Blocks[MemoryTypeIndex])
+    {
+        RangeHandle = ExistingBlock->Ranges.Allocate(Size, Alignment);
+        if (RangeHandle != TlsfAllocator::InvalidHandle)
+        {
+            Block = ExistingBlock.get();
+            break;
+        }
+    }
+
+    if (!Block)
+    {
+        Block = CreateBlock(MemoryTypeIndex, Size, Alignment);
+        if (!Block)
+        {
+            return false;
+        }
+        RangeHandle = Block->Ranges.Allocate(Size, Alignment);
+    }
+
+    OutAllocation.Memory = Block->Memory;
+    OutAllocation.Offset = Block->Ranges.GetOffset(RangeHandle);
+    OutAllocation.Size = Size;
+    OutAllocation.MappedData = Block->MappedData ? Block->MappedData + OutAllocation.Offset : nullptr;
+    OutAllocation.Block = Block;
+    OutAllocation.RangeHandle = RangeHandle;
+    return true;
+}
+
+bool VulkanMemoryAllocator::AllocateDedicated(const uint32 MemoryTypeIndex, const VkDeviceSize Size, VulkanAllocation& OutAllocation)
+{
+    char* MappedData = nullptr;
+    OutAllocation.Memory = AllocateDeviceMemory(MemoryTypeIndex, Size, MappedData);
+    OutAllocation.Size = Size;
+    OutAllocation.MappedData = MappedData;
+    return OutAllocation.IsValid();
+}
+
+VulkanMemoryBlock* VulkanMemoryAllocator::CreateBlock(const uint32 MemoryTypeIndex, const VkDeviceSize Size, const VkDeviceSize Alignment)
+{
+    // The first blocks of a memory type are smaller, most only ever hold a handful of resources
+    const VkDeviceSize RequiredSize = Size + Alignment - 1;
+    const size_t BlockCount = m_Blocks[MemoryTypeIndex].size();
+    VkDeviceSize BlockSize = GetPreferredBlockSize(MemoryTypeIndex) >> (3 - std::min<size_t>(BlockCount, 3));
+    while (BlockSize < RequiredSize)
+    {
+        BlockSize *= 2;
+    }
+
+    char* MappedData = nullptr;
+    VkDeviceMemory Memory = AllocateDeviceMemory(MemoryTypeIndex, BlockSize, MappedData);
+    // A nearly full heap may still have room for a smaller one
+    while (Memory == VK_NULL_HANDLE && BlockSize / 2 >= RequiredSize)
+    {
+        BlockSize /= 2;
+        Memory = AllocateDeviceMemory(MemoryTypeIndex, BlockSize, MappedData);
+    }
+    if (Memory == VK_NULL_HANDLE)
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<VulkanMemoryBlock>& Block = m_Blocks[MemoryTypeIndex].emplace_back(std::make_unique<VulkanMemoryBlock>(BlockSize));
+    Block->Memory = Memory;
+    Block->MappedData = MappedData;
+    UNICA_LOG_DEBUG("Created a {:.1f} MiB block of memory type {}", ToMebibytes(BlockSize), MemoryTypeIndex);
+    return Block.get();
+}
+
+VkDeviceMemory VulkanMemoryAllocator::AllocateDeviceMemory(const uint32 MemoryTypeIndex, const VkDeviceSize Size, char*& OutMappedData)
+{
+    if (m_DeviceMemoryCount >= m_MaxMemoryAllocationCount)
+    {
+        UNICA_LOG_ERROR("Reached the device's limit of {} memory allocations", m_MaxMemoryAllocationCount);
+        return VK_NULL_HANDLE;
+    }
+
+    const VkDevice LogicalDevice = m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject();
+    VkMemoryAllocateInfo MemoryAllocateInfo { };
+    MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    MemoryAllocateInfo.allocationSize = Size;
+    MemoryAllocateInfo.memoryTypeIndex = MemoryTypeIndex;
+
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    if (vkAllocateMemory(LogicalDevice, &MemoryAllocateInfo, nullptr, &Memory) != VK_SUCCESS)
+    {
+        return VK_NULL_HANDLE;
+    }
+
+    OutMappedData = nullptr;
+    if (m_MemoryProperties.memoryTypes[MemoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        void* MappedData = nullptr;
+        if (vkMapMemory(LogicalDevice, Memory, 0, VK_WHOLE_SIZE, 0, &MappedData) != VK_SUCCESS)
+        {
+            vkFreeMemory(LogicalDevice, Memory, nullptr);
+            return VK_NULL_HANDLE;
+        }
+        OutMappedData = static_cast<char*>(MappedData);
+    }
+
+    m_DeviceMemoryCount++;
+    VulkanMemoryHeapStats& HeapStats = m_HeapStats[GetHeapIndex(MemoryTypeIndex)];
+    HeapStats.DeviceMemoryCount++;
+    HeapStats.ReservedBytes += Size;
+    if (HeapStats.ReservedBytes > HeapStats.Budget)
+    {
+        UNICA_LOG_WARN("Memory heap {} is over budget, {:.1f} of {:.1f} MiB reserved", GetHeapIndex(MemoryTypeIndex), ToMebibytes(HeapStats.ReservedBytes),
+            ToMebibytes(HeapStats.Budget));
+    }
+    return Memory;
+}
+
+void VulkanMemoryAllocator::FreeDeviceMemory(const uint32 MemoryTypeIndex, const VkDeviceMemory Memory, const VkDeviceSize Size)
+{
+    // Freeing implicitly unmaps it
+    vkFreeMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), Memory, nullptr);
+
+    m_DeviceMemoryCount--;
+    VulkanMemoryHeapStats& HeapStats = m_HeapStats[GetHeapIndex(MemoryTypeIndex)];
+    HeapStats.DeviceMemoryCount--;
+    HeapStats.ReservedBytes -= Size;
+}
@@ -0,0 +1,129 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+#include "UnicaMinimal.h"
+#include "Memory/TlsfAllocator.h"
+
+class VulkanInterface;
+
+/** Device memory object shared by the allocations of one memory type */
+struct VulkanMemoryBlock
+{
+    explicit VulkanMemoryBlock(const VkDeviceSize Size) : Ranges(Size) { }
+
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    TlsfAllocator Ranges;
+    // Host visible blocks stay mapped for as long as they live, Vulkan doesn't allow mapping a block twice
+    char* MappedData = nullptr;
+};
+
+/** Memory a resource is bound to, at Offset in Memory */
+struct VulkanAllocation
+{
+    VkDeviceMemory Memory = VK_NULL_HANDLE;
+    VkDeviceSize Offset = 0;
+    VkDeviceSize Size = 0;
+    // Points at Offset when the memory is host visible, null otherwise
+    void* MappedData = nullptr;
+
+    // Where VulkanMemoryAllocator carved it from, no block for dedicated allocations
+    uint32 MemoryTypeIndex = 0;
+    VulkanMemoryBlock* Block = nullptr;
+    uint32 RangeHandle = TlsfAllocator::InvalidHandle;
+
+    bool IsValid() const { return Memory != VK_NULL_HANDLE; }
+};
+
+/** Buffers and linearly tiled images can't share a bufferImageGranularity page with optimally tiled images */
+enum class VulkanResourceTiling : uint8
+{
+    Linear,
+    Optimal
+};
+
+struct VulkanMemoryHeapStats
+{
+    // Device memory objects taken from the heap, blocks and dedicated allocations alike, and their size
+    uint32 DeviceMemoryCount = 0;
+    VkDeviceSize ReservedBytes = 0;
+    // Resources bound to that memory and the bytes they asked for
+    uint32 AllocationCount = 0;
+    VkDeviceSize AllocatedBytes = 0;
+    uint32 DedicatedAllocationCount = 0;
+    // What the engine aims to stay under, part of the heap size as VK_EXT_memory_budget isn't enabled
+    VkDeviceSize Budget = 0;
+};
+
+/**
+ * Hands out device memory for buffers and images. Small resources are sub-allocated from large blocks per memory type
+ * with a TlsfAllocator, while resources past half a block get a device memory object of their own, so loading content
+ * doesn't run into maxMemoryAllocationCount nor pay for a driver allocation per resource.
+ * Blocks grow from an eighth of UnicaSettings::GpuMemoryBlockSize as a memory type fills up, and one empty block per
+ * memory type is kept around for the next staging buffer. Safe to call from any thread
+ */
+class VulkanMemoryAllocator
+{
+public:
+    explicit VulkanMemoryAllocator(VulkanInterface* OwningVulkanAPI) : m_OwningVulkanAPI(OwningVulkanAPI) { }
+
+    void Init();
+    /** Reports what wasn't freed by then */
+    void Destroy();
+
+    /** Plot the memory in use, once per frame */
+    void Tick() const;
+
+    /**
+     * Memory for a resource with Requirements, from a memory type with every RequiredFlags bit, and PreferredFlags too
+     * when there's one
+     * @return Invalid when no memory type fits or it's out of memory
+     */
+    VulkanAllocation Allocate(const VkMemoryRequirements& Requirements, VkMemoryPropertyFlags RequiredFlags, VkMemoryPropertyFlags PreferredFlags = 0,
+        VulkanResourceTiling Tiling = VulkanResourceTiling::Linear);
+    /** Resets Allocation. The resources bound to it must no longer be in use by the GPU */
+    void Free(VulkanAllocation& Allocation);
+
+    /** Create a buffer bound to new memory, destroy both with DestroyBuffer */
+    bool CreateBuffer(VkDeviceSize Size, VkBufferUsageFlags UsageFlags, VkMemoryPropertyFlags RequiredFlags, VkBuffer& OutBuffer, VulkanAllocation& OutAllocation);
+    void DestroyBuffer(VkBuffer& Buffer, VulkanAllocation& Allocation);
+
+    /** @return UINT32_MAX when no memory type in TypeFilter has RequiredFlags */
+    uint32 FindMemoryType(uint32 TypeFilter, VkMemoryPropertyFlags RequiredFlags, VkMemoryPropertyFlags PreferredFlags = 0) const;
+
+    /** One entry per memory heap of the physical device */
+    std::vector<VulkanMemoryHeapStats> GetHeapStats() const;
+
+private:
+    uint32 GetHeapIndex(const uint32 MemoryTypeIndex) const { return m_MemoryProperties.memoryTypes[MemoryTypeIndex].heapIndex; }
+    VkDeviceSize GetPreferredBlockSize(uint32 MemoryTypeIndex) const;
+
+    bool AllocateFromBlocks(uint32 MemoryTypeIndex, VkDeviceSize Size, VkDeviceSize Alignment, VulkanAllocation& OutAllocation);
+    bool AllocateDedicated(uint32 MemoryTypeIndex, VkDeviceSize Size, VulkanAllocation& OutAllocation);
+    /** A new block big enough for Size at Alignment, null when the device is out of memory. Call with m_Mutex held */
+    VulkanMemoryBlock* CreateBlock(uint32 MemoryTypeIndex, VkDeviceSize Size, VkDeviceSize Alignment);
+
+    /** vkAllocateMemory, mapped when host visible and accounted for in the heap stats */
+    VkDeviceMemory AllocateDeviceMemory(uint32 MemoryTypeIndex, VkDeviceSize Size, char*& OutMappedData);
+    void FreeDeviceMemory(uint32 MemoryTypeIndex, VkDeviceMemory Memory, VkDeviceSize Size);
+
+    VulkanInterface* m_OwningVulkanAPI = nullptr;
+
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties { };
+    VkDeviceSize m_BufferImageGranularity = 1;
+    VkDeviceSize m_NonCoherentAtomSize = 1;
+    uint32 m_MaxMemoryAllocationCount = 0;
+
+    mutable std::mutex m_Mutex;
+    // Indexed by memory type
+    std::vector<std::vector<std::unique_ptr<VulkanMemoryBlock>>> m_Blocks;
+    // Indexed by memory heap
+    std::vector<VulkanMemoryHeapStats> m_HeapStats;
+    uint32 m_DeviceMemoryCount = 0;
+};
@@ -1,17 +1,131 @@
 ﻿#include "VulkanPipeline.h"
 
+#include "Jobs/JobSystem.h"
 #include "Logging/Logger.h"
 #include "Renderer/Vulkan/VulkanInterface.h"
-#include "Renderer/Vulkan/VulkanVertex.h"
+#include "Renderer/Vulkan/Shaders/ShaderCompiler.h"
 #include "Renderer/Vulkan/Shaders/ShaderUtilities.h"
 
 void VulkanPipeline::Init()
 {
-    std::vector<char> VertShaderBinary = ShaderUtilities::LoadShader("Engine:Shaders/shader.vert");
-	std::vector<char> FragShaderBinary = ShaderUtilities::LoadShader("Engine:Shaders/shader.frag");
+	UNICA_PROFILE_FUNCTION
+	m_VulkanObject = CreatePipeline(ShaderUtilities::LoadShaders({ m_Description.VertexShader, m_Description.FragmentShader }, m_Description.ShaderOptions));
+	if (m_VulkanObject == VK_NULL_HANDLE)
+	{
+		UNICA_LOG_ERROR("Failed to create the VulkanPipeline for '{}' and '{}'", m_Description.VertexShader, m_Description.FragmentShader);
+		return;
+	}
+
+	UNICA_LOG_TRACE("VulkanPipeline created for '{}' and '{}'", m_Description.VertexShader, m_Description.FragmentShader);
+}
+
+void VulkanPipeline::Tick()
+{
+	// One rebuild at a time, changes made while it runs start the next one
+	if (!m_bRebuildRequested || !m_RebuildCounter.IsComplete())
+	{
+		return;
+	}
 
-	VkShaderModule VertShaderModule = CreateShaderModule(VertShaderBinary);
-	VkShaderModule FragShaderModule = CreateShaderModule(FragShaderBinary);
+	m_bRebuildRequested = false;
+	UNICA_LOG_INFO("Shaders changed, rebuilding the VulkanPipeline for '{}' and '{}'", m_Description.VertexShader, m_Description.FragmentShader);
+	JobSystem::Dispatch("RebuildVulkanPipeline", [this] { RebuildPipeline(); }, &m_RebuildCounter);
+}
+
+void VulkanPipeline::BeginFrame(const uint8 FrameIndex)
+{
+	UNICA_PROFILE_FUNCTION
+	const VkDevice LogicalDevice = m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject();
+
+	// This frame's fence is done, so is every earlier use of a retired pipeline on this frame slot
+	for (std::vector<RetiredPipeline>::iterator Retired = m_RetiredPipelines.begin(); Retired != m_RetiredPipelines.end();)
+	{
+		Retired->PendingFrameMask &= ~(1u << FrameIndex);
+		if (Retired->PendingFrameMask != 0)
+		{
+			++Retired;
+			continue;
+		}
+
+		vkDestroyPipeline(LogicalDevice, Retired->Pipeline, nullptr);
+		Retired = m_RetiredPipelines.erase(Retired);
+	}
+
+	VkPipeline RebuiltPipeline = VK_NULL_HANDLE;
+	{
+		const std::lock_guard RebuiltPipelineLock(m_RebuiltPipelineMutex);
+		std::swap(RebuiltPipeline, m_RebuiltPipeline);
+	}
+	if (RebuiltPipeline == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	// Other frames in flight may still be executing with the old pipeline, it's destroyed once each of their fences was waited on
+	RetiredPipeline Retired;
+	Retired.Pipeline = m_VulkanObject;
+	Retired.PendingFrameMask = ((1u << m_OwningVulkanAPI->GetMaxFramesInFlight()) - 1) & ~(1u << FrameIndex);
+	if (Retired.PendingFrameMask == 0)
+	{
+		vkDestroyPipeline(LogicalDevice, Retired.Pipeline, nullptr);
+	}
+	else
+	{
+		m_RetiredPipelines.push_back(Retired);
+	}
+
+	m_VulkanObject = RebuiltPipeline;
+	UNICA_LOG_INFO("Swapped in the rebuilt VulkanPipeline");
+}
+
+void VulkanPipeline::RebuildPipeline()
+{
+	UNICA_PROFILE_FUNCTION
+	std::vector<UnicaMappedFile> ShaderBinaries;
+	for (const std::string& ShaderFileLocation : { m_Description.VertexShader, m_Description.FragmentShader })
+	{
+		// Unlike at startup there's no falling back to the .spv, the current pipeline is better than a stale one
+		UnicaMappedFile ShaderBinary = ShaderCompiler::Compile(ShaderFileLocation, m_Description.ShaderOptions);
+		if (ShaderBinary.IsEmpty())
+		{
+			UNICA_LOG_ERROR("Keeping the current VulkanPipeline, '{}' doesn't compile", ShaderFileLocation);
+			return;
+		}
+		ShaderBinaries.push_back(std::move(ShaderBinary));
+	}
+
+	const VkPipeline RebuiltPipeline = CreatePipeline(ShaderBinaries);
+	if (RebuiltPipeline == VK_NULL_HANDLE)
+	{
+		UNICA_LOG_ERROR("Keeping the current VulkanPipeline, the rebuilt one failed to create");
+		return;
+	}
+
+	const std::lock_guard RebuiltPipelineLock(m_RebuiltPipelineMutex);
+	if (m_RebuiltPipeline != VK_NULL_HANDLE)
+	{
+		// Superseded before a frame picked it up, so the GPU never saw it
+		vkDestroyPipeline(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_RebuiltPipeline, nullptr);
+	}
+	m_RebuiltPipeline = RebuiltPipeline;
+}
+
+VkPipeline VulkanPipeline::CreatePipeline(const std::vector<UnicaMappedFile>& ShaderBinaries)
+{
+	// A shader that failed to load already logged why
+	if (ShaderBinaries[0].IsEmpty() || ShaderBinaries[1].IsEmpty())
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	VkShaderModule VertShaderModule = CreateShaderModule(ShaderBinaries[0]);
+	VkShaderModule FragShaderModule = CreateShaderModule(ShaderBinaries[1]);
+	if (VertShaderModule == VK_NULL_HANDLE || FragShaderModule == VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), VertShaderModule, nullptr);
+		vkDestroyShaderModule(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), FragShaderModule, nullptr);
+		return VK_NULL_HANDLE;
+	}
 
 	VkPipelineShaderStageCreateInfo VertPipelineShaderStageCreateInfo { };
 	VertPipelineShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -33,48 +147,32 @@ void VulkanPipeline::Init()
 	PipelineDynamicCreateInfo.dynamicStateCount = static_cast<uint32_t>(PipelineDynamicStates.size());
 	PipelineDynamicCreateInfo.pDynamicStates = PipelineDynamicStates.data();
 
-	const VkVertexInputBindingDescription VertexBindingDescription = VulkanVertex::GetBindingDescription();
-	const std::array<VkVertexInputAttributeDescription, 2> VertexAttributeDescriptions = VulkanVertex::GetAttributeDescriptions();
-
 	VkPipelineVertexInputStateCreateInfo PipelineVertexInputCreateInfo { };
 	PipelineVertexInputCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 	PipelineVertexInputCreateInfo.vertexBindingDescriptionCount = 1;
-	PipelineVertexInputCreateInfo.pVertexBindingDescriptions = &VertexBindingDescription;
-	PipelineVertexInputCreateInfo.vertexAttributeDescriptionCount = VertexAttributeDescriptions.size();
-	PipelineVertexInputCreateInfo.pVertexAttributeDescriptions = VertexAttributeDescriptions.data();
+	PipelineVertexInputCreateInfo.pVertexBindingDescriptions = &m_Description.VertexBinding;
+	PipelineVertexInputCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32>(m_Description.VertexAttributes.size());
+	PipelineVertexInputCreateInfo.pVertexAttributeDescriptions = m_Description.VertexAttributes.data();
 
 	VkPipelineInputAssemblyStateCreateInfo PipelineInputAssemblyCreateInfo{};
 	PipelineInputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-	PipelineInputAssemblyCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	PipelineInputAssemblyCreateInfo.topology = m_Description.Topology;
 	PipelineInputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
 
-	VkViewport Viewport{};
-	Viewport.x = 0.0f;
-	Viewport.y = 0.0f;
-	Viewport.width = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().width);
-	Viewport.height = static_cast<float>(m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent().height);
-	Viewport.minDepth = 0.0f;
-	Viewport.maxDepth = 1.0f;
-
-	VkRect2D ScissorRectangle{};
-	ScissorRectangle.offset = {0, 0};
-	ScissorRectangle.extent = m_OwningVulkanAPI->GetVulkanSwapChain()->GetVulkanExtent();
-
+	// Both are dynamic and set while recording, so pipelines can be built off the render thread without reading the swap chain
 	VkPipelineViewportStateCreateInfo PipelineViewportCreateInfo { };
 	PipelineViewportCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 	PipelineViewportCreateInfo.viewportCount = 1;
-	PipelineViewportCreateInfo.pViewports = &Viewport;
 	PipelineViewportCreateInfo.scissorCount = 1;
-	PipelineViewportCreateInfo.pScissors = &ScissorRectangle;
 
 	VkPipelineRasterizationStateCreateInfo PipelineRasterizationCreateInfo { };
 	PipelineRasterizationCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
 	PipelineRasterizationCreateInfo.depthClampEnable = VK_FALSE;
 	PipelineRasterizationCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-	PipelineRasterizationCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
+	PipelineRasterizationCreateInfo.polygonMode = m_Description.PolygonMode;
 	PipelineRasterizationCreateInfo.lineWidth = 1.0f;
-	PipelineRasterizationCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-	PipelineRasterizationCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE;
+	PipelineRasterizationCreateInfo.cullMode = m_Description.CullMode;
+	PipelineRasterizationCreateInfo.frontFace = m_Description.FrontFace;
 	PipelineRasterizationCreateInfo.depthBiasEnable = VK_FALSE;
 
 	VkPipelineMultisampleStateCreateInfo PipelineMultisampleCreateInfo { };
@@ -88,7 +186,16 @@ void VulkanPipeline::Init()
 
 	VkPipelineColorBlendAttachmentState PipelineColorBlendAttachment { };
 	PipelineColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-	PipelineColorBlendAttachment.blendEnable = VK_FALSE;
+	PipelineColorBlendAttachment.blendEnable = m_Description.bAlphaBlend ? VK_TRUE : VK_FALSE;
+	if (m_Description.bAlphaBlend)
+	{
+		PipelineColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		PipelineColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		PipelineColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+		PipelineColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		PipelineColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		PipelineColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	}
 
 	VkPipelineColorBlendStateCreateInfo PipelineColorBlend { };
 	PipelineColorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -96,14 +203,6 @@ void VulkanPipeline::Init()
 	PipelineColorBlend.attachmentCount = 1;
 	PipelineColorBlend.pAttachments = &PipelineColorBlendAttachment;
 
-	VkPipelineLayoutCreateInfo PipelineLayoutInfo { };
-	PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-
-	if (vkCreatePipelineLayout(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &PipelineLayoutInfo, nullptr, &m_VulkanPipelineLayout) != VK_SUCCESS)
-	{
-		UNICA_LOG(spdlog::level::critical, "Failed to create a VulkanPipelineLayout");
-	}
-
 	VkGraphicsPipelineCreateInfo GraphicsPipelineCreateInfo { };
 	GraphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	GraphicsPipelineCreateInfo.stageCount = 2;
@@ -115,33 +214,37 @@ void VulkanPipeline::Init()
 	GraphicsPipelineCreateInfo.pMultisampleState = &PipelineMultisampleCreateInfo;
 	GraphicsPipelineCreateInfo.pColorBlendState = &PipelineColorBlend;
 	GraphicsPipelineCreateInfo.pDynamicState = &PipelineDynamicCreateInfo;
-	GraphicsPipelineCreateInfo.layout = m_VulkanPipelineLayout;
-	GraphicsPipelineCreateInfo.renderPass = m_OwningVulkanAPI->GetVulkanRenderPass()->GetVulkanObject();
-	GraphicsPipelineCreateInfo.subpass = 0;
+	GraphicsPipelineCreateInfo.layout = m_OwningVulkanAPI->GetVulkanPipelineStateCache()->GetPipelineLayout();
+	GraphicsPipelineCreateInfo.renderPass = m_Description.RenderPass;
+	GraphicsPipelineCreateInfo.subpass = m_Description.Subpass;
 
-	if (vkCreateGraphicsPipelines(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), VK_NULL_HANDLE, 1, &GraphicsPipelineCreateInfo, nullptr, &m_VulkanObject) != VK_SUCCESS)
+	VkPipeline Pipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_OwningVulkanAPI->GetVulkanPipelineCache()->GetVulkanObject(), 1, &GraphicsPipelineCreateInfo, nullptr, &Pipeline) != VK_SUCCESS)
 	{
-		UNICA_LOG(spdlog::level::critical, "Failed to create the VulkanGraphicsPipeline");
+		Pipeline = VK_NULL_HANDLE;
 	}
 
 	// Cleanup shader modules since they've already been created
 	vkDestroyShaderModule(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), VertShaderModule, nullptr);
 	vkDestroyShaderModule(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), FragShaderModule, nullptr);
 
-	UNICA_LOG_TRACE("VulkanPipeline created");
+	return Pipeline;
 }
 
-VkShaderModule VulkanPipeline::CreateShaderModule(const std::vector<char>& ShaderBinary)
+VkShaderModule VulkanPipeline::CreateShaderModule(const UnicaMappedFile& ShaderBinary)
 {
+	// Mappings are page aligned and cached shaders start on a word boundary, which satisfies SPIR-V without copying
 	VkShaderModuleCreateInfo ShaderModuleCreateInfo { };
 	ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	ShaderModuleCreateInfo.codeSize = ShaderBinary.size();
-	ShaderModuleCreateInfo.pCode = reinterpret_cast<const uint32*>(ShaderBinary.data());
+	ShaderModuleCreateInfo.codeSize = ShaderBinary.GetSize();
+	ShaderModuleCreateInfo.pCode = reinterpret_cast<const uint32*>(ShaderBinary.GetData());
 
-	VkShaderModule ShaderModule;
+	VkShaderModule ShaderModule = VK_NULL_HANDLE;
 	if (vkCreateShaderModule(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &ShaderModuleCreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
 	{
-		UNICA_LOG(spdlog::level::critical, "Failed to create a VulkanShaderModule");
+		// Runs on job workers too, where a critical error would terminate the engine instead of keeping the current pipeline
+		UNICA_LOG_ERROR("Failed to create a VulkanShaderModule");
+		return VK_NULL_HANDLE;
 	}
 	
 	return ShaderModule;
@@ -150,6 +253,14 @@ VkShaderModule VulkanPipeline::CreateShaderModule(const std::vector<char>& Shade
 void VulkanPipeline::Destroy()
 {
 	UNICA_LOG_TRACE("Destroying VulkanPipeline");
+	JobSystem::WaitForCounter(m_RebuildCounter);
+
+	// The device is idle by now, nothing is in flight anymore
+	for (const RetiredPipeline& Retired : m_RetiredPipelines)
+	{
+		vkDestroyPipeline(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), Retired.Pipeline, nullptr);
+	}
+	m_RetiredPipelines.clear();
+	vkDestroyPipeline(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_RebuiltPipeline, nullptr);
 	vkDestroyPipeline(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VulkanObject, nullptr);
-	vkDestroyPipelineLayout(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VulkanPipelineLayout, nullptr);
 }
@@ -1,20 +1,62 @@
 ﻿#pragma once
+#include <mutex>
 #include <vector>
 
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+#include "Jobs/JobCounter.h"
+#include "Renderer/Vulkan/VulkanPipelineDescription.h"
 #include "Renderer/Vulkan/VulkanTypeInterface.h"
 
+/**
+ * One variant of VulkanPipelineStateCache, built from its VulkanPipelineDescription. Init compiles the shaders and
+ * creates the pipeline, and is safe to run on a job worker.
+ * A rebuild, requested when shaders are hot reloaded, also runs on a job worker and is swapped in at the start of a
+ * frame. The pipeline it replaces lives on until every frame in flight that may use it has finished
+ */
 class VulkanPipeline : public VulkanTypeInterface<VkPipeline>
 {
 public:
-    VulkanPipeline(VulkanInterface* OwningVulkanAPI) : VulkanTypeInterface(OwningVulkanAPI) { }
+    VulkanPipeline(VulkanInterface* OwningVulkanAPI, VulkanPipelineDescription Description)
+        : VulkanTypeInterface(OwningVulkanAPI), m_Description(std::move(Description)) { }
     
     void Init() override;
     void Destroy() override;
+
+    /** Main thread. Rebuilds the pipeline from the current shader sources on the next Tick */
+    void RequestRebuild() { m_bRebuildRequested = true; }
+    /** Main thread. Starts a requested rebuild */
+    void Tick();
+    /** Render thread, right after waiting on the fence of FrameIndex. Swaps in a rebuilt pipeline and destroys retired ones the GPU is done with */
+    void BeginFrame(uint8 FrameIndex);
     
     ~VulkanPipeline() override = default;
 
+    const VulkanPipelineDescription& GetDescription() const { return m_Description; }
+
 private:
-    VkShaderModule CreateShaderModule(const std::vector<char>& ShaderBinary);
+    struct RetiredPipeline
+    {
+        VkPipeline Pipeline = VK_NULL_HANDLE;
+        // One bit per frame in flight whose fence still has to be waited on before destroying it
+        uint32 PendingFrameMask = 0;
+    };
+
+    /** @return VK_NULL_HANDLE when the pipeline can't be created. Safe to call from any thread */
+    VkPipeline CreatePipeline(const std::vector<UnicaMappedFile>& ShaderBinaries);
+    /** @return VK_NULL_HANDLE when the driver rejects the SPIR-V */
+    VkShaderModule CreateShaderModule(const UnicaMappedFile& ShaderBinary);
+    void RebuildPipeline();
     
-    VkPipelineLayout m_VulkanPipelineLayout = VK_NULL_HANDLE;
+    const VulkanPipelineDescription m_Description;
+
+    bool m_bRebuildRequested = false;
+    JobCounter m_RebuildCounter;
+
+    // Handed from the rebuild job to the render thread
+    std::mutex m_RebuiltPipelineMutex;
+    VkPipeline m_RebuiltPipeline = VK_NULL_HANDLE;
+
+    // Render thread only
+    std::vector<RetiredPipeline> m_RetiredPipelines;
 };
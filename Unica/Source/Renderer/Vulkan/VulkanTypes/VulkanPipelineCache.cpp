@@ -0,0 +1,146 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "VulkanPipelineCache.h"
+
+#include <cstring>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "UnicaFileUtilities.h"
+#include "IO/AsyncFileWriter.h"
+#include "Logging/Logger.h"
+#include "Renderer/Vulkan/VulkanInterface.h"
+
+namespace
+{
+    constexpr uint32 CacheFileMagic = 0x43505355; // "USPC"
+    constexpr uint32 CacheFormatVersion = 1;
+    constexpr const char* CacheDirectory = "Engine:Saved/PipelineCache";
+
+    /**
+     * Precedes the driver's data. The driver's own header names the vendor, device and cache UUID but not the driver
+     * version, and some drivers misbehave when handed data from another version instead of rejecting it
+     */
+    struct CacheFileHeader
+    {
+        uint32 Magic = CacheFileMagic;
+        uint32 Version = CacheFormatVersion;
+        uint32 DriverVersion = 0;
+        uint32 Padding = 0;
+        uint64 DataSize = 0;
+    };
+}
+
+void VulkanPipelineCache::Init()
+{
+    UNICA_PROFILE_FUNCTION
+    vkGetPhysicalDeviceProperties(m_OwningVulkanAPI->GetVulkanPhysicalDevice()->GetVulkanObject(), &m_PhysicalDeviceProperties);
+
+    const std::filesystem::path CacheFilePath = GetCacheFilePath();
+    UnicaMappedFile CacheFile;
+    std::error_code Error;
+    if (std::filesystem::exists(CacheFilePath, Error))
+    {
+        CacheFile = UnicaMappedFile::Open(CacheFilePath);
+    }
+    const std::span<const char> CacheData = ValidateCacheFile(CacheFile);
+
+    VkPipelineCacheCreateInfo PipelineCacheCreateInfo { };
+    PipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    PipelineCacheCreateInfo.initialDataSize = CacheData.size();
+    PipelineCacheCreateInfo.pInitialData = CacheData.empty() ? nullptr : CacheData.data();
+
+    if (vkCreatePipelineCache(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &PipelineCacheCreateInfo, nullptr, &m_VulkanObject) != VK_SUCCESS)
+    {
+        // Pipelines still get created without one, just never faster than the first launch
+        UNICA_LOG_ERROR("Failed to create the VulkanPipelineCache");
+        m_VulkanObject = VK_NULL_HANDLE;
+        return;
+    }
+
+    UNICA_LOG_TRACE("VulkanPipelineCache created with {} bytes from '{}'", CacheData.size(), CacheFilePath.string());
+}
+
+void VulkanPipelineCache::Destroy()
+{
+    UNICA_LOG_TRACE("Destroying VulkanPipelineCache");
+    if (m_VulkanObject == VK_NULL_HANDLE)
+    {
+        return;
+    }
+
+    SaveCacheFile();
+    vkDestroyPipelineCache(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VulkanObject, nullptr);
+    m_VulkanObject = VK_NULL_HANDLE;
+}
+
+std::filesystem::path VulkanPipelineCache::GetCacheFilePath() const
+{
+    // One file per GPU, switching between two doesn't throw away what was cached for the other
+    return UnicaFileUtilities::ResolveDirectory(CacheDirectory)
+        / fmt::format("{:04x}_{:04x}.bin", m_PhysicalDeviceProperties.vendorID, m_PhysicalDeviceProperties.deviceID);
+}
+
+std::span<const char> VulkanPipelineCache::ValidateCacheFile(const UnicaMappedFile& CacheFile) const
+{
+    CacheFileHeader Header;
+    VkPipelineCacheHeaderVersionOne DriverHeader;
+    if (CacheFile.GetSize() < sizeof(Header) + sizeof(DriverHeader))
+    {
+        return { };
+    }
+
+    std::memcpy(&Header, CacheFile.GetData(), sizeof(Header));
+    if (Header.Magic != CacheFileMagic || Header.Version != CacheFormatVersion || Header.DataSize != CacheFile.GetSize() - sizeof(Header))
+    {
+        UNICA_LOG_WARN("Discarding the pipeline cache, the file is truncated or of an older format");
+        return { };
+    }
+    if (Header.DriverVersion != m_PhysicalDeviceProperties.driverVersion)
+    {
+        UNICA_LOG_INFO("Discarding the pipeline cache, it was written by another driver version");
+        return { };
+    }
+
+    std::memcpy(&DriverHeader, CacheFile.GetData() + sizeof(Header), sizeof(DriverHeader));
+    if (DriverHeader.headerSize < sizeof(DriverHeader) || DriverHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+        || DriverHeader.vendorID != m_PhysicalDeviceProperties.vendorID || DriverHeader.deviceID != m_PhysicalDeviceProperties.deviceID
+        || std::memcmp(DriverHeader.pipelineCacheUUID, m_PhysicalDeviceProperties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        UNICA_LOG_INFO("Discarding the pipeline cache, it was written for another device or driver");
+        return { };
+    }
+
+    return CacheFile.GetView().subspan(sizeof(Header));
+}
+
+void VulkanPipelineCache::SaveCacheFile() const
+{
+    UNICA_PROFILE_FUNCTION
+    const VkDevice LogicalDevice = m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject();
+    size_t DataSize = 0;
+    if (vkGetPipelineCacheData(LogicalDevice, m_VulkanObject, &DataSize, nullptr) != VK_SUCCESS || DataSize == 0)
+    {
+        return;
+    }
+
+    std::vector<char> CacheFile(sizeof(CacheFileHeader) + DataSize);
+    // The cache may still grow between both calls, VK_INCOMPLETE then means the data was cut short
+    if (vkGetPipelineCacheData(LogicalDevice, m_VulkanObject, &DataSize, CacheFile.data() + sizeof(CacheFileHeader)) != VK_SUCCESS)
+    {
+        UNICA_LOG_WARN("Failed to read back the VulkanPipelineCache, keeping the one on disk");
+        return;
+    }
+    CacheFile.resize(sizeof(CacheFileHeader) + DataSize);
+
+    CacheFileHeader Header;
+    Header.DriverVersion = m_PhysicalDeviceProperties.driverVersion;
+    Header.DataSize = DataSize;
+    std::memcpy(CacheFile.data(), &Header, sizeof(Header));
+
+    // Replaces the previous file atomically, a crash while saving leaves the old cache rather than a torn one
+    const std::filesystem::path CacheFilePath = GetCacheFilePath();
+    UNICA_LOG_DEBUG("Saving {} bytes of pipeline cache to '{}'", DataSize, CacheFilePath.string());
+    AsyncFileWriter::WriteFile(std::move(CacheFile), CacheFilePath.string());
+}
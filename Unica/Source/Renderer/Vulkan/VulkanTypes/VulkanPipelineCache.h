@@ -0,0 +1,36 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "UnicaMinimal.h"
+#include "UnicaMappedFile.h"
+#include "Renderer/Vulkan/VulkanTypeInterface.h"
+
+/**
+ * Pipeline cache every pipeline is created through, so the driver only compiles a pipeline once across launches.
+ * It's loaded from Engine:Saved/PipelineCache when the device is created, unless the data was written by another
+ * vendor, device or driver version, and written back atomically on shutdown.
+ * Vulkan synchronizes access to it internally, so pipelines can be created with it from any thread
+ */
+class VulkanPipelineCache : public VulkanTypeInterface<VkPipelineCache>
+{
+public:
+    VulkanPipelineCache(VulkanInterface* OwningVulkanAPI) : VulkanTypeInterface(OwningVulkanAPI) { }
+
+    void Init() override;
+    void Destroy() override;
+
+    ~VulkanPipelineCache() override = default;
+
+private:
+    std::filesystem::path GetCacheFilePath() const;
+
+    /** The cache data in CacheFile, or empty when it wasn't written for this device and driver */
+    std::span<const char> ValidateCacheFile(const UnicaMappedFile& CacheFile) const;
+    void SaveCacheFile() const;
+
+    VkPhysicalDeviceProperties m_PhysicalDeviceProperties { };
+};
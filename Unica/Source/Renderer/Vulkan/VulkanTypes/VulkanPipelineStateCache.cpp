@@ -0,0 +1,155 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "VulkanPipelineStateCache.h"
+
+#include <mutex>
+
+#include "UnicaFileUtilities.h"
+#include "UnicaSettings.h"
+#include "Jobs/JobSystem.h"
+#include "Logging/Logger.h"
+#include "Renderer/Vulkan/VulkanInterface.h"
+
+void VulkanPipelineStateCache::Init()
+{
+    VkPipelineLayoutCreateInfo PipelineLayoutInfo { };
+    PipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+
+    if (vkCreatePipelineLayout(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &PipelineLayoutInfo, nullptr, &m_VulkanPipelineLayout) != VK_SUCCESS)
+    {
+        UNICA_LOG(spdlog::level::critical, "Failed to create a VulkanPipelineLayout");
+    }
+
+    if (UnicaSettings::bHotReloadShaders && UnicaSettings::bCompileShaders)
+    {
+        // Every change under the directory counts, the shaders may include any of its files
+        m_ShaderWatchHandle = FileWatcher::Subscribe(UnicaFileUtilities::ResolveDirectory("Engine:Shaders"), [this](const FileChangeEvent& Change)
+        {
+            // UnicaBuildTool's outputs aren't sources, nor the temporary it writes the manifest to before renaming it
+            const std::filesystem::path Extension = Change.FilePath.extension();
+            if (Extension != ".spv" && Extension != ".manifest" && Extension != ".tmp")
+            {
+                m_bShadersChanged = true;
+            }
+        });
+    }
+
+    UNICA_LOG_TRACE("VulkanPipelineStateCache created");
+}
+
+void VulkanPipelineStateCache::Destroy()
+{
+    UNICA_LOG_TRACE("Destroying VulkanPipelineStateCache");
+    FileWatcher::Unsubscribe(m_ShaderWatchHandle);
+
+    const std::unique_lock VariantsLock(m_VariantsMutex);
+    for (PipelineVariantMap::iterator Variant = m_Variants.begin(); Variant != m_Variants.end(); ++Variant)
+    {
+        JobSystem::WaitForCounter(Variant->second->CompileCounter);
+        Variant->second->Pipeline->Destroy();
+    }
+    m_Variants.clear();
+
+    vkDestroyPipelineLayout(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VulkanPipelineLayout, nullptr);
+}
+
+void VulkanPipelineStateCache::Tick()
+{
+    UNICA_PROFILE_FUNCTION
+    const std::shared_lock VariantsLock(m_VariantsMutex);
+    for (PipelineVariantMap::iterator Variant = m_Variants.begin(); Variant != m_Variants.end(); ++Variant)
+    {
+        // Variants that failed to compile are rebuilt too, the change may be what fixes them
+        if (m_bShadersChanged)
+        {
+            Variant->second->Pipeline->RequestRebuild();
+        }
+
+        // One still compiling may have read its shaders before the change, its rebuild starts once it's done
+        if (Variant->second->CompileCounter.IsComplete())
+        {
+            Variant->second->Pipeline->Tick();
+        }
+    }
+    m_bShadersChanged = false;
+}
+
+void VulkanPipelineStateCache::BeginFrame(const uint8 FrameIndex)
+{
+    UNICA_PROFILE_FUNCTION
+    const std::shared_lock VariantsLock(m_VariantsMutex);
+    for (PipelineVariantMap::iterator Variant = m_Variants.begin(); Variant != m_Variants.end(); ++Variant)
+    {
+        if (Variant->second->CompileCounter.IsComplete())
+        {
+            Variant->second->Pipeline->BeginFrame(FrameIndex);
+        }
+    }
+}
+
+void VulkanPipelineStateCache::Prewarm(const VulkanPipelineDescription& Description)
+{
+    FindOrCompileVariant(Description);
+}
+
+VkPipeline VulkanPipelineStateCache::FindPipeline(const VulkanPipelineDescription& Description, const VulkanPipelineDescription* Fallback)
+{
+    const VkPipeline Pipeline = GetReadyPipeline(FindOrCompileVariant(Description));
+    if (Pipeline != VK_NULL_HANDLE || !Fallback)
+    {
+        return Pipeline;
+    }
+    return GetReadyPipeline(FindOrCompileVariant(*Fallback));
+}
+
+VkPipeline VulkanPipelineStateCache::WaitForPipeline(const VulkanPipelineDescription& Description)
+{
+    UNICA_PROFILE_FUNCTION
+    const PipelineVariant& Variant = FindOrCompileVariant(Description);
+    JobSystem::WaitForCounter(Variant.CompileCounter);
+    return GetReadyPipeline(Variant);
+}
+
+uint32 VulkanPipelineStateCache::GetCompilingVariantCount() const
+{
+    const std::shared_lock VariantsLock(m_VariantsMutex);
+    uint32 CompilingVariantCount = 0;
+    for (PipelineVariantMap::const_iterator Variant = m_Variants.begin(); Variant != m_Variants.end(); ++Variant)
+    {
+        CompilingVariantCount += Variant->second->CompileCounter.IsComplete() ? 0 : 1;
+    }
+    return CompilingVariantCount;
+}
+
+VulkanPipelineStateCache::PipelineVariant& VulkanPipelineStateCache::FindOrCompileVariant(const VulkanPipelineDescription& Description)
+{
+    {
+        const std::shared_lock VariantsLock(m_VariantsMutex);
+        PipelineVariantMap::const_iterator Variant = m_Variants.find(Description);
+        if (Variant != m_Variants.end())
+        {
+            return *Variant->second;
+        }
+    }
+
+    const std::unique_lock VariantsLock(m_VariantsMutex);
+    // Another thread may have asked for the same variant in between both locks
+    std::unique_ptr<PipelineVariant>& Variant = m_Variants[Description];
+    if (Variant)
+    {
+        return *Variant;
+    }
+
+    Variant = std::make_unique<PipelineVariant>();
+    Variant->Pipeline = std::make_unique<VulkanPipeline>(m_OwningVulkanAPI, Description);
+    UNICA_LOG_DEBUG("Compiling VulkanPipeline variant {:016x}", Description.GetHash());
+    // Variants are never removed before Destroy, which waits for this job
+    VulkanPipeline* Pipeline = Variant->Pipeline.get();
+    JobSystem::Dispatch("CompileVulkanPipeline", [Pipeline] { Pipeline->Init(); }, &Variant->CompileCounter);
+    return *Variant;
+}
+
+VkPipeline VulkanPipelineStateCache::GetReadyPipeline(const PipelineVariant& Variant)
+{
+    return Variant.CompileCounter.IsComplete() ? Variant.Pipeline->GetVulkanObject() : VK_NULL_HANDLE;
+}
@@ -0,0 +1,75 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "UnicaMinimal.h"
+#include "IO/FileWatcher.h"
+#include "Jobs/JobCounter.h"
+#include "Renderer/Vulkan/VulkanPipelineDescription.h"
+#include "Renderer/Vulkan/VulkanTypes/VulkanPipeline.h"
+
+class VulkanInterface;
+
+/**
+ * Every graphics pipeline variant, keyed by a hash of its VulkanPipelineDescription. A variant that's asked for and
+ * doesn't exist yet is compiled on a job worker, and until it's ready the draws that need it fall back to another
+ * variant or are skipped, so a new material never stalls the frame that first uses it.
+ * All variants share one pipeline layout, and are rebuilt when shaders are hot reloaded
+ */
+class VulkanPipelineStateCache
+{
+public:
+    explicit VulkanPipelineStateCache(VulkanInterface* OwningVulkanAPI) : m_OwningVulkanAPI(OwningVulkanAPI) { }
+
+    void Init();
+    void Destroy();
+
+    /** Main thread. Starts rebuilding the variants when shaders changed */
+    void Tick();
+    /** Render thread, right after waiting on the fence of FrameIndex, see VulkanPipeline::BeginFrame */
+    void BeginFrame(uint8 FrameIndex);
+
+    /** Start compiling the variant for Description unless it already exists, e.g. while loading a material. Any thread */
+    void Prewarm(const VulkanPipelineDescription& Description);
+
+    /**
+     * The pipeline for Description, or the one for Fallback while it's compiling. Requests whichever doesn't exist yet.
+     * Render thread
+     * @return VK_NULL_HANDLE when neither is ready, the draw should be skipped this frame
+     */
+    VkPipeline FindPipeline(const VulkanPipelineDescription& Description, const VulkanPipelineDescription* Fallback = nullptr);
+
+    /** Blocks until the variant for Description is compiled, for pipelines that have to be there from the first frame */
+    VkPipeline WaitForPipeline(const VulkanPipelineDescription& Description);
+
+    VkPipelineLayout GetPipelineLayout() const { return m_VulkanPipelineLayout; }
+    uint32 GetCompilingVariantCount() const;
+
+private:
+    struct PipelineVariant
+    {
+        std::unique_ptr<VulkanPipeline> Pipeline;
+        // Complete once Pipeline was created, only then can it be read outside the job
+        JobCounter CompileCounter;
+    };
+
+    using PipelineVariantMap = std::unordered_map<VulkanPipelineDescription, std::unique_ptr<PipelineVariant>, VulkanPipelineDescription::Hasher>;
+
+    PipelineVariant& FindOrCompileVariant(const VulkanPipelineDescription& Description);
+    /** VK_NULL_HANDLE while the variant compiles or when it failed to */
+    static VkPipeline GetReadyPipeline(const PipelineVariant& Variant);
+
+    VulkanInterface* m_OwningVulkanAPI = nullptr;
+    VkPipelineLayout m_VulkanPipelineLayout = VK_NULL_HANDLE;
+
+    mutable std::shared_mutex m_VariantsMutex;
+    PipelineVariantMap m_Variants;
+
+    // Main thread only
+    FileWatchHandle m_ShaderWatchHandle = 0;
+    bool m_bShadersChanged = false;
+};
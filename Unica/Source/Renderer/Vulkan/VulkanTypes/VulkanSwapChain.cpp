@@ -4,6 +4,8 @@
 #include "Renderer/Vulkan/VulkanInterface.h"
 #include "Renderer/Vulkan/VulkanSwapChainSupportDetails.h"
 #include "Renderer/Vulkan/VulkanQueueFamilyIndices.h"
+#include "Timer/FramePacer.h"
+#include "Core/UnicaSettings.h"
 
 void VulkanSwapChain::Init()
 {
@@ -66,7 +68,7 @@ void VulkanSwapChain::Init()
 	UNICA_LOG_TRACE("VulkanSwapChain created");
 }
 
-VkSurfaceFormatKHR VulkanSwapChain::SelectSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& AvailableSurfaceFormats)
+VkSurfaceFormatKHR VulkanSwapChain::SelectSwapSurfaceFormat(const std::span<const VkSurfaceFormatKHR> AvailableSurfaceFormats)
 {
 	for (const VkSurfaceFormatKHR& SurfaceFormat : AvailableSurfaceFormats)
 	{
@@ -80,16 +82,37 @@ VkSurfaceFormatKHR VulkanSwapChain::SelectSwapSurfaceFormat(const std::vector<Vk
 	return AvailableSurfaceFormats[0];
 }
 
-VkPresentModeKHR VulkanSwapChain::SelectSwapPresentMode(const std::vector<VkPresentModeKHR>& AvailablePresentModes)
+VkPresentModeKHR VulkanSwapChain::SelectSwapPresentMode(const std::span<const VkPresentModeKHR> AvailablePresentModes)
 {
+	// FIFO blocks the present on the display refresh, which is what paces the frame when the CPU doesn't
+	if (!FramePacer::IsPacingOnCpu())
+	{
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
+
+	VkPresentModeKHR PreferredPresentMode;
+	switch (UnicaSettings::PresentMode)
+	{
+	case PresentModePreference::Mailbox:
+		PreferredPresentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+		break;
+	case PresentModePreference::Immediate:
+		PreferredPresentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+		break;
+	default:
+		PreferredPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+		break;
+	}
+
 	for (const VkPresentModeKHR& PresentMode : AvailablePresentModes)
 	{
-		if (PresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+		if (PresentMode == PreferredPresentMode)
 		{
 			return PresentMode;
 		}
 	}
 
+	// Every device has to support FIFO
 	return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -101,7 +124,7 @@ VkExtent2D VulkanSwapChain::SelectSwapExtent(const VkSurfaceCapabilitiesKHR& Sur
 	}
 
 	int32 Width, Height;
-	SDL_GetWindowSizeInPixels(m_OwningVulkanAPI->GetSdlRenderWindow()->GetSdlWindow(), &Width, &Height);
+	m_OwningVulkanAPI->GetSdlRenderWindow()->GetWindowSizeInPixels(Width, Height);
 
 	VkExtent2D VulkanExtent = { static_cast<uint32>(Width), static_cast<uint32>(Height) };
 	VulkanExtent.width = std::clamp(VulkanExtent.width, SurfaceCapabilities.minImageExtent.width, SurfaceCapabilities.maxImageExtent.width);
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <span>
 #include <vector>
 
 
@@ -20,8 +21,8 @@ public:
     VkExtent2D& GetVulkanExtent() { return m_VulkanSwapChainExtent; }
 
 private:
-    VkSurfaceFormatKHR SelectSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& AvailableSurfaceFormats);
-    VkPresentModeKHR SelectSwapPresentMode(const std::vector<VkPresentModeKHR>& AvailablePresentModes);
+    VkSurfaceFormatKHR SelectSwapSurfaceFormat(std::span<const VkSurfaceFormatKHR> AvailableSurfaceFormats);
+    VkPresentModeKHR SelectSwapPresentMode(std::span<const VkPresentModeKHR> AvailablePresentModes);
     VkExtent2D SelectSwapExtent(const VkSurfaceCapabilitiesKHR& SurfaceCapabilities);
 
     VkFormat m_VulkanSwapChainImageFormat;
@@ -7,69 +7,41 @@ void VulkanVertexBuffer::Init()
 {
     const std::vector<VulkanVertex>& Vertices = m_OwningVulkanAPI->GetHardcodedVertices();
     const std::vector<uint16>& Indices = m_OwningVulkanAPI->GetHardcodedIndices();
-    const VkDeviceSize BufferSize = sizeof(Vertices[0]) * Vertices.size();
+    const VkDeviceSize VertexBufferSize = sizeof(Vertices[0]) * Vertices.size();
+    const VkDeviceSize IndexBufferSize = sizeof(Indices[0]) * Indices.size();
+    VulkanMemoryAllocator* MemoryAllocator = m_OwningVulkanAPI->GetVulkanMemoryAllocator();
 
-    // Vertex staging buffer
+    // Vertex staging buffer, its memory is already mapped
     VkBuffer StagingBuffer;
-    VkDeviceMemory StagingBufferMemory;
-    CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
-
-    void* data;
-    vkMapMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), StagingBufferMemory, 0, BufferSize, 0, &data);
-    memcpy(data, Vertices.data(), (size_t) BufferSize);
-    vkUnmapMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), StagingBufferMemory);
+    VulkanAllocation StagingBufferAllocation;
+    CreateBuffer(VertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferAllocation);
+    memcpy(StagingBufferAllocation.MappedData, Vertices.data(), (size_t) VertexBufferSize);
 
     // Vertex buffer
-    CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VulkanObject, m_VertexBufferMemory);
+    CreateBuffer(VertexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VulkanObject, m_VertexBufferAllocation);
 
-    CopyBuffer(StagingBuffer, m_VulkanObject, BufferSize);
-    vkDestroyBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), StagingBuffer, nullptr);
-    vkFreeMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), StagingBufferMemory, nullptr);
+    CopyBuffer(StagingBuffer, m_VulkanObject, VertexBufferSize);
+    MemoryAllocator->DestroyBuffer(StagingBuffer, StagingBufferAllocation);
 
-    // Indices staging buffer
+    // Indices staging buffer, reuses the memory block the vertex staging buffer was in
     VkBuffer IndexStagingBuffer;
-    VkDeviceMemory IndexStagingBufferMemory;
-    CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, IndexStagingBuffer, IndexStagingBufferMemory);
-
-    void* IndexData;
-    vkMapMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), IndexStagingBufferMemory, 0, BufferSize, 0, &IndexData);
-    memcpy(IndexData, Indices.data(), (size_t) BufferSize);
-    vkUnmapMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), IndexStagingBufferMemory);
+    VulkanAllocation IndexStagingBufferAllocation;
+    CreateBuffer(IndexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, IndexStagingBuffer, IndexStagingBufferAllocation);
+    memcpy(IndexStagingBufferAllocation.MappedData, Indices.data(), (size_t) IndexBufferSize);
 
     // Indices buffer
-    CreateBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory);
+    CreateBuffer(IndexBufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferAllocation);
 
-    CopyBuffer(IndexStagingBuffer, m_IndexBuffer, BufferSize);
-    vkDestroyBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), IndexStagingBuffer, nullptr);
-    vkFreeMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), IndexStagingBufferMemory, nullptr);
+    CopyBuffer(IndexStagingBuffer, m_IndexBuffer, IndexBufferSize);
+    MemoryAllocator->DestroyBuffer(IndexStagingBuffer, IndexStagingBufferAllocation);
 }
 
-void VulkanVertexBuffer::CreateBuffer(uint64 Size, VkBufferUsageFlags UsageFlags, VkMemoryPropertyFlags PropertyFlags, VkBuffer& OutBuffer, VkDeviceMemory& OutBufferMemory)
+void VulkanVertexBuffer::CreateBuffer(uint64 Size, VkBufferUsageFlags UsageFlags, VkMemoryPropertyFlags PropertyFlags, VkBuffer& OutBuffer, VulkanAllocation& OutAllocation)
 {
-    VkBufferCreateInfo VertexBufferCreateInfo{};
-    VertexBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    VertexBufferCreateInfo.size = Size;
-    VertexBufferCreateInfo.usage = UsageFlags;
-    VertexBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &VertexBufferCreateInfo, nullptr, &OutBuffer) != VK_SUCCESS)
+    if (!m_OwningVulkanAPI->GetVulkanMemoryAllocator()->CreateBuffer(Size, UsageFlags, PropertyFlags, OutBuffer, OutAllocation))
     {
         UNICA_LOG_CRITICAL("Failed to create buffer!");
     }
-
-    VkMemoryRequirements VulkanMemoryRequirements;
-    vkGetBufferMemoryRequirements(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), OutBuffer, &VulkanMemoryRequirements);
-
-    VkMemoryAllocateInfo VulkanMemoryAllocInfo{};
-    VulkanMemoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    VulkanMemoryAllocInfo.allocationSize = VulkanMemoryRequirements.size;
-    VulkanMemoryAllocInfo.memoryTypeIndex = FindGpuMemoryType(VulkanMemoryRequirements.memoryTypeBits, PropertyFlags);
-
-    if (vkAllocateMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), &VulkanMemoryAllocInfo, nullptr, &OutBufferMemory) != VK_SUCCESS) {
-        UNICA_LOG_CRITICAL("Failed to allocate vertex buffer memory!");
-    }
-
-    vkBindBufferMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), OutBuffer, OutBufferMemory, 0);
 }
 
 void VulkanVertexBuffer::CopyBuffer(VkBuffer SourceBuffer, VkBuffer DestinationBuffer, VkDeviceSize Size)
@@ -108,27 +80,9 @@ void VulkanVertexBuffer::CopyBuffer(VkBuffer SourceBuffer, VkBuffer DestinationB
     vkFreeCommandBuffers(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_OwningVulkanAPI->GetVulkanCommandPool()->GetVulkanObject(), 1, &CopyCommandBuffer);
 }
 
-uint32 VulkanVertexBuffer::FindGpuMemoryType(uint32 TypeFilter, VkMemoryPropertyFlags PropertyFlags) const
-{
-    VkPhysicalDeviceMemoryProperties GpuMemoryProperties;
-    vkGetPhysicalDeviceMemoryProperties(m_OwningVulkanAPI->GetVulkanPhysicalDevice()->GetVulkanObject(), &GpuMemoryProperties);
-
-    for (uint32 i = 0; i < GpuMemoryProperties.memoryTypeCount; i++)
-    {
-        if ((TypeFilter & (1 << i)) && (GpuMemoryProperties.memoryTypes[i].propertyFlags & PropertyFlags) == PropertyFlags)
-        {
-            return i;
-        }
-    }
-
-    UNICA_LOG_CRITICAL("Failed to find suitable memory type!");
-}
-
 void VulkanVertexBuffer::Destroy()
 {
-    vkDestroyBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_IndexBuffer, nullptr);
-    vkFreeMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_IndexBufferMemory, nullptr);
-    
-    vkDestroyBuffer(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VulkanObject, nullptr);
-    vkFreeMemory(m_OwningVulkanAPI->GetVulkanLogicalDevice()->GetVulkanObject(), m_VertexBufferMemory, nullptr);
+    VulkanMemoryAllocator* MemoryAllocator = m_OwningVulkanAPI->GetVulkanMemoryAllocator();
+    MemoryAllocator->DestroyBuffer(m_IndexBuffer, m_IndexBufferAllocation);
+    MemoryAllocator->DestroyBuffer(m_VulkanObject, m_VertexBufferAllocation);
 }
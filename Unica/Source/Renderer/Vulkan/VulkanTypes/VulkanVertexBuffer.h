@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "UnicaMinimal.h"
 #include "Renderer/Vulkan/VulkanTypeInterface.h"
+#include "Renderer/Vulkan/VulkanTypes/VulkanMemoryAllocator.h"
 
 class VulkanVertexBuffer : public VulkanTypeInterface<VkBuffer>
 {
@@ -10,20 +11,18 @@ public:
     void Init() override;
     void Destroy() override;
 
-    VkDeviceMemory GetVulkanDeviceMemory() const { return m_VertexBufferMemory; }
+    const VulkanAllocation& GetVertexBufferAllocation() const { return m_VertexBufferAllocation; }
 
     VkBuffer GetIndexBuffer() const { return m_IndexBuffer; }
     
     ~VulkanVertexBuffer() override = default;
 
 private:
-    void CreateBuffer(uint64 Size, VkBufferUsageFlags UsageFlags, VkMemoryPropertyFlags PropertyFlags, VkBuffer& OutBuffer, VkDeviceMemory& OutBufferMemory);
+    void CreateBuffer(uint64 Size, VkBufferUsageFlags UsageFlags, VkMemoryPropertyFlags PropertyFlags, VkBuffer& OutBuffer, VulkanAllocation& OutAllocation);
     void CopyBuffer(VkBuffer SourceBuffer, VkBuffer DestinationBuffer, VkDeviceSize Size);
     
-    uint32 FindGpuMemoryType(uint32 TypeFilter, VkMemoryPropertyFlags PropertyFlags) const;
-    
-    VkDeviceMemory m_VertexBufferMemory;
+    VulkanAllocation m_VertexBufferAllocation;
 
     VkBuffer m_IndexBuffer;
-    VkDeviceMemory m_IndexBufferMemory;
+    VulkanAllocation m_IndexBufferAllocation;
 };
@@ -2,6 +2,8 @@
 
 #pragma once
 
+class SubsystemDependencies;
+
 class SubsystemBase
 {
 public:
@@ -12,5 +14,15 @@ public:
 
     virtual bool ShouldTick() { return false; }
 
+    /** Simulation step, run at UnicaSettings::FixedTickRate before Tick. See TimeManager::GetFixedDeltaTimeSeconds */
+    virtual void FixedTick() { }
+    virtual bool ShouldFixedTick() { return false; }
+
+    /** Declare which subsystems this one reads from or writes to during Init and Tick */
+    virtual void DeclareDependencies(SubsystemDependencies& /* Dependencies */) const { }
+
+    /** Whether Init and Tick must run on the main thread instead of a job worker */
+    virtual bool RequiresMainThread() const { return false; }
+
     virtual SubsystemBase* Get() { return this; }
 };
@@ -0,0 +1,33 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include "UnicaMinimal.h"
+#include "SubsystemRegistry.h"
+
+/**
+ * Data access a subsystem declares to the SubsystemManager. Subsystems that conflict (one writes what the other
+ * reads or writes) are ordered by registration, everything else is free to initialize and tick concurrently.
+ * Every subsystem implicitly writes to itself
+ */
+class SubsystemDependencies
+{
+public:
+    template <typename T>
+    void Reads() { m_ReadMask |= 1ull << SubsystemTypeIndex<T>::Value; }
+
+    template <typename T>
+    void Writes() { Writes(SubsystemTypeIndex<T>::Value); }
+    void Writes(const uint32 TypeIndex) { m_WriteMask |= 1ull << TypeIndex; }
+
+    bool ConflictsWith(const SubsystemDependencies& Other) const
+    {
+        return (m_WriteMask & (Other.m_ReadMask | Other.m_WriteMask)) != 0 || (m_ReadMask & Other.m_WriteMask) != 0;
+    }
+
+private:
+    static_assert(SubsystemRegistry::Count <= 64, "Subsystem dependencies are tracked in 64 bit masks");
+
+    uint64 m_ReadMask = 0;
+    uint64 m_WriteMask = 0;
+};
@@ -2,46 +2,193 @@
 
 #include "SubsystemManager.h"
 
+#include <thread>
+
 #include "UnicaMinimal.h"
+#include "SubsystemDependencies.h"
+#include "Input/InputManager.h"
+#include "IO/AsyncIoManager.h"
+#include "IO/FileWatcher.h"
+#include "Jobs/JobSystem.h"
 #include "Renderer/RenderManager.h"
+#include "Timer/FramePacer.h"
+#include "Timer/FrameStatistics.h"
 #include "Timer/TimeManager.h"
 
-std::vector<std::unique_ptr<SubsystemBase>> SubsystemManager::m_SubsystemCollection;
+std::array<std::unique_ptr<SubsystemBase>, SubsystemRegistry::Count> SubsystemManager::m_Subsystems;
 void SubsystemManager::Init()
 {
-    InitializeSubsystem(new TimeManager);
-    InitializeSubsystem(new RenderManager);
+    InitializeSubsystem<JobSystem>();
+
+    RegisterSubsystem<TimeManager>();
+    RegisterSubsystem<FramePacer>();
+    RegisterSubsystem<FrameStatistics>();
+    RegisterSubsystem<InputManager>();
+    RegisterSubsystem<FileWatcher>();
+    RegisterSubsystem<AsyncIoManager>();
+    RegisterSubsystem<RenderManager>();
+
+    BuildSubsystemGraph();
+    ExecuteSubsystemGraph(SubsystemGraphPass::Init);
 }
 
-void SubsystemManager::InitializeSubsystem(SubsystemBase* const Subsystem)
+void SubsystemManager::BuildSubsystemGraph()
 {
-    UNICA_LOG(spdlog::level::info, "Initializing {}", typeid(*Subsystem).name());
-    Subsystem->Init();
-    m_SubsystemCollection.push_back(std::unique_ptr<SubsystemBase>(Subsystem));
+    UNICA_PROFILE_FUNCTION
+    std::vector<SubsystemDependencies> NodeDependencies;
+    for (uint32 OrderIndex = m_BootstrapSubsystemCount; OrderIndex < m_InitializationOrder.size(); OrderIndex++)
+    {
+        const uint32 TypeIndex = m_InitializationOrder[OrderIndex];
+        SubsystemBase* const Subsystem = m_Subsystems[TypeIndex].get();
+
+        std::unique_ptr<SubsystemNode> Node = std::make_unique<SubsystemNode>();
+        Node->Subsystem = Subsystem;
+        Node->TypeIndex = TypeIndex;
+        Node->Name = SubsystemRegistry::Names[TypeIndex];
+        Node->bRequiresMainThread = Subsystem->RequiresMainThread();
+        m_SubsystemGraph.push_back(std::move(Node));
+
+        SubsystemDependencies& Dependencies = NodeDependencies.emplace_back();
+        Dependencies.Writes(TypeIndex);
+        Subsystem->DeclareDependencies(Dependencies);
+    }
+
+    // Registration order breaks ties between conflicting subsystems, which also keeps the graph acyclic
+    for (uint32 NodeIndex = 0; NodeIndex < m_SubsystemGraph.size(); NodeIndex++)
+    {
+        for (uint32 EarlierNodeIndex = 0; EarlierNodeIndex < NodeIndex; EarlierNodeIndex++)
+        {
+            if (!NodeDependencies[EarlierNodeIndex].ConflictsWith(NodeDependencies[NodeIndex]))
+            {
+                continue;
+            }
+
+            m_SubsystemGraph[EarlierNodeIndex]->Successors.push_back(NodeIndex);
+            m_SubsystemGraph[NodeIndex]->PredecessorCount++;
+            UNICA_LOG_TRACE("Subsystem {} runs after {}", m_SubsystemGraph[NodeIndex]->Name, m_SubsystemGraph[EarlierNodeIndex]->Name);
+        }
+    }
 }
 
-void SubsystemManager::Shutdown()
+void SubsystemManager::ExecuteSubsystemGraph(const SubsystemGraphPass GraphPass)
 {
-    while (!m_SubsystemCollection.empty())
+    UNICA_PROFILE_FUNCTION
+    m_RemainingNodeCount = static_cast<uint32>(m_SubsystemGraph.size());
+    for (const std::unique_ptr<SubsystemNode>& Node : m_SubsystemGraph)
     {
-        SubsystemBase* const Subsystem = m_SubsystemCollection.back().get();
+        Node->RemainingPredecessors = Node->PredecessorCount;
+    }
 
-        UNICA_LOG(spdlog::level::info, "Shutting down {}", typeid(*Subsystem).name());
-        Subsystem->Shutdown();
+    for (uint32 NodeIndex = 0; NodeIndex < m_SubsystemGraph.size(); NodeIndex++)
+    {
+        if (m_SubsystemGraph[NodeIndex]->PredecessorCount == 0)
+        {
+            ScheduleSubsystemNode(NodeIndex, GraphPass);
+        }
+    }
+
+    // The main thread runs the nodes bound to it and helps with everyone else's until the whole graph is done
+    while (m_RemainingNodeCount.load(std::memory_order_acquire) > 0)
+    {
+        uint32 MainThreadNodeIndex = UINT32_MAX;
+        {
+            const std::lock_guard MainThreadNodesLock(m_MainThreadNodesMutex);
+            if (!m_MainThreadNodes.empty())
+            {
+                MainThreadNodeIndex = m_MainThreadNodes.back();
+                m_MainThreadNodes.pop_back();
+            }
+        }
 
-        m_SubsystemCollection.pop_back();
+        if (MainThreadNodeIndex != UINT32_MAX)
+        {
+            ExecuteSubsystemNode(MainThreadNodeIndex, GraphPass);
+        }
+        else if (!JobSystem::TryExecuteJob())
+        {
+            std::this_thread::yield();
+        }
     }
 }
 
-void SubsystemManager::TickSubsystems()
+void SubsystemManager::ScheduleSubsystemNode(const uint32 NodeIndex, const SubsystemGraphPass GraphPass)
 {
-    UNICA_PROFILE_FUNCTION
-    for (const std::unique_ptr<SubsystemBase>& Subsystem : m_SubsystemCollection)
+    if (m_SubsystemGraph[NodeIndex]->bRequiresMainThread)
     {
-        if (!Subsystem->ShouldTick())
+        const std::lock_guard MainThreadNodesLock(m_MainThreadNodesMutex);
+        m_MainThreadNodes.push_back(NodeIndex);
+        return;
+    }
+
+    JobSystem::Dispatch(m_SubsystemGraph[NodeIndex]->Name.c_str(), [this, NodeIndex, GraphPass]
+    {
+        ExecuteSubsystemNode(NodeIndex, GraphPass);
+    });
+}
+
+void SubsystemManager::ExecuteSubsystemNode(const uint32 NodeIndex, const SubsystemGraphPass GraphPass)
+{
+    const SubsystemNode& Node = *m_SubsystemGraph[NodeIndex];
+    switch (GraphPass)
+    {
+    case SubsystemGraphPass::Init:
+    {
+        UNICA_PROFILE_FUNCTION_DYNAMIC(Node.Name.c_str());
+        UNICA_LOG(spdlog::level::info, "Initializing {}", Node.Name);
+        Node.Subsystem->Init();
+        break;
+    }
+    case SubsystemGraphPass::FixedTick:
+        if (Node.Subsystem->ShouldFixedTick())
+        {
+            UNICA_PROFILE_FUNCTION_DYNAMIC(Node.Name.c_str());
+            Node.Subsystem->FixedTick();
+        }
+        break;
+    case SubsystemGraphPass::Tick:
+        if (Node.Subsystem->ShouldTick())
+        {
+            UNICA_PROFILE_FUNCTION_DYNAMIC(Node.Name.c_str());
+            Node.Subsystem->Tick();
+        }
+        break;
+    }
+
+    for (const uint32 SuccessorIndex : Node.Successors)
+    {
+        if (m_SubsystemGraph[SuccessorIndex]->RemainingPredecessors.fetch_sub(1, std::memory_order_acq_rel) == 1)
         {
-            continue;
+            ScheduleSubsystemNode(SuccessorIndex, GraphPass);
         }
-        Subsystem->Tick();
     }
+
+    m_RemainingNodeCount.fetch_sub(1, std::memory_order_release);
+}
+
+void SubsystemManager::Shutdown()
+{
+    m_SubsystemGraph.clear();
+    while (!m_InitializationOrder.empty())
+    {
+        const uint32 TypeIndex = m_InitializationOrder.back();
+
+        UNICA_LOG(spdlog::level::info, "Shutting down {}", SubsystemRegistry::Names[TypeIndex]);
+        m_Subsystems[TypeIndex]->Shutdown();
+
+        m_Subsystems[TypeIndex].reset();
+        m_InitializationOrder.pop_back();
+    }
+    m_BootstrapSubsystemCount = 0;
+}
+
+void SubsystemManager::TickSubsystems()
+{
+    UNICA_PROFILE_FUNCTION
+    ExecuteSubsystemGraph(SubsystemGraphPass::Tick);
+}
+
+void SubsystemManager::FixedTickSubsystems()
+{
+    UNICA_PROFILE_FUNCTION
+    ExecuteSubsystemGraph(SubsystemGraphPass::FixedTick);
 }
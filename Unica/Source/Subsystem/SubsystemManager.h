@@ -2,10 +2,16 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
+#include "UnicaMinimal.h"
 #include "SubsystemBase.h"
+#include "SubsystemRegistry.h"
 
 class SubsystemManager
 {
@@ -13,22 +19,95 @@ public:
     void Init();
     void Shutdown();
     void TickSubsystems();
-    
-    template <typename T, std::enable_if_t<std::is_base_of_v<SubsystemBase, T>, std::nullptr_t> = nullptr>
+    void FixedTickSubsystems();
+
+    /** Subsystem of type T, or nullptr if it isn't running. Resolves to a single array load */
+    template <typename T>
     static T* GetSubsystem()
     {
-        for (const std::unique_ptr<SubsystemBase>& Subsystem : m_SubsystemCollection)
+        return static_cast<T*>(m_Subsystems[SubsystemTypeIndex<T>::Value].get());
+    }
+
+private:
+    enum class SubsystemGraphPass : uint8
+    {
+        Init,
+        FixedTick,
+        Tick
+    };
+
+    struct SubsystemNode
+    {
+        SubsystemBase* Subsystem = nullptr;
+        uint32 TypeIndex = 0;
+        std::string Name;
+        bool bRequiresMainThread = false;
+
+        uint32 PredecessorCount = 0;
+        std::vector<uint32> Successors;
+        std::atomic<uint32> RemainingPredecessors = 0;
+    };
+
+    /** Create and initialize a subsystem right away, before the graph exists */
+    template <typename T>
+    void InitializeSubsystem()
+    {
+        RegisterSubsystem<T>();
+        UNICA_LOG(spdlog::level::info, "Initializing {}", SubsystemRegistry::Names[SubsystemTypeIndex<T>::Value]);
+        m_Subsystems[SubsystemTypeIndex<T>::Value]->Init();
+        m_BootstrapSubsystemCount++;
+    }
+
+    /** Create a subsystem to be initialized once the graph is built */
+    template <typename T>
+    void RegisterSubsystem()
+    {
+        m_Subsystems[SubsystemTypeIndex<T>::Value] = std::make_unique<T>();
+        m_InitializationOrder.push_back(SubsystemTypeIndex<T>::Value);
+    }
+
+    /** Order every registered subsystem that conflicts with an earlier one after it, leaving the rest independent */
+    void BuildSubsystemGraph();
+
+    /** Run a pass over the graph, dispatching independent subsystems to the JobSystem. Returns once every node ran */
+    void ExecuteSubsystemGraph(SubsystemGraphPass GraphPass);
+    void ScheduleSubsystemNode(uint32 NodeIndex, SubsystemGraphPass GraphPass);
+    void ExecuteSubsystemNode(uint32 NodeIndex, SubsystemGraphPass GraphPass);
+
+    // Indexed by SubsystemTypeIndex
+    static std::array<std::unique_ptr<SubsystemBase>, SubsystemRegistry::Count> m_Subsystems;
+    std::vector<uint32> m_InitializationOrder;
+
+    // Subsystems initialized before the graph exists, e.g. the JobSystem the graph is executed with
+    uint32 m_BootstrapSubsystemCount = 0;
+
+    std::vector<std::unique_ptr<SubsystemNode>> m_SubsystemGraph;
+    std::atomic<uint32> m_RemainingNodeCount = 0;
+
+    std::mutex m_MainThreadNodesMutex;
+    std::vector<uint32> m_MainThreadNodes;
+};
+
+/**
+ * Typed reference to a subsystem that resolves once and can be kept across frames, e.g. as a member.
+ * Valid until SubsystemManager::Shutdown
+ */
+template <typename T>
+class SubsystemHandle
+{
+public:
+    T* Get() const
+    {
+        if (m_Subsystem == nullptr)
         {
-            const T* const CastedSubsystem = static_cast<T*>(Subsystem.get());
-            if (CastedSubsystem != nullptr)
-            {
-                return CastedSubsystem;
-            }
+            m_Subsystem = SubsystemManager::GetSubsystem<T>();
         }
-        return nullptr;
+        return m_Subsystem;
     }
-    
+
+    T* operator->() const { return Get(); }
+    explicit operator bool() const { return Get() != nullptr; }
+
 private:
-    void InitializeSubsystem(SubsystemBase* Subsystem);
-    static std::vector<std::unique_ptr<SubsystemBase>> m_SubsystemCollection;
+    mutable T* m_Subsystem = nullptr;
 };
@@ -0,0 +1,76 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <type_traits>
+
+#include "UnicaMinimal.h"
+
+class JobSystem;
+class TimeManager;
+class FramePacer;
+class FrameStatistics;
+class InputManager;
+class FileWatcher;
+class AsyncIoManager;
+class RenderManager;
+
+/** Readable name of T computed at compile time from the compiler's function signature, e.g. "TimeManager" */
+template <typename T>
+constexpr std::string_view GetTypeName()
+{
+#if defined(_MSC_VER)
+    constexpr std::string_view Signature = __FUNCSIG__;
+    constexpr std::string_view Prefix = "GetTypeName<";
+    constexpr std::string_view Suffix = ">(void)";
+#else
+    constexpr std::string_view Signature = __PRETTY_FUNCTION__;
+    constexpr std::string_view Prefix = "T = ";
+    constexpr std::string_view Suffix = Signature.find(';') != std::string_view::npos ? ";" : "]";
+#endif
+    std::string_view Name = Signature.substr(Signature.find(Prefix) + Prefix.size());
+    Name = Name.substr(0, Name.find(Suffix));
+
+    // MSVC spells out the kind of type
+    for (const std::string_view Keyword : { std::string_view("class "), std::string_view("struct ") })
+    {
+        if (Name.substr(0, Keyword.size()) == Keyword)
+        {
+            Name.remove_prefix(Keyword.size());
+        }
+    }
+    return Name;
+}
+
+template <typename... Types>
+struct SubsystemTypeList
+{
+    static constexpr uint32 Count = sizeof...(Types);
+    static constexpr std::array<std::string_view, Count> Names = { GetTypeName<Types>()... };
+
+    template <typename T>
+    static constexpr uint32 IndexOf()
+    {
+        constexpr bool TypeMatches[] = { std::is_same_v<T, Types>... };
+        for (uint32 TypeIndex = 0; TypeIndex < Count; TypeIndex++)
+        {
+            if (TypeMatches[TypeIndex])
+            {
+                return TypeIndex;
+            }
+        }
+        return Count;
+    }
+};
+
+/** Every subsystem the engine can create. A type's position in this list is its index in the SubsystemManager */
+using SubsystemRegistry = SubsystemTypeList<JobSystem, TimeManager, FramePacer, FrameStatistics, InputManager, FileWatcher, AsyncIoManager, RenderManager>;
+
+template <typename T>
+struct SubsystemTypeIndex
+{
+    static constexpr uint32 Value = SubsystemRegistry::IndexOf<T>();
+    static_assert(Value < SubsystemRegistry::Count, "Subsystem type is missing from SubsystemRegistry");
+};
@@ -0,0 +1,130 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "UnicaMinimal.h"
+#include "UnicaSettings.h"
+#include "TimeManager.h"
+
+namespace
+{
+    constexpr std::chrono::nanoseconds SleepQuantum = std::chrono::milliseconds(1);
+    constexpr uint32 CalibrationSleepCount = 10;
+
+    // Caps the running statistics so the estimate keeps adapting when the OS scheduler behaviour changes
+    constexpr uint32 MaxOvershootSampleCount = 64;
+}
+
+FramePacingMode FramePacer::m_PacingMode = FramePacingMode::Hybrid;
+bool FramePacer::m_bIsIdle = false;
+double FramePacer::m_OvershootMeanNanos = 0;
+double FramePacer::m_OvershootVarianceNanos = 0;
+uint32 FramePacer::m_OvershootSampleCount = 0;
+std::chrono::nanoseconds FramePacer::m_TimerSlackEstimate = std::chrono::milliseconds(2);
+
+void FramePacer::Init()
+{
+    UNICA_PROFILE_FUNCTION
+    m_PacingMode = UnicaSettings::FramePacing;
+
+    for (uint32 CalibrationIndex = 0; CalibrationIndex < CalibrationSleepCount; CalibrationIndex++)
+    {
+        SleepOneQuantum();
+    }
+
+    UNICA_LOG_DEBUG("Calibrated timer slack at {:.3f}ms", GetTimerSlackMillis());
+}
+
+void FramePacer::SetIdle(const bool bIsIdle)
+{
+    if (m_bIsIdle == bIsIdle)
+    {
+        return;
+    }
+
+    UNICA_LOG_DEBUG("{} idle mode", bIsIdle ? "Entering" : "Leaving");
+    m_bIsIdle = bIsIdle;
+    if (!bIsIdle)
+    {
+        // Active frames restart from a fresh clock instead of inheriting the last, long, idle frame
+        TimeManager::ResetFrameTime();
+    }
+}
+
+float FramePacer::GetFrameTimeLimitMillis()
+{
+    return m_bIsIdle ? UnicaSettings::IdleFrameTimeLimit : UnicaSettings::FrameTimeLimit;
+}
+
+std::chrono::nanoseconds FramePacer::WaitUntil(const std::chrono::steady_clock::time_point FrameTimeTarget)
+{
+    UNICA_PROFILE_FUNCTION
+    // Idle frames are long and nobody sees them, sleeping through them is cheaper than being precise
+    switch (m_bIsIdle ? FramePacingMode::Sleep : m_PacingMode)
+    {
+    case FramePacingMode::Spin:
+        SpinUntil(FrameTimeTarget);
+        break;
+    case FramePacingMode::Hybrid:
+        SleepUntil(FrameTimeTarget);
+        SpinUntil(FrameTimeTarget);
+        break;
+    case FramePacingMode::Sleep:
+    {
+        const std::chrono::nanoseconds SleepDuration = FrameTimeTarget - std::chrono::steady_clock::now();
+        if (SleepDuration > std::chrono::nanoseconds::zero())
+        {
+            UNICA_PROFILE_FUNCTION_NAMED("std::this_thread::sleep_for");
+            std::this_thread::sleep_for(SleepDuration);
+        }
+        break;
+    }
+    case FramePacingMode::VSync:
+        return std::chrono::nanoseconds::zero();
+    }
+
+    return std::chrono::steady_clock::now() - FrameTimeTarget;
+}
+
+void FramePacer::SleepUntil(const std::chrono::steady_clock::time_point FrameTimeTarget)
+{
+    UNICA_PROFILE_FUNCTION
+    while (FrameTimeTarget - std::chrono::steady_clock::now() > SleepQuantum + m_TimerSlackEstimate)
+    {
+        SleepOneQuantum();
+    }
+}
+
+void FramePacer::SpinUntil(const std::chrono::steady_clock::time_point FrameTimeTarget)
+{
+    UNICA_PROFILE_FUNCTION
+    while (std::chrono::steady_clock::now() < FrameTimeTarget);
+}
+
+void FramePacer::SleepOneQuantum()
+{
+    const std::chrono::steady_clock::time_point SleepStartTime = std::chrono::steady_clock::now();
+    {
+        UNICA_PROFILE_FUNCTION_NAMED("std::this_thread::sleep_for");
+        std::this_thread::sleep_for(SleepQuantum);
+    }
+    UpdateTimerSlackEstimate(std::chrono::steady_clock::now() - SleepStartTime - SleepQuantum);
+}
+
+void FramePacer::UpdateTimerSlackEstimate(const std::chrono::nanoseconds Overshoot)
+{
+    const double OvershootNanos = static_cast<double>(std::max(Overshoot, std::chrono::nanoseconds::zero()).count());
+
+    m_OvershootSampleCount = std::min(m_OvershootSampleCount + 1, MaxOvershootSampleCount);
+    const double DeltaFromMean = OvershootNanos - m_OvershootMeanNanos;
+    m_OvershootMeanNanos += DeltaFromMean / m_OvershootSampleCount;
+    m_OvershootVarianceNanos += (DeltaFromMean * (OvershootNanos - m_OvershootMeanNanos) - m_OvershootVarianceNanos) / m_OvershootSampleCount;
+
+    // One standard deviation above the mean covers the vast majority of wake-ups, the spin absorbs the rest
+    const double SlackEstimateNanos = m_OvershootMeanNanos + std::sqrt(std::max(m_OvershootVarianceNanos, 0.0));
+    m_TimerSlackEstimate = std::chrono::nanoseconds(static_cast<int64>(SlackEstimateNanos));
+}
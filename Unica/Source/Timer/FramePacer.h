@@ -0,0 +1,70 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <chrono>
+
+#include "UnicaMinimal.h"
+#include "Subsystem/SubsystemBase.h"
+
+enum class FramePacingMode : uint8
+{
+    // Busy-wait for the whole remaining frame budget. Lowest jitter, but pins a full core
+    Spin,
+    // Sleep at OS granularity for most of the budget and only spin for the last sub-millisecond
+    Hybrid,
+    // Sleep for the whole remaining budget. Cheapest, but wakes up late by the OS timer slack
+    Sleep,
+    // Don't wait on the CPU at all and let the swap chain present block on the display refresh
+    VSync
+};
+
+class FramePacer final : public SubsystemBase
+{
+public:
+    static FramePacingMode GetPacingMode() { return m_PacingMode; }
+    static void SetPacingMode(const FramePacingMode PacingMode) { m_PacingMode = PacingMode; }
+
+    /** Whether the CPU should wait for a frame time target at all, or leave pacing to the swap chain */
+    static bool IsPacingOnCpu() { return m_PacingMode != FramePacingMode::VSync; }
+
+    /**
+     * Idle mode is for when nothing is visible, e.g. a minimized window. Rendering is skipped and frames are paced
+     * on the CPU at UnicaSettings::IdleFrameTimeLimit with plain sleeps, while subsystems keep ticking. Main thread only
+     */
+    static bool IsIdle() { return m_bIsIdle; }
+    static void SetIdle(bool bIsIdle);
+
+    /** Milliseconds a frame should take in the current mode, zero when uncapped */
+    static float GetFrameTimeLimitMillis();
+
+    /**
+     * Block the calling thread until FrameTimeTarget using the current pacing mode
+     * @return How late the thread woke up in relation to FrameTimeTarget
+     */
+    static std::chrono::nanoseconds WaitUntil(std::chrono::steady_clock::time_point FrameTimeTarget);
+
+    static float GetTimerSlackMillis() { return static_cast<float>(m_TimerSlackEstimate.count()) / 1'000'000.f; }
+
+private:
+    void Init() override;
+    void Shutdown() override { }
+
+    static void SleepUntil(std::chrono::steady_clock::time_point FrameTimeTarget);
+    static void SpinUntil(std::chrono::steady_clock::time_point FrameTimeTarget);
+
+    /** Sleeps for one OS quantum and feeds how much it overshot into the timer slack estimate */
+    static void SleepOneQuantum();
+    static void UpdateTimerSlackEstimate(std::chrono::nanoseconds Overshoot);
+
+    static FramePacingMode m_PacingMode;
+    static bool m_bIsIdle;
+
+    // Running mean and variance of how much a single quantum sleep overshoots, updated every sleep
+    static double m_OvershootMeanNanos;
+    static double m_OvershootVarianceNanos;
+    static uint32 m_OvershootSampleCount;
+
+    // Remaining budget below which sleeping is no longer safe and the pacer switches to spinning
+    static std::chrono::nanoseconds m_TimerSlackEstimate;
+};
@@ -0,0 +1,255 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fmt/format.h"
+
+#include "UnicaMinimal.h"
+#include "UnicaSettings.h"
+#include "IO/AsyncFileWriter.h"
+
+namespace
+{
+    // Hitches are only reported once the median is representative
+    constexpr uint32 MinimumHitchWindowFrameCount = 30;
+
+    float NanosecondsToMillis(const std::chrono::nanoseconds Duration)
+    {
+        return static_cast<float>(Duration.count()) / 1'000'000.f;
+    }
+}
+
+UnicaRingBuffer<FrameTimingSample, 256> FrameStatistics::m_PendingSamples;
+std::atomic<int64> FrameStatistics::m_PendingGpuWaitNanos = 0;
+std::atomic<uint64> FrameStatistics::m_DroppedSampleCount = 0;
+uint64 FrameStatistics::m_RecordedFrameCount = 0;
+std::array<FrameTimingSample, FrameStatistics::WindowSize> FrameStatistics::m_Window;
+uint32 FrameStatistics::m_WindowStart = 0;
+uint32 FrameStatistics::m_WindowCount = 0;
+std::array<uint16, FrameStatistics::PercentileBucketCount> FrameStatistics::m_PercentileBuckets;
+double FrameStatistics::m_WindowFrameTimeSum = 0;
+double FrameStatistics::m_WindowWorkTimeSum = 0;
+double FrameStatistics::m_WindowSleepTimeSum = 0;
+double FrameStatistics::m_WindowGpuWaitTimeSum = 0;
+std::deque<FrameTimingSample> FrameStatistics::m_WindowMaxCandidates;
+FrameStatisticsSummary FrameStatistics::m_Accumulated;
+std::mutex FrameStatistics::m_SummaryMutex;
+FrameStatisticsSummary FrameStatistics::m_Summary;
+
+void FrameStatistics::Init()
+{
+    m_PercentileBuckets.fill(0);
+}
+
+void FrameStatistics::RecordFrame(const std::chrono::nanoseconds FrameTime, const std::chrono::nanoseconds WorkTime, const std::chrono::nanoseconds SleepTime)
+{
+    FrameTimingSample Sample;
+    Sample.FrameNumber = m_RecordedFrameCount++;
+    Sample.FrameTimeMillis = NanosecondsToMillis(FrameTime);
+    Sample.WorkTimeMillis = NanosecondsToMillis(WorkTime);
+    Sample.SleepTimeMillis = NanosecondsToMillis(SleepTime);
+    Sample.GpuWaitTimeMillis = NanosecondsToMillis(std::chrono::nanoseconds(m_PendingGpuWaitNanos.exchange(0, std::memory_order_relaxed)));
+
+    UNICA_PROFILE_PLOT("Frame Time (ms)", Sample.FrameTimeMillis);
+    UNICA_PROFILE_PLOT("Frame Work Time (ms)", Sample.WorkTimeMillis);
+    UNICA_PROFILE_PLOT("Frame GPU Wait Time (ms)", Sample.GpuWaitTimeMillis);
+
+    if (!m_PendingSamples.Push(Sample))
+    {
+        m_DroppedSampleCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameStatisticsSummary FrameStatistics::GetSummary()
+{
+    const std::lock_guard SummaryLock(m_SummaryMutex);
+    return m_Summary;
+}
+
+void FrameStatistics::Tick()
+{
+    UNICA_PROFILE_FUNCTION
+    ConsumePendingSamples();
+    UpdateSummary();
+}
+
+void FrameStatistics::Shutdown()
+{
+    ConsumePendingSamples();
+    UpdateSummary();
+
+    const FrameStatisticsSummary Summary = GetSummary();
+    UNICA_LOG_INFO("Frame time over the last {} frames: p50 {:.2f}ms, p95 {:.2f}ms, p99 {:.2f}ms, max {:.2f}ms, {} hitches in total",
+        Summary.WindowFrameCount, Summary.P50FrameTimeMillis, Summary.P95FrameTimeMillis, Summary.P99FrameTimeMillis, Summary.MaxFrameTimeMillis, Summary.HitchCount);
+
+    if (UnicaSettings::bDumpFrameStatistics && m_WindowCount > 0)
+    {
+        DumpWindowAsCsv();
+        DumpSummaryAsJson(Summary);
+    }
+}
+
+void FrameStatistics::ConsumePendingSamples()
+{
+    FrameTimingSample Sample;
+    while (m_PendingSamples.Pop(Sample))
+    {
+        AddSample(Sample);
+    }
+}
+
+void FrameStatistics::AddSample(const FrameTimingSample& Sample)
+{
+    if (m_WindowCount >= MinimumHitchWindowFrameCount && Sample.FrameTimeMillis > GetWindowPercentile(0.5f) * UnicaSettings::HitchFrameTimeMultiplier)
+    {
+        m_Accumulated.HitchCount++;
+        UNICA_LOG_DEBUG("Hitch on frame {}: {:.2f}ms, median is {:.2f}ms", Sample.FrameNumber, Sample.FrameTimeMillis, GetWindowPercentile(0.5f));
+    }
+
+    if (m_WindowCount == WindowSize)
+    {
+        RemoveOldestSample();
+    }
+
+    m_Window[(m_WindowStart + m_WindowCount) % WindowSize] = Sample;
+    m_WindowCount++;
+
+    m_PercentileBuckets[GetPercentileBucket(Sample.FrameTimeMillis)]++;
+    m_WindowFrameTimeSum += Sample.FrameTimeMillis;
+    m_WindowWorkTimeSum += Sample.WorkTimeMillis;
+    m_WindowSleepTimeSum += Sample.SleepTimeMillis;
+    m_WindowGpuWaitTimeSum += Sample.GpuWaitTimeMillis;
+
+    while (!m_WindowMaxCandidates.empty() && m_WindowMaxCandidates.back().FrameTimeMillis <= Sample.FrameTimeMillis)
+    {
+        m_WindowMaxCandidates.pop_back();
+    }
+    m_WindowMaxCandidates.push_back(Sample);
+
+    m_Accumulated.FrameCount++;
+    const float* const HistogramLimit = std::lower_bound(FrameStatisticsSummary::FrameTimeHistogramLimits.begin(), FrameStatisticsSummary::FrameTimeHistogramLimits.end(), Sample.FrameTimeMillis);
+    m_Accumulated.FrameTimeHistogram[HistogramLimit - FrameStatisticsSummary::FrameTimeHistogramLimits.begin()]++;
+}
+
+void FrameStatistics::RemoveOldestSample()
+{
+    const FrameTimingSample& OldestSample = m_Window[m_WindowStart];
+
+    m_PercentileBuckets[GetPercentileBucket(OldestSample.FrameTimeMillis)]--;
+    m_WindowFrameTimeSum -= OldestSample.FrameTimeMillis;
+    m_WindowWorkTimeSum -= OldestSample.WorkTimeMillis;
+    m_WindowSleepTimeSum -= OldestSample.SleepTimeMillis;
+    m_WindowGpuWaitTimeSum -= OldestSample.GpuWaitTimeMillis;
+
+    if (!m_WindowMaxCandidates.empty() && m_WindowMaxCandidates.front().FrameNumber == OldestSample.FrameNumber)
+    {
+        m_WindowMaxCandidates.pop_front();
+    }
+
+    m_WindowStart = (m_WindowStart + 1) % WindowSize;
+    m_WindowCount--;
+}
+
+float FrameStatistics::GetWindowPercentile(const float Percentile)
+{
+    if (m_WindowCount == 0)
+    {
+        return 0;
+    }
+
+    const uint32 TargetRank = std::max(static_cast<uint32>(std::ceil(Percentile * static_cast<float>(m_WindowCount))), 1u);
+    uint32 Rank = 0;
+    for (uint32 BucketIndex = 0; BucketIndex < PercentileBucketCount - 1; BucketIndex++)
+    {
+        Rank += m_PercentileBuckets[BucketIndex];
+        if (Rank >= TargetRank)
+        {
+            // Never report more than the slowest frame, the bucket upper bound can overshoot it
+            return std::min(static_cast<float>(BucketIndex + 1) * PercentileBucketWidthMillis, m_WindowMaxCandidates.front().FrameTimeMillis);
+        }
+    }
+
+    // Only the overflow bucket is left, which holds the slowest frames
+    return m_WindowMaxCandidates.front().FrameTimeMillis;
+}
+
+uint32 FrameStatistics::GetPercentileBucket(const float FrameTimeMillis)
+{
+    return std::min(static_cast<uint32>(std::max(FrameTimeMillis, 0.f) / PercentileBucketWidthMillis), PercentileBucketCount - 1);
+}
+
+void FrameStatistics::UpdateSummary()
+{
+    FrameStatisticsSummary Summary = m_Accumulated;
+    Summary.DroppedSampleCount = m_DroppedSampleCount.load(std::memory_order_relaxed);
+    Summary.WindowFrameCount = m_WindowCount;
+
+    if (m_WindowCount > 0)
+    {
+        const double WindowFrameCount = m_WindowCount;
+        Summary.AverageFrameTimeMillis = static_cast<float>(m_WindowFrameTimeSum / WindowFrameCount);
+        Summary.AverageWorkTimeMillis = static_cast<float>(m_WindowWorkTimeSum / WindowFrameCount);
+        Summary.AverageSleepTimeMillis = static_cast<float>(m_WindowSleepTimeSum / WindowFrameCount);
+        Summary.AverageGpuWaitTimeMillis = static_cast<float>(m_WindowGpuWaitTimeSum / WindowFrameCount);
+        Summary.P50FrameTimeMillis = GetWindowPercentile(0.5f);
+        Summary.P95FrameTimeMillis = GetWindowPercentile(0.95f);
+        Summary.P99FrameTimeMillis = GetWindowPercentile(0.99f);
+        Summary.MaxFrameTimeMillis = m_WindowMaxCandidates.front().FrameTimeMillis;
+    }
+
+    UNICA_PROFILE_PLOT("Frame Time p99 (ms)", Summary.P99FrameTimeMillis);
+
+    const std::lock_guard SummaryLock(m_SummaryMutex);
+    m_Summary = Summary;
+}
+
+void FrameStatistics::DumpWindowAsCsv()
+{
+    UNICA_PROFILE_FUNCTION
+    std::string CsvOutput = "Frame,FrameTimeMillis,WorkTimeMillis,SleepTimeMillis,GpuWaitTimeMillis\n";
+    for (uint32 SampleIndex = 0; SampleIndex < m_WindowCount; SampleIndex++)
+    {
+        const FrameTimingSample& Sample = m_Window[(m_WindowStart + SampleIndex) % WindowSize];
+        CsvOutput += fmt::format("{},{:.4f},{:.4f},{:.4f},{:.4f}\n",
+            Sample.FrameNumber, Sample.FrameTimeMillis, Sample.WorkTimeMillis, Sample.SleepTimeMillis, Sample.GpuWaitTimeMillis);
+    }
+
+    AsyncFileWriter::WriteFile(std::move(CsvOutput), "Engine:Saved/FrameStatistics.csv");
+}
+
+void FrameStatistics::DumpSummaryAsJson(const FrameStatisticsSummary& Summary)
+{
+    UNICA_PROFILE_FUNCTION
+    std::string HistogramOutput;
+    for (uint32 BucketIndex = 0; BucketIndex < Summary.FrameTimeHistogram.size(); BucketIndex++)
+    {
+        const bool bIsOverflowBucket = BucketIndex == FrameStatisticsSummary::FrameTimeHistogramLimits.size();
+        HistogramOutput += fmt::format("{}\n    {{ \"UpToMillis\": {}, \"Frames\": {} }}", BucketIndex == 0 ? "" : ",",
+            bIsOverflowBucket ? "null" : fmt::format("{:.2f}", FrameStatisticsSummary::FrameTimeHistogramLimits[BucketIndex]), Summary.FrameTimeHistogram[BucketIndex]);
+    }
+
+    std::string JsonOutput = fmt::format(
+        "{{\n"
+        "  \"FrameCount\": {},\n"
+        "  \"HitchCount\": {},\n"
+        "  \"DroppedSampleCount\": {},\n"
+        "  \"WindowFrameCount\": {},\n"
+        "  \"AverageFrameTimeMillis\": {:.4f},\n"
+        "  \"P50FrameTimeMillis\": {:.4f},\n"
+        "  \"P95FrameTimeMillis\": {:.4f},\n"
+        "  \"P99FrameTimeMillis\": {:.4f},\n"
+        "  \"MaxFrameTimeMillis\": {:.4f},\n"
+        "  \"AverageWorkTimeMillis\": {:.4f},\n"
+        "  \"AverageSleepTimeMillis\": {:.4f},\n"
+        "  \"AverageGpuWaitTimeMillis\": {:.4f},\n"
+        "  \"FrameTimeHistogram\": [{}\n  ]\n"
+        "}}\n",
+        Summary.FrameCount, Summary.HitchCount, Summary.DroppedSampleCount, Summary.WindowFrameCount,
+        Summary.AverageFrameTimeMillis, Summary.P50FrameTimeMillis, Summary.P95FrameTimeMillis, Summary.P99FrameTimeMillis, Summary.MaxFrameTimeMillis,
+        Summary.AverageWorkTimeMillis, Summary.AverageSleepTimeMillis, Summary.AverageGpuWaitTimeMillis, HistogramOutput);
+
+    AsyncFileWriter::WriteFile(std::move(JsonOutput), "Engine:Saved/FrameStatistics.json");
+}
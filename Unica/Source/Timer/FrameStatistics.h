@@ -0,0 +1,108 @@
+// 2022-2023 Copyright joaofonseca.dev, All Rights Reserved.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+#include "UnicaMinimal.h"
+#include "UnicaRingBuffer.h"
+#include "Subsystem/SubsystemBase.h"
+
+struct FrameTimingSample
+{
+    uint64 FrameNumber = 0;
+    float FrameTimeMillis = 0;
+    float WorkTimeMillis = 0;
+    float SleepTimeMillis = 0;
+    float GpuWaitTimeMillis = 0;
+};
+
+struct FrameStatisticsSummary
+{
+    // Upper bounds, in milliseconds, of every FrameTimeHistogram bucket but the last, which holds everything slower
+    static constexpr std::array<float, 6> FrameTimeHistogramLimits = { 4.17f, 8.33f, 16.67f, 33.33f, 50.f, 100.f };
+
+    uint64 FrameCount = 0;
+    uint64 HitchCount = 0;
+    uint64 DroppedSampleCount = 0;
+
+    // Over the rolling window of the most recent frames
+    uint32 WindowFrameCount = 0;
+    float AverageFrameTimeMillis = 0;
+    float P50FrameTimeMillis = 0;
+    float P95FrameTimeMillis = 0;
+    float P99FrameTimeMillis = 0;
+    float MaxFrameTimeMillis = 0;
+    float AverageWorkTimeMillis = 0;
+    float AverageSleepTimeMillis = 0;
+    float AverageGpuWaitTimeMillis = 0;
+
+    // Since the engine started
+    std::array<uint64, FrameTimeHistogramLimits.size() + 1> FrameTimeHistogram { };
+};
+
+/**
+ * Collects per-frame timings from the main thread and keeps rolling percentiles, a frame time histogram and hitch
+ * counts over them. Samples are handed over through a lock-free ring and folded in on this subsystem's Tick
+ */
+class FrameStatistics final : public SubsystemBase
+{
+public:
+    /** Main thread only, once per frame after pacing */
+    static void RecordFrame(std::chrono::nanoseconds FrameTime, std::chrono::nanoseconds WorkTime, std::chrono::nanoseconds SleepTime);
+
+    /** Time the CPU spent blocked on the GPU during the current frame. Safe to call from any thread */
+    static void AddGpuWaitTime(const std::chrono::nanoseconds GpuWaitTime) { m_PendingGpuWaitNanos.fetch_add(GpuWaitTime.count(), std::memory_order_relaxed); }
+
+    /** Snapshot of the statistics as of the last Tick */
+    static FrameStatisticsSummary GetSummary();
+
+private:
+    void Init() override;
+    void Tick() override;
+    void Shutdown() override;
+    bool ShouldTick() override { return true; }
+
+    static constexpr uint32 WindowSize = 1024;
+
+    // Percentiles are read from a histogram over the window instead of sorting it
+    static constexpr float PercentileBucketWidthMillis = 0.1f;
+    static constexpr uint32 PercentileBucketCount = 2048;
+
+    static void ConsumePendingSamples();
+    static void AddSample(const FrameTimingSample& Sample);
+    static void RemoveOldestSample();
+    static float GetWindowPercentile(float Percentile);
+    static uint32 GetPercentileBucket(float FrameTimeMillis);
+    static void UpdateSummary();
+
+    static void DumpWindowAsCsv();
+    static void DumpSummaryAsJson(const FrameStatisticsSummary& Summary);
+
+    static UnicaRingBuffer<FrameTimingSample, 256> m_PendingSamples;
+    static std::atomic<int64> m_PendingGpuWaitNanos;
+    static std::atomic<uint64> m_DroppedSampleCount;
+    static uint64 m_RecordedFrameCount;
+
+    // Consumer side, only touched from Tick and Shutdown
+    static std::array<FrameTimingSample, WindowSize> m_Window;
+    static uint32 m_WindowStart;
+    static uint32 m_WindowCount;
+    static std::array<uint16, PercentileBucketCount> m_PercentileBuckets;
+    static double m_WindowFrameTimeSum;
+    static double m_WindowWorkTimeSum;
+    static double m_WindowSleepTimeSum;
+    static double m_WindowGpuWaitTimeSum;
+
+    // Decreasing frame times with the frame they were recorded on, the front is always the window maximum
+    static std::deque<FrameTimingSample> m_WindowMaxCandidates;
+
+    static FrameStatisticsSummary m_Accumulated;
+
+    static std::mutex m_SummaryMutex;
+    static FrameStatisticsSummary m_Summary;
+};
@@ -2,11 +2,19 @@
 
 #include "TimeManager.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "UnicaMinimal.h"
+#include "UnicaSettings.h"
+#include "FramePacer.h"
 
+std::chrono::steady_clock::time_point TimeManager::m_LastFrameTime = std::chrono::steady_clock::now();
 float TimeManager::m_DeltaTimeMillis;
-float TimeManager::m_FrameWorkDuration;
-float TimeManager::m_FrameSleepDuration;
+float TimeManager::m_FramePacingError;
+std::chrono::nanoseconds TimeManager::m_FixedDeltaTime;
+std::chrono::nanoseconds TimeManager::m_FixedTimeAccumulator;
+float TimeManager::m_InterpolationAlpha;
 
 void TimeManager::Init()
 {
@@ -15,15 +23,17 @@ void TimeManager::Init()
 		UNICA_LOG(spdlog::level::critical, "HighResClock unit is not nanoseconds");
 		return;
 	}
-}
 
-void TimeManager::Tick()
-{
-	UNICA_PROFILE_FUNCTION
-    CalculateLastFrameTime();
+	if (UnicaSettings::FixedTickRate > 0)
+	{
+		m_FixedDeltaTime = std::chrono::nanoseconds(static_cast<int64>(1'000'000'000.0 / UnicaSettings::FixedTickRate));
+		UNICA_LOG_DEBUG("Fixed ticking at {}Hz", UnicaSettings::FixedTickRate);
+	}
+
+	ResetFrameTime();
 }
 
-void TimeManager::CalculateLastFrameTime()
+uint32 TimeManager::AdvanceFrame()
 {
 	UNICA_PROFILE_FUNCTION
     const std::chrono::time_point CurrentFrameTime = std::chrono::steady_clock::now();
@@ -32,4 +42,40 @@ void TimeManager::CalculateLastFrameTime()
     m_DeltaTimeMillis = static_cast<float>(DeltaTime.count()) / 1'000'000.f;
 
     m_LastFrameTime = CurrentFrameTime;
+
+    if (!IsFixedTickEnabled())
+    {
+        return 0;
+    }
+
+    m_FixedTimeAccumulator += DeltaTime;
+    uint32 FixedTickCount = static_cast<uint32>(m_FixedTimeAccumulator / m_FixedDeltaTime);
+    m_FixedTimeAccumulator -= FixedTickCount * m_FixedDeltaTime;
+
+    // When fixed ticks cost more than the time they simulate, catching up only makes the next frame longer.
+    // Drop the backlog instead and let the simulation run slower than real time until it recovers
+    uint32 MaxFixedTickCount = UnicaSettings::MaxFixedTicksPerFrame;
+    if (FramePacer::IsIdle())
+    {
+        // Idle frames are long on purpose and the simulation still has to keep up with real time through them
+        const std::chrono::duration<float, std::milli> IdleFrameTime(FramePacer::GetFrameTimeLimitMillis());
+        MaxFixedTickCount = std::max(MaxFixedTickCount, static_cast<uint32>(std::ceil(IdleFrameTime / m_FixedDeltaTime)) + 1);
+    }
+
+    if (FixedTickCount > MaxFixedTickCount)
+    {
+        UNICA_LOG_DEBUG("Dropping {} fixed ticks the simulation couldn't catch up with", FixedTickCount - MaxFixedTickCount);
+        FixedTickCount = MaxFixedTickCount;
+    }
+
+    m_InterpolationAlpha = static_cast<float>(m_FixedTimeAccumulator.count()) / static_cast<float>(m_FixedDeltaTime.count());
+    return FixedTickCount;
+}
+
+void TimeManager::ResetFrameTime()
+{
+    m_LastFrameTime = std::chrono::steady_clock::now();
+    m_DeltaTimeMillis = 0;
+    m_FixedTimeAccumulator = std::chrono::nanoseconds::zero();
+    m_InterpolationAlpha = 0;
 }
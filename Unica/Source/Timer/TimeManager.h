@@ -4,28 +4,49 @@
 
 #include <chrono>
 
+#include "UnicaMinimal.h"
 #include "Subsystem/SubsystemBase.h"
 
 class TimeManager final : public SubsystemBase
 {
 public:
-    static float GetDeltaTimeSeconds() { return m_DeltaTimeMillis / 100; }
+    static float GetDeltaTimeSeconds() { return m_DeltaTimeMillis / 1000; }
     static float GetDeltaTimeMillis() { return m_DeltaTimeMillis; }
 
-    static void SetFrameWorkDuration(const float FrameWorkDuration) { m_FrameWorkDuration = FrameWorkDuration; }
-    static void SetFrameSleepDuration(const float FrameSleepDuration) { m_FrameSleepDuration = FrameSleepDuration; }
+    /** Constant simulation step FixedTick runs with, independent of the frame rate */
+    static float GetFixedDeltaTimeSeconds() { return static_cast<float>(m_FixedDeltaTime.count()) / 1'000'000'000.f; }
+    static bool IsFixedTickEnabled() { return m_FixedDeltaTime.count() > 0; }
+
+    /**
+     * How far the current frame is between the last and the next fixed tick, in the [0, 1) range.
+     * Rendering blends the previous and current simulation state by this amount
+     */
+    static float GetInterpolationAlpha() { return m_InterpolationAlpha; }
+
+    /**
+     * Measure the time since the last frame and accumulate it for the fixed timestep.
+     * Must be called exactly once per frame, before any subsystem ticks
+     * @return Amount of fixed ticks the simulation has to run this frame to catch up
+     */
+    static uint32 AdvanceFrame();
+
+    /** Forget the time accumulated so far, e.g. after a long stall that shouldn't be simulated */
+    static void ResetFrameTime();
+
+    /** How late, in milliseconds, the last frame started in relation to its pacing target */
+    static float GetFramePacingErrorMillis() { return m_FramePacingError; }
+    static void SetFramePacingError(const float FramePacingError) { m_FramePacingError = FramePacingError; }
 
 private:
     void Init() override;
-    void Tick() override;
     void Shutdown() override { }
-    bool ShouldTick() override { return true; }
-
-    void CalculateLastFrameTime();
 
-	std::chrono::steady_clock::time_point m_LastFrameTime = std::chrono::steady_clock::now();
+    static std::chrono::steady_clock::time_point m_LastFrameTime;
 
     static float m_DeltaTimeMillis;
-    static float m_FrameWorkDuration;
-    static float m_FrameSleepDuration;
+    static float m_FramePacingError;
+
+    static std::chrono::nanoseconds m_FixedDeltaTime;
+    static std::chrono::nanoseconds m_FixedTimeAccumulator;
+    static float m_InterpolationAlpha;
 };